@@ -20,6 +20,7 @@ BufferPoolManager::~BufferPoolManager() {
 }
 
 Page *BufferPoolManager::FetchPage(page_id_t page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);  // index builds share the pool across threads
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -50,8 +51,10 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
       disk_manager_->WritePage(pages_[R].GetPageId(), pages_[R].GetData());
     }
     // Delete R from the page table and insert P.
+    page_table_.erase(pages_[R].page_id_);
     pages_[R].page_id_ = page_id;
     pages_[R].pin_count_ = 1;
+    pages_[R].is_dirty_ = false;
     page_table_[page_id] = R;
     // Update P's metadata, read in the page content from disk, and then return a pointer to P.
     disk_manager_->ReadPage(page_id, pages_[R].data_);
@@ -61,6 +64,7 @@ Page *BufferPoolManager::FetchPage(page_id_t page_id) {
 }
 
 Page *BufferPoolManager::NewPage(page_id_t &page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   // 0.   Make sure you call AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
@@ -83,6 +87,7 @@ Page *BufferPoolManager::NewPage(page_id_t &page_id) {
   pages_[frame_id].ResetMemory();
   pages_[frame_id].page_id_ = page_id;
   pages_[frame_id].pin_count_ = 1;
+  pages_[frame_id].is_dirty_ = false;
   page_table_[page_id] = frame_id;
   // Set the page ID output parameter. Return a pointer to P.
   return &pages_[frame_id];
@@ -90,32 +95,63 @@ Page *BufferPoolManager::NewPage(page_id_t &page_id) {
 }
 
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   // 0.   Make sure you call DeallocatePage!
   // 1.   Search the page table for the requested page (P).
   // 1.   If P does not exist, return true.
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free
   // list.
-  frame_id_t frame_id = page_table_[page_id];
-  if (page_table_.count(page_id) == 0)
+  if (page_table_.count(page_id) == 0) {
+    disk_manager_->DeAllocatePage(page_id);
     return true;  // If P does not exist, return true.
-  else if (pages_[frame_id].pin_count_ > 0)
+  }
+  frame_id_t frame_id = page_table_[page_id];
+  if (pages_[frame_id].pin_count_ > 0)
     return false;  // If P exists, but has a non-zero pin-count, return false.
   // Remove P from the page table, reset its metadata and return it to the free list.
   page_table_.erase(page_id);
+  replacer_->Pin(frame_id);
   pages_[frame_id].ResetMemory();
+  pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+  pages_[frame_id].is_dirty_ = false;
   free_list_.push_back(frame_id);
   disk_manager_->DeAllocatePage(page_id);
   return true;
 }
 
+bool BufferPoolManager::DeletePages(const std::vector<page_id_t> &page_ids) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  std::vector<page_id_t> freed;
+  freed.reserve(page_ids.size());
+  bool all_deleted = true;
+  for (page_id_t page_id : page_ids) {
+    if (page_table_.count(page_id) != 0) {
+      frame_id_t frame_id = page_table_[page_id];
+      if (pages_[frame_id].pin_count_ > 0) {
+        all_deleted = false;
+        continue;
+      }
+      page_table_.erase(page_id);
+      replacer_->Pin(frame_id);
+      pages_[frame_id].ResetMemory();
+      pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+      pages_[frame_id].is_dirty_ = false;
+      free_list_.push_back(frame_id);
+    }
+    freed.push_back(page_id);
+  }
+  disk_manager_->DeAllocatePages(freed);
+  return all_deleted;
+}
+
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
   if (page_table_.count(page_id) == 0) return false;  // does not exist
   frame_id_t frame_id = page_table_[page_id];
   if (pages_[frame_id].pin_count_ == 0) return true;  // has no pin, do not need any operation
   if (is_dirty) pages_[frame_id].is_dirty_ = true;
-  replacer_->Unpin(frame_id);
-  pages_[frame_id].pin_count_--;
+  if (--pages_[frame_id].pin_count_ == 0) replacer_->Unpin(frame_id);
   return true;
 }
 
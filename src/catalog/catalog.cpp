@@ -1,4 +1,9 @@
+#include <atomic>
+#include <thread>
+
 #include "catalog/catalog.h"
+#include "glog/logging.h"
+#include "storage/table_batch_iterator.h"
 
 void CatalogMeta::SerializeTo(char *buf) const
 {
@@ -100,6 +105,16 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
        dberr_t error=LoadIndex(it.first,it.second);
       assert(error==DB_SUCCESS);
     }
+    //An ART index lives in memory only, rebuild those of a table from one scan.
+    std::map<table_id_t, std::vector<IndexInfo*>> art_indexes;
+    for(auto &it:indexes_){
+      if(it.second->GetIndexType()=="art")
+        art_indexes[it.second->GetTableInfo()->GetTableId()].push_back(it.second);
+    }
+    for(auto &it:art_indexes){
+      dberr_t error=BuildIndexes(tables_[it.first],it.second,nullptr);
+      assert(error==DB_SUCCESS);
+    }
     buffer_pool_manager->UnpinPage(CATALOG_META_PAGE_ID,false);
   }
   
@@ -107,11 +122,16 @@ CatalogManager::CatalogManager(BufferPoolManager *buffer_pool_manager, LockManag
 }
 
 CatalogManager::~CatalogManager() {
+  for (auto &index : indexes_) {
+    //Keep the entry counts that DML maintained.
+    FlushIndexMetaPage(index.first);
+    index.second->~IndexInfo();
+  }
   delete heap_;
 }
 
 dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schema,
-                                    Transaction *txn, TableInfo *&table_info) {
+                                    Transaction *txn, TableInfo *&table_info, TableLayout layout) {
   
   // ASSERT(false, "Not Implemented yet");
   //judge if the table has already existed.
@@ -120,6 +140,11 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
   {
       return DB_TABLE_ALREADY_EXIST;
   } 
+  if(layout==kLayoutColumnar&&ColumnarPage::GetCapacity(schema)==0)
+  //A columnar page must hold at least one row.
+  {
+      return DB_FAILED;
+  }
    //Create a table named table_name
   /* table_info is created by CatalogManager using CatalogManager's heap_ */
      
@@ -129,9 +154,11 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
     catalog_meta_->table_meta_pages_[table_id] = page_id;
    // catalog_meta_->table_meta_pages_[next_table_id_] = -1;
     
-    TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_,schema, txn,log_manager_, lock_manager_, heap_);
+    TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_,schema, txn,log_manager_, lock_manager_, heap_,
+                                              layout);
     
-     TableMetadata *table_meta = TableMetadata::Create(table_id, table_name, table_heap->GetFirstPageId(), schema, heap_);
+     TableMetadata *table_meta = TableMetadata::Create(table_id, table_name, table_heap->GetFirstPageId(), schema, heap_,
+                                                       table_heap->GetFreeSpaceMapPageId(), layout);
     //TableMetadata::root_page_id:: Record's first page id.
     
     table_info = TableInfo::Create(heap_);
@@ -186,7 +213,9 @@ dberr_t CatalogManager::GetTables(vector<TableInfo *> &tables) const {
 
 dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string &index_name,
                                     const std::vector<std::string> &index_keys, Transaction *txn,
-                                    IndexInfo *&index_info) {
+                                    IndexInfo *&index_info, bool unique,
+                                    const std::vector<std::string> &include_keys,
+                                    const std::string &index_type) {
 
    if(index_names_.count(table_name)<=0) 
        return DB_TABLE_NOT_EXIST;
@@ -208,7 +237,21 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
          return err;
       key_map.push_back(tkey);
     }
-    IndexMetadata *index_meta_data_ptr = IndexMetadata::Create(index_id, index_name, table_names_[table_name],key_map,heap_ );
+    std::vector<uint32_t> include_map;
+    for(const auto &column_name : include_keys){
+      uint32_t tkey;
+      dberr_t err = tinfo->GetSchema()->GetColumnIndex(column_name, tkey);
+      if(err)
+         return err;
+      include_map.push_back(tkey);
+    }
+    //Only the B+ tree leaves can hold included columns.
+    if(index_type!="bptree"&&!include_map.empty())
+       return DB_FAILED;
+    //The key and the included columns must fit in the largest index key type, an ART index has no key type.
+    if(index_type!="art"&&IndexInfo::GetMaxKeySize(tinfo->GetSchema(),key_map,unique||index_type=="hash",include_map)>IndexInfo::MAX_KEY_SIZE)
+       return DB_INDEX_KEY_TOO_LONG;
+    IndexMetadata *index_meta_data_ptr = IndexMetadata::Create(index_id, index_name, table_names_[table_name],key_map,heap_,unique,include_map,index_type);
     
     index_info = IndexInfo::Create(heap_);
     index_info->Init(index_meta_data_ptr,tinfo,buffer_pool_manager_);
@@ -279,7 +322,8 @@ dberr_t CatalogManager::DropTable(const string &table_name) {
   table_id_t tid = it->second;
   
   auto it2 = index_names_.find(table_name);
-  for(auto it3 : it2->second){
+  auto table_indexes = it2->second;//DropIndex erases from the map, so iterate a copy.
+  for(auto it3 : table_indexes){
     //Drop all the indexes in the table.
     DropIndex(table_name, it3.first);
   }
@@ -312,8 +356,7 @@ dberr_t CatalogManager::DropIndex(const string &table_name, const string &index_
   index_id_t index_id = it2->second;
   page_id_t page_id = catalog_meta_->index_meta_pages_[index_id];
   catalog_meta_->index_meta_pages_.erase(index_id);
-  // IndexInfo* iinfo = indexes_[index_id];
-  // delete iinfo;
+  indexes_[index_id]->GetIndex()->Destroy();
   it->second.erase(index_name);
   indexes_.erase(index_id);
   buffer_pool_manager_->DeletePage(page_id);//Delete index_meta_page_id.
@@ -328,6 +371,156 @@ dberr_t CatalogManager::DropIndex(const string &table_name, const string &index_
 }
 
 
+dberr_t CatalogManager::AnalyzeTable(const std::string &table_name, Transaction *txn) {
+  auto it = index_names_.find(table_name);
+  if(it == index_names_.end())
+     return DB_TABLE_NOT_EXIST;
+  for(auto &index : it->second){
+    if(indexes_.at(index.second)->GetIndex()->Analyze(txn)==DB_SUCCESS)
+      FlushIndexMetaPage(index.second);
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t CatalogManager::VacuumTable(const std::string &table_name, Transaction *txn, uint32_t *freed_pages) {
+  TableInfo *table_info = nullptr;
+  if(GetTable(table_name,table_info)!=DB_SUCCESS)
+    return DB_TABLE_NOT_EXIST;
+  std::vector<std::pair<RowId, RowId>> moved;
+  uint32_t freed = table_info->GetTableHeap()->Vacuum(&moved,txn);
+  if(freed_pages!=nullptr)
+    *freed_pages = freed;
+  if(moved.empty())
+    return DB_SUCCESS;
+  std::vector<IndexInfo *> indexes;
+  GetTableIndexes(table_name,indexes);
+  if(indexes.empty())
+    return DB_SUCCESS;
+  //Read every moved row before any index changes, the heap is compacted already and cannot go back.
+  std::vector<Row> rows;
+  std::vector<RowId> old_ids,new_ids;
+  for(auto &move : moved){
+    rows.emplace_back(move.second);
+    if(!table_info->GetTableHeap()->GetTuple(&rows.back(),txn)){
+      LOG(WARNING) << "Vacuum of table " << table_name << " cannot read moved row " << move.second.Get()
+                   << ", rebuilding all of its indexes";
+      return RebuildIndexes(table_info,indexes,txn);
+    }
+    old_ids.push_back(move.first);
+    new_ids.push_back(move.second);
+  }
+  //Every index drops the old row ids of the moved rows and takes the new ones, in one batch each.
+  std::vector<IndexInfo *> broken;
+  for(auto index_info : indexes){
+    //Removal matches on the key columns, the new entries also carry the included columns.
+    std::vector<Row> keys,entries;
+    for(auto &row : rows){
+      std::vector<Field> fields;
+      for(auto column : index_info->GetMetaData()->GetKeyMapping())
+        fields.emplace_back(*row.GetField(column));
+      keys.emplace_back(fields);
+      for(auto column : index_info->GetIncludeMapping())
+        fields.emplace_back(*row.GetField(column));
+      entries.emplace_back(fields);
+    }
+    if(index_info->GetIndex()->RemoveEntries(keys,old_ids,txn)!=DB_SUCCESS||
+       index_info->GetIndex()->InsertEntries(entries,new_ids,txn)!=DB_SUCCESS){
+      LOG(WARNING) << "Vacuum of table " << table_name << " could not move the entries of index "
+                   << index_info->GetIndexName() << ", rebuilding it";
+      broken.push_back(index_info);
+    }
+  }
+  return RebuildIndexes(table_info,broken,txn);
+}
+
+dberr_t CatalogManager::RebuildIndexes(TableInfo *table_info, const std::vector<IndexInfo *> &indexes, Transaction *txn) {
+  //Empty the indexes and load them from the heap again, then refresh the statistics the reload skewed.
+  for(auto index_info : indexes)
+    index_info->GetIndex()->Destroy();
+  if(BuildIndexes(table_info,indexes,txn)!=DB_SUCCESS){
+    LOG(WARNING) << "Rebuilding the indexes of table " << table_info->GetTableName() << " failed";
+    return DB_FAILED;
+  }
+  for(auto index_info : indexes){
+    if(index_info->GetIndex()->Analyze(txn)==DB_SUCCESS)
+      FlushIndexMetaPage(index_info->GetMetaData()->GetIndexId());
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t CatalogManager::BuildIndexes(TableInfo *table_info, const std::vector<IndexInfo *> &indexes, Transaction *txn) {
+  if(indexes.empty())
+    return DB_SUCCESS;
+  //One scan of the heap fans every row out to the key buffer of each index.
+  //The scan decodes only the columns some index stores, a batch at a time.
+  std::vector<uint32_t> column_ids;
+  std::map<uint32_t, uint32_t> positions;
+  std::vector<std::vector<uint32_t>> index_columns(indexes.size());
+  for(size_t i=0;i<indexes.size();i++){
+    index_columns[i] = indexes[i]->GetMetaData()->GetKeyMapping();
+    for(auto column : indexes[i]->GetIncludeMapping())
+      index_columns[i].push_back(column);
+    for(auto &column : index_columns[i]){
+      if(positions.emplace(column,column_ids.size()).second)
+        column_ids.push_back(column);
+      column = positions[column];
+    }
+  }
+  std::vector<std::vector<Row>> keys(indexes.size());
+  std::vector<RowId> row_ids;
+  TableBatchIterator scan(table_info->GetTableHeap(),column_ids,txn);
+  RowBatch batch;
+  while(scan.Next(&batch)){
+    for(uint32_t row=0;row<batch.GetSize();row++){
+      for(size_t i=0;i<indexes.size();i++){
+        std::vector<Field> fields;
+        for(auto position : index_columns[i])
+          fields.emplace_back(batch.GetColumn(position).GetField(row));
+        keys[i].emplace_back(fields);
+      }
+      row_ids.push_back(batch.GetRowId(row));
+    }
+  }
+  //Every worker takes whole indexes, sorts the keys and bulk loads the index.
+  size_t workers = std::min<size_t>(indexes.size(), std::max(1u, std::thread::hardware_concurrency()));
+  std::atomic<size_t> next{0};
+  std::atomic<bool> failed{false};
+  auto build = [&]() {
+    for(size_t i=next++;i<indexes.size();i=next++){
+      if(indexes[i]->GetIndex()->InsertEntries(keys[i],row_ids,txn)!=DB_SUCCESS)
+        failed=true;
+    }
+  };
+  std::vector<std::thread> threads;
+  for(size_t i=1;i<workers;i++)
+    threads.emplace_back(build);
+  build();
+  for(auto &thread : threads)
+    thread.join();
+  return failed?DB_FAILED:DB_SUCCESS;
+}
+
+dberr_t CatalogManager::FlushIndexMetaPage(const index_id_t index_id) const {
+  IndexInfo* index_info = indexes_.at(index_id);
+  IndexMetadata* meta = index_info->GetMetaData();
+  IndexStatistics* stats = index_info->GetIndex()->GetStatistics();
+  uint32_t meta_len = meta->GetSerializedSize();
+  uint32_t len = meta_len;
+  //Statistics that do not fit are dropped, the index still works without them.
+  if(stats!=nullptr&&meta_len+stats->GetSerializedSize(index_info->GetIndexKeySchema())<=PAGE_SIZE)
+    len += stats->GetSerializedSize(index_info->GetIndexKeySchema());
+  Page* page = buffer_pool_manager_->FetchPage(catalog_meta_->index_meta_pages_.at(index_id));
+  if(page==nullptr)
+    return DB_FAILED;
+  char* p = page->GetData();
+  memset(p, 0, PAGE_SIZE);
+  meta->SerializeTo(p);
+  if(len>meta_len)
+    stats->SerializeTo(p+meta_len,index_info->GetIndexKeySchema());
+  buffer_pool_manager_->UnpinPage(page->GetPageId(),true);
+  return DB_SUCCESS;
+}
+
 dberr_t CatalogManager::FlushCatalogMetaPage() const {
   // ASSERT(false, "Not Implemented yet");
   
@@ -354,7 +547,8 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
       TableInfo* tinfo;
       tinfo = TableInfo::Create(heap_);
 
-      TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_,meta->GetFirstPageId() ,meta->GetSchema(), log_manager_, lock_manager_, heap_);
+      TableHeap *table_heap = TableHeap::Create(buffer_pool_manager_,meta->GetFirstPageId(),meta->GetFreeSpaceMapPageId(),
+                                                meta->GetSchema(), log_manager_, lock_manager_, heap_, meta->GetLayout());
       tinfo->Init(meta, table_heap);
       table_names_[meta->GetTableName()] = meta->GetTableId();
       tables_[meta->GetTableId()] = tinfo;
@@ -372,10 +566,13 @@ dberr_t CatalogManager::LoadIndex(const index_id_t index_id, const page_id_t pag
       Page*p = buffer_pool_manager_->FetchPage(page_id);
       char*t = p->GetData();
       IndexMetadata* meta;
-      IndexMetadata::DeserializeFrom(t, meta, heap_);
+      uint32_t meta_len = IndexMetadata::DeserializeFrom(t, meta, heap_);
       TableInfo* tinfo = tables_[meta->GetTableId()];
       IndexInfo* index_info = IndexInfo::Create(heap_);
       index_info->Init(meta,tinfo,buffer_pool_manager_);//segmentation
+      IndexStatistics* stats = index_info->GetIndex()->GetStatistics();
+      if(stats!=nullptr)
+        stats->DeserializeFrom(t+meta_len,index_info->GetIndexKeySchema());
       index_names_[tinfo->GetTableName()][meta->GetIndexName()] = meta->GetIndexId();
       indexes_[meta->GetIndexId()] = index_info;
       buffer_pool_manager_->UnpinPage(page_id,false);
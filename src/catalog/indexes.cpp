@@ -2,13 +2,14 @@
 
 IndexMetadata *IndexMetadata::Create(const index_id_t index_id, const string &index_name,
                                      const table_id_t table_id, const vector<uint32_t> &key_map,
-                                     MemHeap *heap) {
+                                     MemHeap *heap, bool unique, const vector<uint32_t> &include_map,
+                                     const string &index_type) {
   void *buf = heap->Allocate(sizeof(IndexMetadata));
-  return new(buf)IndexMetadata(index_id, index_name, table_id, key_map);
+  return new(buf)IndexMetadata(index_id, index_name, table_id, key_map, unique, include_map, index_type);
 }
 
 uint32_t IndexMetadata::SerializeTo(char *buf) const {
-  //  index_id_(uint32_t)| (indexnamelen)(uint32_t)|index_name(string)|table_id(uint32_t)|key_map(uint32_t) number| n integer in the key_map
+  //  index_id_(uint32_t)| (indexnamelen)(uint32_t)|index_name(string)|table_id(uint32_t)|key_map(uint32_t) number| n integer in the key_map|unique(uint32_t)|include_map number|m integer in the include_map|(indextypelen)(uint32_t)|index_type(string)
   char*pos=buf;
   memcpy(pos,&index_id_,sizeof(index_id_t));pos+=sizeof(index_id_t);
   uint32_t IndexNameLen=index_name_.size();
@@ -23,13 +24,27 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
      MACH_WRITE_TO(uint32_t, pos,key_map_[i]);
      pos+=sizeof(uint32_t);
   }
+  MACH_WRITE_TO(uint32_t, pos, static_cast<uint32_t>(unique_));
+  pos+=sizeof(uint32_t);
+  uint32_t NumIncludeMap=include_map_.size();
+  MACH_WRITE_TO(uint32_t, pos, NumIncludeMap);pos+=sizeof(uint32_t);
+  for(uint32_t i=0;i<NumIncludeMap;i++)
+  {
+     MACH_WRITE_TO(uint32_t, pos,include_map_[i]);
+     pos+=sizeof(uint32_t);
+  }
+  uint32_t IndexTypeLen=index_type_.size();
+  MACH_WRITE_TO(uint32_t, pos, IndexTypeLen);pos+=sizeof(uint32_t);
+  index_type_.copy(pos,IndexTypeLen,0);
+  pos+=IndexTypeLen;
   return pos-buf;
 }
 
 uint32_t IndexMetadata::GetSerializedSize() const 
 {
    uint32_t NumKeyMap=key_map_.size();
-   return sizeof(uint32_t)*4+index_name_.size()+NumKeyMap*sizeof(uint32_t);
+   uint32_t NumIncludeMap=include_map_.size();
+   return sizeof(uint32_t)*7+index_name_.size()+index_type_.size()+(NumKeyMap+NumIncludeMap)*sizeof(uint32_t);
 }
 
 uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta, MemHeap *heap)
@@ -52,6 +67,17 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta, M
         //push into vector
         keymap.push_back(tmp);
      }
-    index_meta=IndexMetadata::Create(indexid,IndexName,tableid,keymap,heap);
+     bool unique=MACH_READ_FROM(uint32_t,pos)!=0;pos+=sizeof(uint32_t);
+     uint32_t IncludeMapSize=MACH_READ_FROM(uint32_t,pos);pos+=sizeof(uint32_t);
+     std::vector<uint32_t> includemap;
+     for(uint32_t i=0;i<IncludeMapSize;i++)
+     {
+        includemap.push_back(MACH_READ_FROM(uint32_t,pos));
+        pos+=sizeof(uint32_t);
+     }
+     uint32_t indexTypeLen=MACH_READ_FROM(uint32_t,pos);pos+=sizeof(uint32_t);
+     std::string IndexType(pos,indexTypeLen);
+     pos+=indexTypeLen;
+    index_meta=IndexMetadata::Create(indexid,IndexName,tableid,keymap,heap,unique,includemap,IndexType);
     return pos-buf;
 }
\ No newline at end of file
@@ -1,7 +1,7 @@
 #include "catalog/table.h"
 
 uint32_t TableMetadata::SerializeTo(char *buf) const {
-  //table_id_(unit32);table_name_(uint32_t+string);root_page_id_(uint_32t);schema(Serialize it)
+  //table_id_(unit32);table_name_(uint32_t+string);root_page_id_(uint_32t);fsm_page_id_(uint32_t);layout_(uint32_t);schema(Serialize it)
 
   char* pos=buf;
   memcpy(pos,&table_id_,sizeof(uint32_t));
@@ -13,13 +13,17 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
    pos+=tablename_len;
    memcpy(pos,&root_page_id_,sizeof(uint32_t));
    pos+=sizeof(uint32_t);
+   memcpy(pos,&fsm_page_id_,sizeof(uint32_t));
+   pos+=sizeof(uint32_t);
+   memcpy(pos,&layout_,sizeof(uint32_t));
+   pos+=sizeof(uint32_t);
    pos+=schema_->SerializeTo(pos);//Add Length of (serialized schema) into pos
    return pos-buf;
 }
 
 uint32_t TableMetadata::GetSerializedSize() const {
 
-  return sizeof(uint32_t)*3+table_name_.size()+schema_->GetSerializedSize();
+  return sizeof(uint32_t)*5+table_name_.size()+schema_->GetSerializedSize();
 }
 
 /**
@@ -34,11 +38,13 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta, M
      TableName.append(pos,stringlen);//Update string
      pos+=stringlen;
     uint32_t RootPageID=MACH_READ_FROM(uint32_t,pos);pos+=sizeof(uint32_t);
+    page_id_t FsmPageID=MACH_READ_FROM(page_id_t,pos);pos+=sizeof(uint32_t);
+    TableLayout Layout=static_cast<TableLayout>(MACH_READ_FROM(uint32_t,pos));pos+=sizeof(uint32_t);
     Schema*schema=NULL;
     pos+=Schema::DeserializeFrom(pos,schema,heap);//new schema
 
     void *mem=heap->Allocate(sizeof(TableMetadata));//Allocate space for TableMetaData
-   table_meta = new(mem)TableMetadata(TableID,TableName,RootPageID,schema);
+   table_meta = new(mem)TableMetadata(TableID,TableName,RootPageID,schema,FsmPageID,Layout);
    return pos-buf;
 }
 
@@ -48,11 +54,14 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta, M
  * @param heap Memory heap passed by TableInfo
  */
 TableMetadata *TableMetadata::Create(table_id_t table_id, std::string table_name,
-                                     page_id_t root_page_id, TableSchema *schema, MemHeap *heap) {
+                                     page_id_t root_page_id, TableSchema *schema, MemHeap *heap,
+                                     page_id_t fsm_page_id, TableLayout layout) {
   // allocate space for table metadata
   void *buf = heap->Allocate(sizeof(TableMetadata));
-  return new(buf)TableMetadata(table_id, table_name, root_page_id, schema);
+  return new(buf)TableMetadata(table_id, table_name, root_page_id, schema, fsm_page_id, layout);
 }
 
-TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema)
-        : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id), schema_(schema) {}
+TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema,
+                             page_id_t fsm_page_id, TableLayout layout)
+        : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id), fsm_page_id_(fsm_page_id),
+          layout_(layout), schema_(schema) {}
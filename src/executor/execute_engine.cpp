@@ -1,4 +1,5 @@
 #include "executor/execute_engine.h"
+#include "storage/parallel_table_scan.h"
 #include <iostream>
 #include <fstream>
 #include <cstdio>
@@ -6,6 +7,7 @@
 #include <iomanip>
 #include <map>
 #include <cstdlib>
+#include <cstring>
 #include <algorithm>
 #include <set>
 
@@ -131,12 +133,23 @@ dberr_t ExecuteEngine::Execute(pSyntaxNode ast, ExecuteContext* context) {
         return ExecuteCreateIndex(ast, context);
     case kNodeDropIndex:
         return ExecuteDropIndex(ast, context);
+    case kNodeAnalyze:
+        return ExecuteAnalyze(ast, context);
+    case kNodeVacuum:
+        return ExecuteVacuum(ast, context);
     case kNodeSelect:
         return ExecuteSelect(ast, context);
     case kNodeInsert:
         return ExecuteInsert(ast, context);
     case kNodeDelete:
-        return ExecuteDelete(ast, context);
+    {
+        dberr_t res = ExecuteDelete(ast, context);
+        if (res == DB_SUCCESS)
+        {
+            AutoVacuum(ast->child_->val_);
+        }
+        return res;
+    }
     case kNodeUpdate:
         return ExecuteUpdate(ast, context);
     case kNodeTrxBegin:
@@ -374,6 +387,21 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext* conte
 
 
         pSyntaxNode defList = ast->child_->next_;
+        //WITH (layout = row | columnar)
+        TableLayout layout = kLayoutRow;
+        if (defList->next_ != nullptr && defList->next_->type_ == kNodeTableLayout)
+        {
+            string layoutName = defList->next_->child_->val_;
+            if (strcasecmp(layoutName.c_str(), "columnar") == 0)
+            {
+                layout = kLayoutColumnar;
+            }
+            else if (strcasecmp(layoutName.c_str(), "row") != 0)
+            {
+                std::cout << "minisql: Unknown table layout " << layoutName << ".\n";
+                return DB_FAILED;
+            }
+        }
         if (defList->child_ != nullptr)
         {
             std::vector<Column*> columns;
@@ -423,6 +451,11 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext* conte
                     if (str.find('.') == str.npos && str.find('-') == str.npos)
                     {
                         uint32_t length = atoi(str.c_str());
+                        if (length >= VARCHAR_MAX_LEN)
+                        {
+                            std::cout << "minisql: Input error.\n";
+                            return DB_FAILED;
+                        }
 
                         Column* column = new Column(name, type, length, index, nullable, unique);
                         columns.push_back(column);
@@ -480,11 +513,23 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext* conte
 
             //创建table，组装
             TableSchema* schema = new TableSchema(columns);
-            if (curDB->catalog_mgr_->CreateTable(tableName, schema, nullptr, tableInfo) == DB_SUCCESS)
+            if (layout == kLayoutColumnar && ColumnarPage::GetCapacity(schema) == 0)
+            {
+                //列存页至少要放下一整行
+                std::cout << "minisql: Row is too long for a columnar table.\n";
+                return DB_FAILED;
+            }
+            if (curDB->catalog_mgr_->CreateTable(tableName, schema, nullptr, tableInfo, layout) == DB_SUCCESS)
             {
                 IndexInfo* pkinfo = IndexInfo::Create(new SimpleMemHeap());
                 string pkindexName = ";PK" + tableName;
-                curDB->catalog_mgr_->CreateIndex(tableName, pkindexName, pkNames, nullptr, pkinfo);
+                if (curDB->catalog_mgr_->CreateIndex(tableName, pkindexName, pkNames, nullptr, pkinfo) == DB_INDEX_KEY_TOO_LONG)
+                {
+                    //约束依赖索引，key过长时不建表
+                    std::cout << "minisql[ERROR]: Primary key is too long to be indexed.\n";
+                    curDB->catalog_mgr_->DropTable(tableName);
+                    return DB_FAILED;
+                }
                 
                 for (auto uniCol : uniqueNames)
                 {
@@ -492,7 +537,12 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext* conte
                     uname.push_back(uniCol);
                     IndexInfo* uinfo = IndexInfo::Create(new SimpleMemHeap());
                     string uindexName = ";UNI" + tableName + uniCol;
-                    curDB->catalog_mgr_->CreateIndex(tableName, uindexName, uname, nullptr, uinfo);
+                    if (curDB->catalog_mgr_->CreateIndex(tableName, uindexName, uname, nullptr, uinfo) == DB_INDEX_KEY_TOO_LONG)
+                    {
+                        std::cout << "minisql[ERROR]: Unique column " << uniCol << " is too long to be indexed.\n";
+                        curDB->catalog_mgr_->DropTable(tableName);
+                        return DB_FAILED;
+                    }
                 }
                 std::cout << "minisql: Create table successfully.\n";
                 return DB_SUCCESS;
@@ -697,6 +747,8 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext* conte
                 index_keys.push_back(cName);
             }
 
+            //有非unique列时建立非唯一索引，key后附加rowid
+            bool unique = true;
             for (string indexCol : index_keys)
             {
                 auto i = colMap.find(indexCol);
@@ -705,67 +757,60 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext* conte
                     //查到
                     if (!i->second->IsUnique())
                     {
-                        std::cout << "minisql: Exist non-unique column.\n";
+                        unique = false;
+                    }
+                }
+            }
+
+            //INCLUDE的列只存进叶子，不参与比较
+            std::vector<string> include_keys;
+            pSyntaxNode typeNode = colList->next_;
+            if (typeNode != nullptr && typeNode->type_ == kNodeColumnList)
+            {
+                for (auto col = typeNode->child_; col != nullptr; col = col->next_)
+                {
+                    string cName = col->val_;
+                    if (colMap.find(cName) == colMap.end())
+                    {
+                        std::cout << "minisql: No column.\n";
                         return DB_FAILED;
                     }
+                    include_keys.push_back(cName);
+                }
+                typeNode = typeNode->next_;
+            }
+
+            //特定的数据结构，默认B+树
+            string indextypeName = "bptree";
+            if (typeNode != nullptr)
+            {
+                if (typeNode->child_ == nullptr)
+                {
+                    std::cout << "minisql[ERROR]: Failed.\n";
+                    return DB_FAILED;
                 }
+                indextypeName = typeNode->child_->val_;
             }
 
             IndexInfo* index_info = IndexInfo::Create(new SimpleMemHeap());
-            if (colList->next_ == nullptr)
+            if (indextypeName == "bptree" || indextypeName == "hash" || indextypeName == "art")
             {
-                if (curDB->catalog_mgr_->CreateIndex(tableName, indexName, index_keys, nullptr, index_info) == DB_SUCCESS)
+                dberr_t createState = curDB->catalog_mgr_->CreateIndex(tableName, indexName, index_keys, nullptr, index_info, unique, include_keys, indextypeName);
+                if (createState == DB_INDEX_KEY_TOO_LONG)
+                {
+                    std::cout << "minisql[ERROR]: Index key is too long.\n";
+                    return DB_FAILED;
+                }
+                if (createState == DB_SUCCESS)
                 {
                     TableInfo* tableInfo = TableInfo::Create(new SimpleMemHeap());
                     if (curDB->catalog_mgr_->GetTable(tableName, tableInfo) == DB_SUCCESS) //找到这个名字了，继续
                     {
-                        //把现在数据InsertEntry
-                        for (auto iter = tableInfo->GetTableHeap()->Begin(nullptr); iter != tableInfo->GetTableHeap()->End(); iter++)
+                        //扫描一遍表，批量建立索引
+                        if (curDB->catalog_mgr_->BuildIndexes(tableInfo, { index_info }, nullptr) != DB_SUCCESS)
                         {
-                            //遍历每一行
-                            std::vector<Field*> fields = iter->GetFields();
-                            std::map<string, Field*> valMap; //用于寻找对应field的map
-
-                            //判断field和column大小是否相等
-                            if (columns.size() == fields.size())
-                            {
-                                for (uint32_t index = 0; index < columns.size(); index++)
-                                {
-                                    valMap.insert(std::pair<string, Field*>(columns[index]->GetName(), fields[index]));
-                                }
-
-                                std::vector<Field> indexfields;
-                                for (string indexCol : index_keys)
-                                {
-                                    auto i = valMap.find(indexCol);
-                                    if (i != valMap.end())
-                                    {
-                                        //查到了
-                                        indexfields.push_back(*(i->second));
-                                    }
-                                }
-
-                                Row indexRow(indexfields);
-                                uint32_t size = indexRow.GetSerializedSize(nullptr);
-                                if (size > 32)
-                                {
-                                    std::cout << "minisql: Too long key.\n";
-                                    curDB->catalog_mgr_->DropIndex(tableName, indexName);
-                                    return DB_FAILED;
-                                }
-                                RowId rid = iter->GetRowId();
-                                if (index_info->GetIndex()->InsertEntry(indexRow, rid, nullptr) == DB_SUCCESS)
-                                {
-                                }
-                                else {
-                                    std::cout << "minisql: Failed.\n";
-                                    return DB_FAILED;
-                                }
-                            }
-                            else {
-                                std::cout << "minisql: Failed.\n";
-                                return DB_FAILED;
-                            }
+                            std::cout << "minisql: Failed.\n";
+                            return DB_FAILED;
                         }
                         std::cout << "minisql: Create index successfully.\n";
                         return DB_SUCCESS;
@@ -781,26 +826,8 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext* conte
                 }
             }
             else {
-                //特定的数据结构
-                pSyntaxNode indexType = colList->next_->child_;
-                if (indexType != nullptr)
-                {
-                    string indextypeName = indexType->val_;
-
-                    if (indextypeName != "bptree")
-                    {
-                        std::cout << "minisql[ERROR]: No support.\n";
-                        return DB_FAILED;
-                    }
-                    else {
-                        std::cout << "minisql[ERROR]: Please use create index without using.\n";
-                    }
-                    return DB_SUCCESS;
-                }
-                else {
-                    std::cout << "minisql[ERROR]: Failed.\n";
-                    return DB_FAILED;
-                }
+                std::cout << "minisql[ERROR]: No support.\n";
+                return DB_FAILED;
             }
         }
         else {
@@ -859,270 +886,310 @@ dberr_t ExecuteEngine::ExecuteDropIndex(pSyntaxNode ast, ExecuteContext* context
     return DB_FAILED;
 }
 
+/// <summary>
+/// 重新统计表上所有索引，并输出统计
+/// </summary>
+/// <param name="ast"></param>
+/// <param name="context"></param>
+/// <returns></returns>
+dberr_t ExecuteEngine::ExecuteAnalyze(pSyntaxNode ast, ExecuteContext* context) {
+    if (current_db_ == "")
+    {
+        std::cout << "minisql: No database selected.\n";
+        return DB_FAILED;
+    }
+    string tableName = ast->child_->val_;
+    if (curDB->catalog_mgr_->AnalyzeTable(tableName, nullptr) != DB_SUCCESS)
+    {
+        std::cout << "minisql: No table.\n";
+        return DB_FAILED;
+    }
+    std::vector<IndexInfo*> indexes;
+    curDB->catalog_mgr_->GetTableIndexes(tableName, indexes);
+    for (auto indexinfo : indexes)
+    {
+        string indexName = indexinfo->GetIndexName();
+        IndexStatistics* stats = indexinfo->GetIndex()->GetStatistics();
+        if (indexName[0] == ';' || stats == nullptr)
+        {
+            continue;
+        }
+        std::streamsize precision = std::cout.precision();
+        std::cout << indexName << ": entries " << stats->GetEntryCount() << ", distinct " << stats->GetDistinctCount()
+                  << ", height " << stats->GetHeight() << ", leaves " << stats->GetLeafCount() << ", fill "
+                  << std::fixed << std::setprecision(1) << stats->GetAverageFill() * 100 << "%" << std::endl;
+        std::cout.unsetf(std::ios::fixed);
+        std::cout.precision(precision);
+    }
+    std::cout << "minisql: Analyze " << tableName << "." << std::endl;
+    return DB_SUCCESS;
+}
+
+/// <summary>
+/// 压紧表：页内压紧slot，稀疏的相邻页合并，空页还给磁盘，索引跟着改RowId
+/// </summary>
+/// <param name="ast"></param>
+/// <param name="context"></param>
+/// <returns></returns>
+dberr_t ExecuteEngine::ExecuteVacuum(pSyntaxNode ast, ExecuteContext* context) {
+    if (current_db_ == "")
+    {
+        std::cout << "minisql: No database selected.\n";
+        return DB_FAILED;
+    }
+    string tableName = ast->child_->val_;
+    uint32_t freedPages = 0;
+    dberr_t res = curDB->catalog_mgr_->VacuumTable(tableName, nullptr, &freedPages);
+    if (res == DB_TABLE_NOT_EXIST)
+    {
+        std::cout << "minisql: No table.\n";
+        return DB_FAILED;
+    }
+    if (res != DB_SUCCESS)
+    {
+        std::cout << "minisql[ERROR]: Vacuum failed.\n";
+        return DB_FAILED;
+    }
+    std::cout << "minisql: Vacuum " << tableName << ", " << freedPages << " pages freed." << std::endl;
+    return DB_SUCCESS;
+}
+
+/// <summary>
+/// DELETE之后表里空闲空间太多时自动压紧，不输出
+/// </summary>
+/// <param name="tableName"></param>
+void ExecuteEngine::AutoVacuum(const std::string& tableName)
+{
+    TableInfo* tableInfo = nullptr;
+    if (curDB->catalog_mgr_->GetTable(tableName, tableInfo) == DB_SUCCESS && tableInfo->GetTableHeap()->NeedsVacuum())
+    {
+        curDB->catalog_mgr_->VacuumTable(tableName, nullptr);
+    }
+}
 
+uint64_t ExecuteEngine::EstimateKeyRows(IndexInfo* indexInfo)
+{
+    IndexStatistics* stats = indexInfo->GetIndex()->GetStatistics();
+    return stats == nullptr ? UINT64_MAX : stats->EstimateEqual();
+}
 
 
 
 /// <summary>
-/// where子句分析
+/// where子句编译：扫描前在调用线程上检查一次子句，有错只在这里输出一次，
+/// 比较里的列名换成列号、常数先转成值，扫描时逐行判断不再查列名、不新建field
 /// </summary>
-/// <param name="valMap"></param>
-/// <param name="typeMap"></param>
+/// <param name="columnIds">列名到表中列号</param>
+/// <param name="columns"></param>
 /// <param name="kNode"></param>
-/// <returns></returns>
-bool ExecuteEngine::ClauseAnalysis(std::map<string, Field*>& valMap, std::map<string, TypeId>& typeMap, pSyntaxNode kNode)
+/// <param name="nodes">编译结果，子节点在父节点前面</param>
+/// <returns>kNode编译后在nodes里的下标</returns>
+int ExecuteEngine::ClauseCompile(std::map<string, uint32_t>& columnIds, std::vector<Column*>& columns, pSyntaxNode kNode, std::vector<clauseNode>& nodes)
 {
-    if (kNode->child_ != nullptr && kNode->child_->next_ != nullptr)
+    //出错的子句编译成不成立的常数
+    clauseNode node;
+    node.kind = clauseNode::kConstant;
+    if (kNode->child_ == nullptr || kNode->child_->next_ == nullptr || kNode->val_ == nullptr)
+    {
+        std::cout << "Clause error\n";
+    }
+    else if (kNode->type_ == kNodeConnector)
     {
         string val = kNode->val_;
-        string name = ""; //仅在比较运算里用
-        switch (kNode->type_)
+        if (val == "and" || val == "or")
         {
-        case kNodeCompareOperator:
-            name = kNode->child_->val_;
-            if (val == "is")
+            node.kind = val == "and" ? clauseNode::kAnd : clauseNode::kOr;
+            node.left = ClauseCompile(columnIds, columns, kNode->child_, nodes);
+            node.right = ClauseCompile(columnIds, columns, kNode->child_->next_, nodes);
+        }
+        else {
+            std::cout << "Clause error\n";
+        }
+    }
+    else if (kNode->type_ != kNodeCompareOperator)
+    {
+        std::cout << "Clause error\n";
+    }
+    else {
+        string val = kNode->val_;
+        auto idIt = kNode->child_->val_ == nullptr ? columnIds.end() : columnIds.find(kNode->child_->val_);
+        pSyntaxNode constant = kNode->child_->next_;
+        string str = constant->val_ == nullptr ? "" : constant->val_; //语法树的原始比较数据
+        if (idIt == columnIds.end())
+        {
+            std::cout << "MiniSql: Input error\n";
+        }
+        else if (val == "is" || val == "not")
+        {
+            node.kind = val == "is" ? clauseNode::kIsNull : clauseNode::kNotNull;
+            node.column = idIt->second;
+        }
+        else if (constant->type_ == kNodeNull)
+        {
+            std::cout << "MiniSql: Use is/not instead of \'=\' or \'<>\'.\n";
+        }
+        else if (val != "=" && val != "<>" && val != "<" && val != "<=" && val != ">" && val != ">=")
+        {
+            std::cout << "MiniSql: Failed\n";
+        }
+        else {
+            node.cmp = val;
+            node.column = idIt->second;
+            node.type = columns[node.column]->GetType();
+            if (constant->type_ == kNodeNumber && node.type == kTypeInt)
             {
-                auto it = valMap.find(name);
-                if (it != valMap.end())
+                //原数据是整数，输入的数据不是整数报错，这时和原来一样当作满足
+                if (str.find('.') == str.npos)
                 {
-                    if (it->second->IsNull())
-                    {
-                        return true;
-                    }
-                    else {
-                        return false;
-                    }
+                    node.kind = clauseNode::kCompare;
+                    node.integer = atoi(str.c_str());
                 }
                 else {
-                    std::cout << "MiniSql: Input error\n";
-                    return false;
-                }        
+                    std::cout << "minisql[ERROR]: Input error.\n";
+                    node.result = true;
+                }
             }
-            else if (val == "not")
+            else if (constant->type_ == kNodeNumber && node.type == kTypeFloat)
             {
-                auto it = valMap.find(name);
-                if (it != valMap.end())
-                {
-                    if (it->second->IsNull())
-                    {
-                        return false;
-                    }
-                    else {
-                        return true;
-                    }
-                }
-                else {
-                    std::cout << "MiniSql: Input error\n";
-                    return false;
-                }
+                //输入整数也当作小数
+                node.kind = clauseNode::kCompare;
+                node.real = atof(str.c_str());
+            }
+            else if (constant->type_ == kNodeString && node.type == kTypeChar)
+            {
+                node.kind = clauseNode::kCompare;
+                node.chars = str;
+            }
+            else if (constant->type_ == kNodeNumber || constant->type_ == kNodeString)
+            {
+                std::cout << "MiniSql: Type error\n";
             }
             else {
-                auto typeIt = typeMap.find(name);
-                auto valIt = valMap.find(name);
-                if (typeIt != typeMap.end() && valIt != valMap.end())
-                {
-                    TypeId type = typeIt->second; //表中的类型
-                    Field* dataField = valIt->second; //表中实际的field
-                    string str = kNode->child_->next_->val_; //语法树的原始比较数据
+                std::cout << "MiniSql: Failed.\n";
+            }
+        }
+    }
+    nodes.push_back(node);
+    return nodes.size() - 1;
+}
 
-                    if (kNode->child_->next_->type_ == kNodeNull)
-                    {
-                        std::cout << "MiniSql: Use is/not instead of \'=\' or \'<>\'.\n";
-                        return false;
-                    }
+/// <summary>
+/// 比较结果按运算符换成真假
+/// </summary>
+/// <param name="cmp">= <> < <= > >=之一</param>
+/// <param name="ret">值和常数比较，负数、0、正数分别是小于、等于、大于</param>
+static bool CompareResult(const string& cmp, int ret)
+{
+    switch (cmp[0])
+    {
+    case '=':
+        return ret == 0;
+    case '<':
+        if (cmp.size() == 1)
+        {
+            return ret < 0;
+        }
+        return cmp[1] == '=' ? ret <= 0 : ret != 0;
+    default:
+        return cmp.size() == 1 ? ret > 0 : ret >= 0;
+    }
+}
 
-                    Field* inField;
-                    //根据不同类型装载field
-                    
-                    switch (kNode->child_->next_->type_)
-                    {
-                    case kNodeNumber:
-                        if (type == kTypeInt)
-                        {
-                            //  原数据是整数，输入的数据不是整数报错
-                            if (str.find('.') == str.npos)
-                            {
-                                int32_t num = atoi(str.c_str());
-                                inField = new Field(type, num);
-                            }
-                            else {
-                                std::cout << "minisql[ERROR]: Input error.\n";
-                                return DB_FAILED;
-                            }
-                        }
-                        else {
-                            // 原数据是小数，输入数据直接装进field，输入整数也当作小数
-                            float num = atof(kNode->child_->next_->val_);
-                            inField = new Field(type, num);
-                        }
-                        break;
-                    case kNodeString:
-                        inField = new Field(type, kNode->child_->next_->val_, dataField->GetLength(), true);
-                        break;
-                    default:
-                        std::cout << "MiniSql: Failed.\n";
-                        return false;
-                        break;
-                    }
+/// <summary>
+/// CHAR值和常数比较：=和<>按C字符串比，其余把常数补0到值长后按字节比
+/// </summary>
+static int CompareChars(const string& cmp, const string& constant, const char* data, uint32_t len)
+{
+    uint32_t size = std::min<uint32_t>(len, constant.size());
+    if (cmp == "=" || cmp == "<>")
+    {
+        return strnlen(data, len) == size && memcmp(data, constant.data(), size) == 0 ? 0 : 1;
+    }
+    int ret = memcmp(data, constant.data(), size);
+    for (uint32_t i = size; ret == 0 && i < len; i++)
+    {
+        ret = data[i] != '\0';
+    }
+    return ret;
+}
 
-                    //根据不同运算符进行运算
-                    CmpBool res;
-                    if (dataField->CheckComparable(*inField))
-                    {
-                        switch (val[0])
-                        {
-                        case '=':
-                            if (dataField->GetType() == kTypeChar && inField->GetType() == kTypeChar)
-                            {
-                                string a = dataField->GetChars();
-                                string b = inField->GetChars();
-                                if (a == b)
-                                {
-                                    return true;
-                                }
-                                else {
-                                    return false;
-                                }
-                            }
-                            res = dataField->CompareEquals(*inField);
-                            if (res != kNull)
-                            {
-                                return res == kTrue ? true : false;
-                            }
-                            else {
-                                std::cout << "MiniSql: Failed\n";
-                                return false;
-                            }
-                            break;
-                        case '<':
-                            if (val == "<=")
-                            {
-                                res = dataField->CompareLessThanEquals(*inField);
-                                if (res != kNull)
-                                {
-                                    return res == kTrue ? true : false;
-                                }
-                                else {
-                                    std::cout << "MiniSql: Failed\n";
-                                    return false;
-                                }
-                            }
-                            else if (val == "<")
-                            {
-                                res = dataField->CompareLessThan(*inField);
-                                if (res != kNull)
-                                {
-                                    return res == kTrue ? true : false;
-                                }
-                                else {
-                                    std::cout << "MiniSql: Failed\n";
-                                    return false;
-                                }
-                            }
-                            else if (val == "<>")
-                            {
-                                if (dataField->GetType() == kTypeChar && inField->GetType() == kTypeChar)
-                                {
-                                    string a = dataField->GetChars();
-                                    string b = inField->GetChars();
-                                    if (a == b)
-                                    {
-                                        return false;
-                                    }
-                                    else {
-                                        return true;
-                                    }
-                                }
-                                res = dataField->CompareNotEquals(*inField);
-                                if (res != kNull)
-                                {
-                                    return res == kTrue ? true : false;
-                                }
-                                else {
-                                    std::cout << "MiniSql: Failed\n";
-                                    return false;
-                                }
-                            }
-                            else {
-                                std::cout << "MiniSql: Failed\n";
-                                return false;
-                            }
-                            break;
-                        case '>':
-                            if (val == ">=")
-                            {
-                                res = dataField->CompareGreaterThanEquals(*inField);
-                                if (res != kNull)
-                                {
-                                    return res == kTrue ? true : false;
-                                }
-                                else {
-                                    std::cout << "MiniSql: Failed\n";
-                                    return false;
-                                }
-                            }
-                            else if (val == ">")
-                            {
-                                res = dataField->CompareGreaterThan(*inField);
-                                if (res != kNull)
-                                {
-                                    return res == kTrue ? true : false;
-                                }
-                                else {
-                                    std::cout << "MiniSql: Failed\n";
-                                    return false;
-                                }
-                            }
-                            else {
-                                std::cout << "MiniSql: Failed\n";
-                                return false;
-                            }
-                            break;
-                        default:
-                            std::cout << "MiniSql: Failed\n";
-                            return false;
-                            break;
-                        }
-
-                    }
-                    else {
-                        std::cout << "MiniSql: Type error\n";
-                        return false;
-                    }
-                }
-                else {
-                    std::cout << "MiniSql: Input error\n";
-                    return false;
-                }
-            }
-            break;
-        case kNodeConnector:
-            if (val == "and")
-            {
-                return ClauseAnalysis(valMap, typeMap, kNode->child_) && ClauseAnalysis(valMap, typeMap, kNode->child_->next_);
-            }
-            else if (val == "or")
-            {
-                return ClauseAnalysis(valMap, typeMap, kNode->child_) || ClauseAnalysis(valMap, typeMap, kNode->child_->next_);
-            }
-            else {
-                std::cout << "Clause error\n";
-                return false;
-            }
-            break;
-        default:
-            std::cout << "Clause error\n";
-            return false;
-            break;
-        }
+/// <summary>
+/// 用编译好的子句判断一行，不输出、不分配内存，可以在扫描线程里调用
+/// </summary>
+/// <param name="nodes"></param>
+/// <param name="index">要判断的节点</param>
+/// <param name="source">按表中列号取值，有IsNull、GetInteger、GetFloat、GetChars、GetLength</param>
+template <typename Source>
+bool ExecuteEngine::ClauseMatch(const std::vector<clauseNode>& nodes, int index, const Source& source)
+{
+    const clauseNode& node = nodes[index];
+    switch (node.kind)
+    {
+    case clauseNode::kAnd:
+        return ClauseMatch(nodes, node.left, source) && ClauseMatch(nodes, node.right, source);
+    case clauseNode::kOr:
+        return ClauseMatch(nodes, node.left, source) || ClauseMatch(nodes, node.right, source);
+    case clauseNode::kIsNull:
+        return source.IsNull(node.column);
+    case clauseNode::kNotNull:
+        return !source.IsNull(node.column);
+    case clauseNode::kConstant:
+        return node.result;
+    default:
+        break;
     }
-    else {
-        std::cout << "Clause error\n";
+    //null和任何值比较都不成立
+    if (source.IsNull(node.column))
+    {
         return false;
     }
-    return false;
+    switch (node.type)
+    {
+    case kTypeInt:
+    {
+        int32_t value = source.GetInteger(node.column);
+        return CompareResult(node.cmp, (value > node.integer) - (value < node.integer));
+    }
+    case kTypeFloat:
+    {
+        float value = source.GetFloat(node.column);
+        return CompareResult(node.cmp, (value > node.real) - (value < node.real));
+    }
+    default:
+        return CompareResult(node.cmp, CompareChars(node.cmp, node.chars, source.GetChars(node.column), source.GetLength(node.column)));
+    }
 }
 
+/// <summary>
+/// 一行的field，按表中列号给ClauseMatch取值；页上的元组直接用TupleView，只有溢出页里的长值要先读成field
+/// </summary>
+struct FieldSource
+{
+    const std::vector<Field>& fields;
+
+    bool IsNull(uint32_t i) const { return fields[i].IsNull(); }
+    int32_t GetInteger(uint32_t i) const { return fields[i].GetInteger(); }
+    float GetFloat(uint32_t i) const { return fields[i].GetFloat(); }
+    const char* GetChars(uint32_t i) const { return fields[i].GetData(); }
+    uint32_t GetLength(uint32_t i) const { return fields[i].GetLength(); }
+};
+
+/// <summary>
+/// 批里的一行，按表中列号给ClauseMatch取值，不拷贝
+/// </summary>
+struct BatchSource
+{
+    const RowBatch& batch;
+    const std::vector<int>& positionOf;
+    uint32_t row;
+
+    bool IsNull(uint32_t i) const { return batch.GetColumn(positionOf[i]).IsNull(row); }
+    int32_t GetInteger(uint32_t i) const { return batch.GetColumn(positionOf[i]).GetInteger(row); }
+    float GetFloat(uint32_t i) const { return batch.GetColumn(positionOf[i]).GetFloat(row); }
+    const char* GetChars(uint32_t i) const { return batch.GetColumn(positionOf[i]).GetChars(row); }
+    uint32_t GetLength(uint32_t i) const { return batch.GetColumn(positionOf[i]).GetLength(row); }
+};
+
 /// <summary>
 /// 子句提取
 /// </summary>
@@ -1215,7 +1282,9 @@ bool ExecuteEngine::ClauseAndParser(std::map<std::string, TypeId>& typeMap, std:
                     }
                     break;
                 case kNodeString:
-                    f = new Field(typeIter->second, kNode->child_->next_->val_, lengthIter->second, true);
+                    //补0到列长，不能越过字符串末尾读取
+                    str.resize(lengthIter->second, '\0');
+                    f = new Field(typeIter->second, const_cast<char*>(str.data()), lengthIter->second, true);
                     break;
                 default:
                     std::cout << "MiniSql: Failed.\n";
@@ -1449,6 +1518,554 @@ bool ExecuteEngine::RecordJudge(Row& row, std::map<std::string, fieldCmp>& parse
 }
 
 
+/// <summary>
+/// 收集一行在每个索引中的key，keys[i]/ids[i]对应indexes[i]
+/// </summary>
+/// <param name="indexes"></param>
+/// <param name="fields">整行的field</param>
+/// <param name="rid"></param>
+/// <param name="keys"></param>
+/// <param name="ids"></param>
+void ExecuteEngine::CollectIndexKeys(std::vector<IndexInfo*>& indexes, std::vector<Field*>& fields, const RowId& rid, std::vector<std::vector<Row>>& keys, std::vector<std::vector<RowId>>& ids)
+{
+    for (size_t i = 0; i < indexes.size(); i++)
+    {
+        std::vector<Field> indexFields;
+        for (auto col : indexes[i]->GetIndexKeySchema()->GetColumns()) //每个索引列
+        {
+            indexFields.push_back(*(fields[col->GetTableInd()]));
+        }
+        keys[i].push_back(Row(indexFields));
+        ids[i].push_back(rid);
+    }
+}
+
+/// <summary>
+/// 批量移除收集到的索引key，每个索引排序后一次遍历叶子
+/// </summary>
+/// <param name="indexes"></param>
+/// <param name="keys"></param>
+/// <param name="ids"></param>
+/// <returns></returns>
+bool ExecuteEngine::RemoveIndexKeys(std::vector<IndexInfo*>& indexes, std::vector<std::vector<Row>>& keys, std::vector<std::vector<RowId>>& ids)
+{
+    for (size_t i = 0; i < indexes.size(); i++)
+    {
+        if (indexes[i]->GetIndex()->RemoveEntries(keys[i], ids[i], nullptr) != DB_SUCCESS)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// <summary>
+/// 更新一行。表里原地改写，rowid不变时只有key或INCLUDE列真的变了的索引才改
+/// </summary>
+/// <param name="tableInfo"></param>
+/// <param name="indexes">表上所有索引</param>
+/// <param name="oldRow">要更新的行，带rowid</param>
+/// <param name="updateFields">每列的新值，不更新的列为nullptr</param>
+/// <returns></returns>
+bool ExecuteEngine::UpdateRow(TableInfo* tableInfo, std::vector<IndexInfo*>& indexes, Row& oldRow, std::vector<Field*>& updateFields)
+{
+    std::vector<Field*> oldFields = oldRow.GetFields();
+    std::vector<Field*> newFields = oldFields;
+    std::vector<bool> changed(oldFields.size(), false);
+    for (size_t i = 0; i < oldFields.size(); i++)
+    {
+        if (updateFields[i] == nullptr)
+        {
+            continue;
+        }
+        newFields[i] = updateFields[i];
+        if (oldFields[i]->IsNull() || updateFields[i]->IsNull())
+        {
+            changed[i] = oldFields[i]->IsNull() != updateFields[i]->IsNull();
+        }
+        else {
+            changed[i] = oldFields[i]->CompareEquals(*updateFields[i]) != kTrue;
+        }
+    }
+
+    //每个索引的key列和INCLUDE列有没有变
+    std::vector<bool> keyChanged(indexes.size(), false);
+    std::vector<bool> touched(indexes.size(), false);
+    for (size_t i = 0; i < indexes.size(); i++)
+    {
+        for (auto col : indexes[i]->GetIndexKeySchema()->GetColumns())
+        {
+            keyChanged[i] = keyChanged[i] || changed[col->GetTableInd()];
+        }
+        touched[i] = keyChanged[i];
+        if (indexes[i]->GetIncludeSchema() != nullptr)
+        {
+            for (auto col : indexes[i]->GetIncludeSchema()->GetColumns())
+            {
+                touched[i] = touched[i] || changed[col->GetTableInd()];
+            }
+        }
+    }
+
+    //改了唯一约束的key，新key不能被别的行占着
+    for (size_t i = 0; i < indexes.size(); i++)
+    {
+        if (!keyChanged[i] || indexes[i]->GetIndexName()[0] != ';' || indexes[i]->GetIndex()->IsEmpty())
+        {
+            continue;
+        }
+        std::vector<Field> keyFields;
+        for (auto col : indexes[i]->GetIndexKeySchema()->GetColumns())
+        {
+            keyFields.push_back(*(newFields[col->GetTableInd()]));
+        }
+        std::vector<RowId> ids;
+        if (indexes[i]->GetIndex()->ScanKey(Row(keyFields), ids, nullptr) == DB_SUCCESS)
+        {
+            std::cout << "minisql[ERROR]: Unique constraint.\n";
+            return false;
+        }
+    }
+
+    std::vector<Field> loadField; //最后加载到row的field
+    for (auto field : newFields)
+    {
+        loadField.push_back(*field);
+    }
+    Row loadRow(loadField);
+    RowId oldId = oldRow.GetRowId();
+    if (!tableInfo->GetTableHeap()->UpdateTuple(loadRow, oldId, nullptr))
+    {
+        return false;
+    }
+    //放不下搬了位置时所有索引都要指向新rowid
+    bool moved = loadRow.GetRowId().Get() != oldId.Get();
+    for (size_t i = 0; i < indexes.size(); i++)
+    {
+        if (!moved && !touched[i])
+        {
+            continue;
+        }
+        std::vector<Field> oldKey;
+        std::vector<Field> newKey;
+        for (auto col : indexes[i]->GetIndexKeySchema()->GetColumns())
+        {
+            oldKey.push_back(*(oldFields[col->GetTableInd()]));
+            newKey.push_back(*(newFields[col->GetTableInd()]));
+        }
+        if (indexes[i]->GetIncludeSchema() != nullptr)
+        {
+            for (auto col : indexes[i]->GetIncludeSchema()->GetColumns())
+            {
+                newKey.push_back(*(newFields[col->GetTableInd()]));
+            }
+        }
+        if (indexes[i]->GetIndex()->RemoveEntry(Row(oldKey), oldId, nullptr) != DB_SUCCESS ||
+            indexes[i]->GetIndex()->InsertEntry(Row(newKey), loadRow.GetRowId(), nullptr) != DB_SUCCESS)
+        {
+            std::cout << "minisql[ERROR]: Index " << indexes[i]->GetIndexName() << " failed.\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+/// <summary>
+/// 覆盖索引查询：要输出和过滤的列都在索引的key或INCLUDE里时，直接从叶子拼出行，不回表
+/// </summary>
+/// <param name="indexinfo"></param>
+/// <param name="cmpState">0完全等于 1大于范围 2小于范围</param>
+/// <param name="keyRow"></param>
+/// <param name="columns">表的所有列</param>
+/// <param name="isPrint"></param>
+/// <param name="indexFinal"></param>
+/// <param name="etcFinal"></param>
+/// <param name="idxMap"></param>
+/// <param name="result">满足条件的行，没覆盖到的列为NULL</param>
+/// <returns>索引不能覆盖时返回false</returns>
+bool ExecuteEngine::CoveringScan(IndexInfo* indexinfo, int cmpState, Row& keyRow, std::vector<Column*>& columns, int* isPrint, std::map<std::string, fieldCmp>& indexFinal, std::map<std::string, fieldCmp>& etcFinal, std::map<std::string, uint32_t>& idxMap, std::vector<Row>& result)
+{
+    if (indexinfo->GetIncludeSchema() == nullptr || cmpState < 0)
+    {
+        return false;
+    }
+    //叶子里每一列对应的表列号
+    std::vector<uint32_t> entryCols;
+    for (auto col : indexinfo->GetIndexKeySchema()->GetColumns())
+    {
+        entryCols.push_back(col->GetTableInd());
+    }
+    for (auto col : indexinfo->GetIncludeSchema()->GetColumns())
+    {
+        entryCols.push_back(col->GetTableInd());
+    }
+    std::vector<int> entryPos(columns.size(), -1); //表列在叶子里的位置，-1为没覆盖
+    for (uint32_t j = 0; j < entryCols.size(); j++)
+    {
+        entryPos[entryCols[j]] = j;
+    }
+    for (uint32_t index = 0; index < columns.size(); index++)
+    {
+        if (isPrint[index] && entryPos[index] < 0)
+        {
+            return false;
+        }
+    }
+    for (auto& iter : etcFinal)
+    {
+        if (entryPos[idxMap[iter.first]] < 0)
+        {
+            return false;
+        }
+    }
+
+    std::vector<Row> entries;
+    Index* goalIndex = indexinfo->GetIndex();
+    switch (cmpState)
+    {
+    case 0:
+        goalIndex->ScanRangeEntries(&keyRow, &keyRow, entries, nullptr);
+        break;
+    case 1:
+        goalIndex->ScanRangeEntries(&keyRow, nullptr, entries, nullptr);
+        break;
+    default:
+        goalIndex->ScanRangeEntries(nullptr, &keyRow, entries, nullptr);
+        break;
+    }
+    for (auto& entry : entries)
+    {
+        std::vector<Field> fields;
+        for (uint32_t index = 0; index < columns.size(); index++)
+        {
+            if (entryPos[index] >= 0)
+            {
+                fields.push_back(Field(*(entry.GetField(entryPos[index]))));
+            }
+            else {
+                fields.push_back(Field(columns[index]->GetType()));
+            }
+        }
+        Row row(fields);
+        row.SetRowId(entry.GetRowId());
+        if (RecordJudge(row, etcFinal, idxMap) && RecordJudge(row, indexFinal, idxMap))
+        {
+            result.push_back(row);
+        }
+    }
+    return true;
+}
+
+/// <summary>
+/// 收集子句里出现的列名
+/// </summary>
+/// <param name="kNode"></param>
+/// <param name="names"></param>
+void ExecuteEngine::ClauseColumns(pSyntaxNode kNode, std::set<string>& names)
+{
+    for (; kNode != nullptr; kNode = kNode->next_)
+    {
+        if (kNode->type_ == kNodeIdentifier && kNode->val_ != nullptr)
+        {
+            names.insert(kNode->val_);
+        }
+        ClauseColumns(kNode->child_, names);
+    }
+}
+
+/// <summary>
+/// 整列和一个常数比较，循环里没有分支，编译器可以向量化
+/// </summary>
+template <typename T>
+static void CompareVector(const T* values, uint32_t size, const string& op, T constant, std::vector<uint8_t>& selection)
+{
+    uint8_t* out = selection.data();
+    if (op == "=")
+    {
+        for (uint32_t i = 0; i < size; i++) out[i] = values[i] == constant;
+    }
+    else if (op == "<>")
+    {
+        for (uint32_t i = 0; i < size; i++) out[i] = values[i] != constant;
+    }
+    else if (op == "<")
+    {
+        for (uint32_t i = 0; i < size; i++) out[i] = values[i] < constant;
+    }
+    else if (op == "<=")
+    {
+        for (uint32_t i = 0; i < size; i++) out[i] = values[i] <= constant;
+    }
+    else if (op == ">")
+    {
+        for (uint32_t i = 0; i < size; i++) out[i] = values[i] > constant;
+    }
+    else {
+        for (uint32_t i = 0; i < size; i++) out[i] = values[i] >= constant;
+    }
+}
+
+/// <summary>
+/// 在一批列向量上判断编译好的子句：INT/FLOAT列的比较、is/not按整列循环算，CHAR列逐行算
+/// </summary>
+/// <param name="batch"></param>
+/// <param name="positionOf">表中列号到批里列号，没读的列是-1</param>
+/// <param name="nodes"></param>
+/// <param name="index">要判断的节点</param>
+/// <param name="selection">每行一个，满足子句为1</param>
+void ExecuteEngine::FilterBatch(const RowBatch& batch, std::vector<int>& positionOf, std::vector<clauseNode>& nodes, int index, std::vector<uint8_t>& selection)
+{
+    uint32_t size = batch.GetSize();
+    const clauseNode& node = nodes[index];
+    if (node.kind == clauseNode::kAnd || node.kind == clauseNode::kOr)
+    {
+        std::vector<uint8_t> right(size);
+        FilterBatch(batch, positionOf, nodes, node.left, selection);
+        FilterBatch(batch, positionOf, nodes, node.right, right);
+        for (uint32_t i = 0; i < size; i++)
+        {
+            selection[i] = node.kind == clauseNode::kAnd ? (selection[i] & right[i]) : (selection[i] | right[i]);
+        }
+        return;
+    }
+    if (node.kind == clauseNode::kConstant)
+    {
+        std::fill(selection.begin(), selection.begin() + size, node.result);
+        return;
+    }
+    const ColumnVector& column = batch.GetColumn(positionOf[node.column]);
+    if (node.kind == clauseNode::kIsNull || node.kind == clauseNode::kNotNull)
+    {
+        for (uint32_t i = 0; i < size; i++)
+        {
+            selection[i] = column.IsNull(i) == (node.kind == clauseNode::kIsNull);
+        }
+        return;
+    }
+    if (node.type == kTypeInt)
+    {
+        CompareVector(column.GetIntegers(), size, node.cmp, node.integer, selection);
+    }
+    else if (node.type == kTypeFloat)
+    {
+        CompareVector(column.GetFloats(), size, node.cmp, node.real, selection);
+    }
+    else {
+        EvaluateRows(batch, positionOf, nodes, index, selection);
+        return;
+    }
+    //null和任何值比较都不成立
+    for (uint32_t i = 0; i < size; i++)
+    {
+        selection[i] &= !column.IsNull(i);
+    }
+}
+
+/// <summary>
+/// 用一页的zone判断编译好的子句：只有INT/FLOAT列和数字的比较、is null能排除整页，其余都当作可能满足
+/// </summary>
+/// <param name="tableHeap"></param>
+/// <param name="pageId"></param>
+/// <param name="nodes"></param>
+/// <param name="index">要判断的节点</param>
+/// <returns>false时这一页没有行满足子句</returns>
+bool ExecuteEngine::ZoneMayMatch(TableHeap* tableHeap, page_id_t pageId, std::vector<clauseNode>& nodes, int index)
+{
+    const clauseNode& node = nodes[index];
+    ColumnZone zone;
+    switch (node.kind)
+    {
+    case clauseNode::kAnd:
+        return ZoneMayMatch(tableHeap, pageId, nodes, node.left) && ZoneMayMatch(tableHeap, pageId, nodes, node.right);
+    case clauseNode::kOr:
+        return ZoneMayMatch(tableHeap, pageId, nodes, node.left) || ZoneMayMatch(tableHeap, pageId, nodes, node.right);
+    case clauseNode::kConstant:
+        return node.result;
+    case clauseNode::kIsNull:
+        return !tableHeap->GetZone(pageId, node.column, &zone) || zone.null_count > 0;
+    case clauseNode::kCompare:
+        if (node.type == kTypeChar || !tableHeap->GetZone(pageId, node.column, &zone))
+        {
+            return true;
+        }
+        return node.type == kTypeInt ? zone.MayMatch(node.cmp, node.integer) : zone.MayMatch(node.cmp, node.real);
+    default:
+        return true;
+    }
+}
+
+/// <summary>
+/// 逐行判断编译好的子句，直接读批里的列值
+/// </summary>
+/// <param name="batch"></param>
+/// <param name="positionOf">表中列号到批里列号，没读的列是-1</param>
+/// <param name="nodes"></param>
+/// <param name="index">要判断的节点</param>
+/// <param name="selection"></param>
+void ExecuteEngine::EvaluateRows(const RowBatch& batch, std::vector<int>& positionOf, std::vector<clauseNode>& nodes, int index, std::vector<uint8_t>& selection)
+{
+    for (uint32_t i = 0; i < batch.GetSize(); i++)
+    {
+        selection[i] = ClauseMatch(nodes, index, BatchSource{ batch, positionOf, i });
+    }
+}
+
+/// <summary>
+/// 并行扫描整表：按morsel分给各线程，各线程直接在页上判断子句，结果按表中顺序合并
+/// </summary>
+/// <param name="tableInfo"></param>
+/// <param name="clause">子句，nullptr时返回所有行</param>
+/// <param name="result">满足条件的整行，带RowId</param>
+/// <param name="fetchColumns">只有这些列的值会从溢出页读出来，其余列的长值留在溢出页；nullptr时全读</param>
+void ExecuteEngine::ScanTable(TableInfo* tableInfo, pSyntaxNode clause, std::vector<Row>& result, int* fetchColumns)
+{
+    std::vector<Column*> columns = tableInfo->GetSchema()->GetColumns();
+    std::vector<uint32_t> columnIds;
+    std::map<string, uint32_t> nameIds;
+    for (uint32_t index = 0; index < columns.size(); index++)
+    {
+        columnIds.push_back(index);
+        nameIds.insert(std::pair<string, uint32_t>(columns[index]->GetName(), index));
+    }
+    //子句在这里编译一次，有错也只在这里输出，扫描线程里只判断
+    std::vector<clauseNode> nodes;
+    int root = clause == nullptr ? -1 : ClauseCompile(nameIds, columns, clause, nodes);
+    //子句里出现的列判断时要用到完整的值
+    std::set<string> clauseNames;
+    ClauseColumns(clause, clauseNames);
+    std::vector<uint32_t> clauseChars; //子句里的CHAR列，值可能在溢出页里
+    for (uint32_t index = 0; index < columns.size(); index++)
+    {
+        if (columns[index]->GetType() == kTypeChar && clauseNames.count(columns[index]->GetName()) != 0)
+        {
+            clauseChars.push_back(index);
+        }
+    }
+    TableHeap* tableHeap = tableInfo->GetTableHeap();
+    //zone map里范围不可能满足子句的页直接跳过
+    std::vector<page_id_t> pageIds = tableHeap->GetPageIds();
+    if (clause != nullptr)
+    {
+        std::vector<page_id_t> matchIds;
+        for (auto pageId : pageIds)
+        {
+            if (ZoneMayMatch(tableHeap, pageId, nodes, root))
+            {
+                matchIds.push_back(pageId);
+            }
+        }
+        pageIds.swap(matchIds);
+    }
+    if (tableHeap->GetLayout() == kLayoutColumnar)
+    {
+        //列存：只读子句和输出要用的列的minipage，整批先算出选择向量，再拼出符合条件的行
+        std::vector<uint32_t> scanIds;
+        std::vector<int> positionOf(columns.size(), -1);
+        for (uint32_t index = 0; index < columns.size(); index++)
+        {
+            if (fetchColumns == nullptr || fetchColumns[index] || clauseNames.count(columns[index]->GetName()) != 0)
+            {
+                positionOf[index] = scanIds.size();
+                scanIds.push_back(index);
+            }
+        }
+        ParallelTableScan columnScan(tableHeap, scanIds, nullptr, pageIds);
+        std::vector<std::vector<Row>> columnParts(columnScan.GetMorselCount());
+        columnScan.Run([&](const RowBatch& batch, uint32_t morsel) {
+            std::vector<uint8_t> selection(batch.GetSize(), 1);
+            if (clause != nullptr)
+            {
+                FilterBatch(batch, positionOf, nodes, root, selection);
+            }
+            for (uint32_t i = 0; i < batch.GetSize(); i++)
+            {
+                if (!selection[i])
+                {
+                    continue;
+                }
+                //没读的列留成null
+                std::vector<Field> fields;
+                fields.reserve(columns.size());
+                for (uint32_t index = 0; index < columns.size(); index++)
+                {
+                    if (positionOf[index] < 0)
+                    {
+                        fields.emplace_back(columns[index]->GetType());
+                    }
+                    else {
+                        fields.emplace_back(batch.GetColumn(positionOf[index]).GetField(i));
+                    }
+                }
+                columnParts[morsel].emplace_back(fields);
+                columnParts[morsel].back().SetRowId(batch.GetRowId(i));
+            }
+        });
+        for (auto& part : columnParts)
+        {
+            for (auto& row : part)
+            {
+                result.push_back(row);
+            }
+        }
+        return;
+    }
+    ParallelTableScan scan(tableInfo->GetTableHeap(), columnIds, nullptr, pageIds);
+    std::vector<std::vector<Row>> parts(scan.GetMorselCount()); //每个morsel一份结果，不用加锁
+    scan.RunTuples([&](const TupleView& view, const RowId& rid, uint32_t morsel) {
+        if (clause != nullptr)
+        {
+            //直接在页上判断子句，不拷贝、不分配
+            bool external = false;
+            for (auto index : clauseChars)
+            {
+                external = external || (!view.IsNull(index) && view.IsExternal(index));
+            }
+            if (!external)
+            {
+                if (!ClauseMatch(nodes, root, view))
+                {
+                    return;
+                }
+            }
+            else {
+                //子句要比较溢出页里的长值，这一行先读成field
+                std::vector<Field> fields;
+                fields.reserve(columns.size());
+                for (uint32_t index = 0; index < columns.size(); index++)
+                {
+                    fields.emplace_back(view.GetField(index));
+                    if (fields.back().IsExternal() && clauseNames.count(columns[index]->GetName()) != 0)
+                    {
+                        tableHeap->FetchOverflow(&fields.back());
+                    }
+                }
+                if (!ClauseMatch(nodes, root, FieldSource{ fields }))
+                {
+                    return;
+                }
+            }
+        }
+        //符合条件的才拷贝出来，要在unpin之后继续用
+        parts[morsel].emplace_back(rid);
+        view.Materialize(&parts[morsel].back());
+        std::vector<Field*>& rowFields = parts[morsel].back().GetFields();
+        for (uint32_t index = 0; index < rowFields.size(); index++)
+        {
+            if (fetchColumns == nullptr || fetchColumns[index])
+            {
+                tableHeap->FetchOverflow(rowFields[index]);
+            }
+        }
+    });
+    for (auto& part : parts)
+    {
+        for (auto& row : part)
+        {
+            result.push_back(row);
+        }
+    }
+}
+
 /// <summary>
 /// 选择
 /// </summary>
@@ -1553,7 +2170,8 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext* context) {
                                     if (colNameSet.size() == indexParser.size())
                                     {
                                         //符合index查询要求
-                                        if (etcParser.size() < etcSize)
+                                        //剩余子句一样多时选统计上每个key行数少的
+                                        if (etcParser.size() < etcSize || (etcParser.size() == etcSize && EstimateKeyRows(indexinfo) < EstimateKeyRows(indexinfoFinal)))
                                         {
                                             etcSize = etcParser.size();
                                             indexFinal = indexParser;
@@ -1585,27 +2203,14 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext* context) {
 
                                 Row keyRow(keyFields); //索引key
 
-                                GenericKey<32> gKey;
-                                gKey.SerializeFromKey(keyRow, indexinfoFinal->GetIndexKeySchema());
 
-                                BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>>* bpindex = dynamic_cast<BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>>*>(indexinfoFinal->GetIndex());
-                                if (!bpindex->IsEmpty())
+                                Index* goalIndex = indexinfoFinal->GetIndex();
+                                if (!goalIndex->IsEmpty())
                                 {
                                     std::vector<RowId> ids;
-                                    if (bpindex->ScanKey(keyRow, ids, nullptr) != DB_KEY_NOT_FOUND)
+                                    if (goalIndex->ScanKey(keyRow, ids, nullptr) != DB_KEY_NOT_FOUND)
                                     {
-                                        IndexIterator<GenericKey<32>, RowId, GenericComparator<32>> goalIter = bpindex->GetBeginIterator(gKey);
-                                        Row goalRow((*goalIter).second);
-                                        if (tableInfo->GetTableHeap()->GetTuple(&goalRow, nullptr))
-                                        {
-
-                                        }
-                                        else {
-                                            std::cout << "minisql: Row Failed.\n";
-                                            return DB_FAILED;
-                                        }
-                                        std::vector<Field*> goalFields = goalRow.GetFields();
-                                        IndexIterator<GenericKey<32>, RowId, GenericComparator<32>> endIter = goalIter;
+                                        std::vector<RowId> rangeIds;
                                         //模式选择
                                         int cmpState = -2; //-1 直接用tableiter 0完全等于 1大于iter范围 2小于iter范围
                                         for (auto& iter : indexFinal)
@@ -1650,10 +2255,16 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext* context) {
                                                 }
                                             }
                                         }
-                                        switch (cmpState)
+                                        //哈希索引只能等值查找，范围条件走表遍历
+                                        if (cmpState > 0 && indexinfoFinal->GetIndexType() == "hash")
                                         {
-                                        case 0:
-                                            if (RecordJudge(goalRow, etcFinal, idxMap))
+                                            cmpState = -1;
+                                        }
+                                        //覆盖索引不回表
+                                        std::vector<Row> coveredRows;
+                                        if (CoveringScan(indexinfoFinal, cmpState, keyRow, columns, isPrint, indexFinal, etcFinal, idxMap, coveredRows))
+                                        {
+                                            for (auto& coveredRow : coveredRows)
                                             {
                                                 selNum++;
                                                 bool flag = false;
@@ -1661,21 +2272,11 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext* context) {
                                                 {
                                                     if (isPrint[index])
                                                     {
-                                                        Field* field = goalFields[index];
-                                                        if (field->IsNull())
+                                                        Field* field = coveredRow.GetField(index);
+                                                        string data = "NULL";
+                                                        if (!field->IsNull())
                                                         {
-                                                            if (flag == false)
-                                                            {
-                                                                std::cout << std::setw(8) << "NULL";
-                                                                flag = true;
-                                                            }
-                                                            else {
-                                                                std::cout << "\t" << std::setw(8) << "NULL";
-                                                            }
-                                                        }
-                                                        else {
-                                                            string data;
-                                                            char* s = new char[40];
+                                                            char s[40];
                                                             switch (field->GetType())
                                                             {
                                                             case kTypeInt:
@@ -1684,7 +2285,6 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext* context) {
                                                             case kTypeFloat:
                                                                 sprintf(s, "%.2f", field->GetFloat());
                                                                 data = s;
-                                                                delete[] s;
                                                                 break;
                                                             case kTypeChar:
                                                                 data = field->GetChars();
@@ -1692,19 +2292,94 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext* context) {
                                                             default:
                                                                 break;
                                                             }
-
-                                                            if (flag == false)
+                                                        }
+                                                        if (flag == false)
+                                                        {
+                                                            std::cout << std::setw(8) << data;
+                                                            flag = true;
+                                                        }
+                                                        else {
+                                                            std::cout << "\t" << std::setw(8) << data;
+                                                        }
+                                                    }
+                                                }
+                                                std::cout << std::endl;
+                                            }
+                                            if (selNum == 0)
+                                            {
+                                                std::cout << "Empty set.\n";
+                                            }
+                                            else {
+                                                std::cout << "minisql: " << "The number of selected rows: " << selNum << ".\n";
+                                            }
+                                            return DB_SUCCESS;
+                                        }
+                                        switch (cmpState)
+                                        {
+                                        case 0:
+                                            //非唯一索引同一个key可能对应多行
+                                            for (auto& id : ids)
+                                            {
+                                                Row goalRow(id);
+                                                if (!tableInfo->GetTableHeap()->GetTuple(&goalRow, nullptr))
+                                                {
+                                                    std::cout << "minisql: Row Failed.\n";
+                                                    return DB_FAILED;
+                                                }
+                                                std::vector<Field*> goalFields = goalRow.GetFields();
+                                                if (RecordJudge(goalRow, etcFinal, idxMap))
+                                                {
+                                                    selNum++;
+                                                    bool flag = false;
+                                                    for (uint32_t index = 0; index < columns.size(); index++)
+                                                    {
+                                                        if (isPrint[index])
+                                                        {
+                                                            Field* field = goalFields[index];
+                                                            if (field->IsNull())
                                                             {
-                                                                std::cout << std::setw(8) << data;
-                                                                flag = true;
+                                                                if (flag == false)
+                                                                {
+                                                                    std::cout << std::setw(8) << "NULL";
+                                                                    flag = true;
+                                                                }
+                                                                else {
+                                                                    std::cout << "\t" << std::setw(8) << "NULL";
+                                                                }
                                                             }
                                                             else {
-                                                                std::cout << "\t" << std::setw(8) << data;
+                                                                string data;
+                                                                char* s = new char[40];
+                                                                switch (field->GetType())
+                                                                {
+                                                                case kTypeInt:
+                                                                    data = std::to_string(field->GetInteger());
+                                                                    break;
+                                                                case kTypeFloat:
+                                                                    sprintf(s, "%.2f", field->GetFloat());
+                                                                    data = s;
+                                                                    delete[] s;
+                                                                    break;
+                                                                case kTypeChar:
+                                                                    data = field->GetChars();
+                                                                    break;
+                                                                default:
+                                                                    break;
+                                                                }
+
+                                                                if (flag == false)
+                                                                {
+                                                                    std::cout << std::setw(8) << data;
+                                                                    flag = true;
+                                                                }
+                                                                else {
+                                                                    std::cout << "\t" << std::setw(8) << data;
+                                                                }
                                                             }
                                                         }
                                                     }
+                                                    std::cout << std::endl;
                                                 }
-                                                std::cout << std::endl;
                                             }
                                             if (selNum == 0)
                                             {
@@ -1717,9 +2392,10 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext* context) {
                                             break;
                                         case 1:
                                             //大于范围
-                                            for (auto idxIter = goalIter; idxIter != bpindex->GetEndIterator(); ++idxIter)
+                                            goalIndex->ScanRange(&keyRow, nullptr, rangeIds, nullptr);
+                                            for (auto& rangeId : rangeIds)
                                             {
-                                                Row thisRow((*idxIter).second);
+                                                Row thisRow(rangeId);
                                                 if (tableInfo->GetTableHeap()->GetTuple(&thisRow, nullptr))
                                                 {
 
@@ -1794,10 +2470,10 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext* context) {
                                             break;
                                         case 2:
                                             //小于范围
-                                            ++endIter;
-                                            for (auto idxIter = bpindex->GetBeginIterator(); idxIter != endIter; ++idxIter)
+                                            goalIndex->ScanRange(nullptr, &keyRow, rangeIds, nullptr);
+                                            for (auto& rangeId : rangeIds)
                                             {
-                                                Row thisRow((*idxIter).second);
+                                                Row thisRow(rangeId);
                                                 if (tableInfo->GetTableHeap()->GetTuple(&thisRow, nullptr))
                                                 {
 
@@ -1881,22 +2557,18 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext* context) {
                 }
 
 
-                //没有索引，用table迭代器遍历
-                for (auto iter = tableInfo->GetTableHeap()->Begin(nullptr); iter != tableInfo->GetTableHeap()->End(); iter++)
+                //没有索引，并行扫描整表，扫描时已经按子句过滤
+                std::vector<Row> matched;
+                ScanTable(tableInfo, ast->child_->next_->next_ == nullptr ? nullptr : ast->child_->next_->next_->child_, matched, isPrint);
+                for (auto& row : matched)
                 {
                     //遍历每一行
-                    std::vector<Field*> fields = iter->GetFields();
-                    std::map<string, Field*> valMap; //用于寻找对应field的map
+                    std::vector<Field*> fields = row.GetFields();
 
                     //判断field和column大小是否相等
                     if (columns.size() == fields.size())
                     {
-                        for (uint32_t index = 0; index < columns.size(); index++)
-                        {
-                            valMap.insert(std::pair<string, Field*>(columns[index]->GetName(), fields[index]));
-                        }
-
-                        //有没有子句问题
+                        //有没有子句问题，决定输出格式
                         if (ast->child_->next_->next_ == nullptr) //没有子句
                         {
                             //没有子句，直接输出
@@ -1952,61 +2624,57 @@ dberr_t ExecuteEngine::ExecuteSelect(pSyntaxNode ast, ExecuteContext* context) {
                             std::cout << std::endl;
                         }
                         else {
-                            //子句判断
-                            if (ClauseAnalysis(valMap, typeMap, ast->child_->next_->next_->child_))
+                            selNum++;
+                            bool flag = false;
+                            //符合条件，可以输出
+                            for (uint32_t index = 0; index < columns.size(); index++)
                             {
-                                selNum++;
-                                bool flag = false;
-                                //符合条件，可以输出
-                                for (uint32_t index = 0; index < columns.size(); index++)
+                                if (isPrint[index])
                                 {
-                                    if (isPrint[index])
+                                    Field* field = fields[index];
+                                    if (field->IsNull())
                                     {
-                                        Field* field = fields[index];
-                                        if (field->IsNull())
+                                        if (flag == false)
                                         {
-                                            if (flag == false)
-                                            {
-                                                std::cout << "NULL";
-                                                flag = true;
-                                            }
-                                            else {
-                                                std::cout << "\t" << "NULL";
-                                            }
+                                            std::cout << "NULL";
+                                            flag = true;
                                         }
                                         else {
-                                            string data;
-                                            char* s = new char[40];
-                                            switch (field->GetType())
-                                            {
-                                            case kTypeInt:
-                                                data = std::to_string(field->GetInteger());
-                                                break;
-                                            case kTypeFloat:
-                                                sprintf(s, "%.2f", field->GetFloat());
-                                                data = s;
-                                                delete[] s;
-                                                break;
-                                            case kTypeChar:
-                                                data = field->GetChars();
-                                                break;
-                                            default:
-                                                break;
-                                            }
+                                            std::cout << "\t" << "NULL";
+                                        }
+                                    }
+                                    else {
+                                        string data;
+                                        char* s = new char[40];
+                                        switch (field->GetType())
+                                        {
+                                        case kTypeInt:
+                                            data = std::to_string(field->GetInteger());
+                                            break;
+                                        case kTypeFloat:
+                                            sprintf(s, "%.2f", field->GetFloat());
+                                            data = s;
+                                            delete[] s;
+                                            break;
+                                        case kTypeChar:
+                                            data = field->GetChars();
+                                            break;
+                                        default:
+                                            break;
+                                        }
 
-                                            if (flag == false)
-                                            {
-                                                std::cout << data;
-                                                flag = true;
-                                            }
-                                            else {
-                                                std::cout << "\t" << data;
-                                            }
+                                        if (flag == false)
+                                        {
+                                            std::cout << data;
+                                            flag = true;
+                                        }
+                                        else {
+                                            std::cout << "\t" << data;
                                         }
                                     }
                                 }
-                                std::cout << std::endl;
                             }
+                            std::cout << std::endl;
                         }
                     }
                     else {
@@ -2106,7 +2774,9 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext* context) {
                             len = curCol->GetLength();
                             if (str.size() <= len)
                             {
-                                Field field(type, columnPt->val_, len, true);
+                                //补0到列长，不能越过字符串末尾读取
+                                str.resize(len, '\0');
+                                Field field(type, const_cast<char*>(str.data()), len, true);
                                 fields.push_back(field);
                             }
                             else {
@@ -2151,7 +2821,7 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext* context) {
                         {
                             if (indexinfo->GetIndexName()[0] == ';')
                             {
-                                if (dynamic_cast<BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>>*>(indexinfo->GetIndex())->IsEmpty())
+                                if (indexinfo->GetIndex()->IsEmpty())
                                 {
                                     continue;
                                 }
@@ -2195,21 +2865,21 @@ dberr_t ExecuteEngine::ExecuteInsert(pSyntaxNode ast, ExecuteContext* context) {
                                     indexFields.push_back(*(i->second));
                                 }
                             }
+                            //覆盖索引：key后面接上INCLUDE的列
+                            if (indexinfo->GetIncludeSchema() != nullptr)
+                            {
+                                for (auto col : indexinfo->GetIncludeSchema()->GetColumns())
+                                {
+                                    indexFields.push_back(*(valMap[col->GetName()]));
+                                }
+                            }
                             Row indexRow(indexFields);
-                            uint32_t size = indexRow.GetSerializedSize(nullptr);
-                            if (size > 32)
+                            if (indexinfo->GetIndex()->InsertEntry(indexRow, row.GetRowId(), nullptr) == DB_SUCCESS)
                             {
-                                std::cout << "minisql: " << indexinfo->GetIndexName() << " has too long key, it has been deleted\n";
-                                curDB->catalog_mgr_->DropIndex(tableName, indexinfo->GetIndexName());
                             }
                             else {
-                                if (indexinfo->GetIndex()->InsertEntry(indexRow, row.GetRowId(), nullptr) == DB_SUCCESS)
-                                {
-                                }
-                                else {
-                                    std::cout << "minisql[ERROR]: Index " << indexinfo->GetIndexName() << " failed.\n";
-                                    return DB_FAILED;
-                                }
+                                std::cout << "minisql[ERROR]: Index " << indexinfo->GetIndexName() << " failed.\n";
+                                return DB_FAILED;
                             }
                         }
                         std::cout << "minisql: Insert successfully.\n";
@@ -2268,6 +2938,16 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext* context) {
                     idxMap.insert(std::pair<string, uint32_t>(columns[index]->GetName(), index));
                 }
 
+                //删除行的索引key，最后批量从每个索引移除
+                std::vector<IndexInfo*> delIndexes;
+                if (curDB->catalog_mgr_->GetTableIndexes(tableName, delIndexes) != DB_SUCCESS)
+                {
+                    std::cout << "minisql[ERROR]: Failed.\n";
+                    return DB_FAILED;
+                }
+                std::vector<std::vector<Row>> delKeys(delIndexes.size());
+                std::vector<std::vector<RowId>> delIds(delIndexes.size());
+
                 //索引查找需要删除的
                 if (ast->child_->next_ != nullptr) //索引部分，有子句
                 {
@@ -2304,7 +2984,8 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext* context) {
                                     if (colNameSet.size() == indexParser.size())
                                     {
                                         //符合index查询要求
-                                        if (etcParser.size() < etcSize)
+                                        //剩余子句一样多时选统计上每个key行数少的
+                                        if (etcParser.size() < etcSize || (etcParser.size() == etcSize && EstimateKeyRows(indexinfo) < EstimateKeyRows(indexinfoFinal)))
                                         {
                                             etcSize = etcParser.size();
                                             indexFinal = indexParser;
@@ -2335,27 +3016,14 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext* context) {
 
                                 Row keyRow(keyFields); //索引key
 
-                                GenericKey<32> gKey;
-                                gKey.SerializeFromKey(keyRow, indexinfoFinal->GetIndexKeySchema());
 
-                                BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>>* bpindex = dynamic_cast<BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>>*>(indexinfoFinal->GetIndex());
-                                if (!bpindex->IsEmpty())
+                                Index* goalIndex = indexinfoFinal->GetIndex();
+                                if (!goalIndex->IsEmpty())
                                 {
                                     std::vector<RowId> ids;
-                                    if (bpindex->ScanKey(keyRow, ids, nullptr) != DB_KEY_NOT_FOUND)
+                                    if (goalIndex->ScanKey(keyRow, ids, nullptr) != DB_KEY_NOT_FOUND)
                                     {
-                                        IndexIterator<GenericKey<32>, RowId, GenericComparator<32>> goalIter = bpindex->GetBeginIterator(gKey);
-                                        Row goalRow((*goalIter).second);
-                                        if (tableInfo->GetTableHeap()->GetTuple(&goalRow, nullptr))
-                                        {
-
-                                        }
-                                        else {
-                                            std::cout << "minisql: Row Failed.\n";
-                                            return DB_FAILED;
-                                        }
-                                        std::vector<Field*> goalFields = goalRow.GetFields();
-                                        IndexIterator<GenericKey<32>, RowId, GenericComparator<32>> endIter = goalIter;
+                                        std::vector<RowId> rangeIds;
                                         //模式选择
                                         int cmpState = -2; //-1 直接用tableiter 0完全等于 1大于iter范围 2小于iter范围
                                         for (auto& iter : indexFinal)
@@ -2400,57 +3068,55 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext* context) {
                                                 }
                                             }
                                         }
+                                        //哈希索引只能等值查找，范围条件走表遍历
+                                        if (cmpState > 0 && indexinfoFinal->GetIndexType() == "hash")
+                                        {
+                                            cmpState = -1;
+                                        }
                                         switch (cmpState)
                                         {
                                         case 0:
-                                            if (RecordJudge(goalRow, etcFinal, idxMap))
+                                            //非唯一索引同一个key可能对应多行
+                                            for (auto& id : ids)
                                             {
-                                                //符合条件，可以删
-                                                if (tableInfo->GetTableHeap()->MarkDelete(goalRow.GetRowId(), nullptr))
+                                                Row goalRow(id);
+                                                if (!tableInfo->GetTableHeap()->GetTuple(&goalRow, nullptr))
                                                 {
-                                                    delNum++;
-
-                                                    //移除index
-                                                    std::vector<IndexInfo*> indexes;
-                                                    if (curDB->catalog_mgr_->GetTableIndexes(tableName, indexes) == DB_SUCCESS)
+                                                    std::cout << "minisql: Row Failed.\n";
+                                                    return DB_FAILED;
+                                                }
+                                                std::vector<Field*> goalFields = goalRow.GetFields();
+                                                if (RecordJudge(goalRow, etcFinal, idxMap))
+                                                {
+                                                    //符合条件，可以删
+                                                    if (tableInfo->GetTableHeap()->MarkDelete(goalRow.GetRowId(), nullptr))
                                                     {
-                                                        for (auto indexinfo : indexes)
-                                                        {
-                                                            std::vector<Column*> cols = indexinfo->GetIndexKeySchema()->GetColumns();
-                                                            std::vector<Field> indexFields;
-                                                            for (auto col : cols) //每个索引列
-                                                            {
-                                                                indexFields.push_back(*(goalFields[col->GetTableInd()]));
-                                                            }
-                                                            Row indexRow(indexFields);
-                                                            if (indexinfo->GetIndex()->RemoveEntry(indexRow, goalRow.GetRowId(), nullptr) == DB_SUCCESS)
-                                                            {
-                                                            }
-                                                            else {
-                                                                std::cout << "minisql[ERROR]: Failed.\n";
-                                                                return DB_FAILED;
-                                                            }
-                                                        }
+                                                        delNum++;
+
+                                                        //索引key留到最后批量移除
+                                                        CollectIndexKeys(delIndexes, goalFields, goalRow.GetRowId(), delKeys, delIds);
                                                         tableInfo->GetTableHeap()->ApplyDelete(goalRow.GetRowId(), nullptr);
                                                     }
                                                     else {
-                                                        std::cout << "minisql[ERROR]: Failed.\n";
+                                                        std::cout << "minisql[ERROR]: Insert failed.\n";
                                                         return DB_FAILED;
                                                     }
                                                 }
-                                                else {
-                                                    std::cout << "minisql[ERROR]: Insert failed.\n";
-                                                    return DB_FAILED;
-                                                }
+                                            }
+                                            if (!RemoveIndexKeys(delIndexes, delKeys, delIds))
+                                            {
+                                                std::cout << "minisql[ERROR]: Failed.\n";
+                                                return DB_FAILED;
                                             }
                                             std::cout << "minisql: " << "The number of deleted records: " << delNum << ".\n";
                                             return DB_SUCCESS;
                                             break;
                                         case 1:
                                             //大于范围
-                                            for (auto idxIter = goalIter; idxIter != bpindex->GetEndIterator(); ++idxIter)
+                                            goalIndex->ScanRange(&keyRow, nullptr, rangeIds, nullptr);
+                                            for (auto& rangeId : rangeIds)
                                             {
-                                                Row thisRow((*idxIter).second);
+                                                Row thisRow(rangeId);
                                                 if (tableInfo->GetTableHeap()->GetTuple(&thisRow, nullptr))
                                                 {
 
@@ -2467,33 +3133,9 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext* context) {
                                                     {
                                                         delNum++;
 
-                                                        //移除index
-                                                        std::vector<IndexInfo*> indexes;
-                                                        if (curDB->catalog_mgr_->GetTableIndexes(tableName, indexes) == DB_SUCCESS)
-                                                        {
-                                                            for (auto indexinfo : indexes)
-                                                            {
-                                                                std::vector<Column*> cols = indexinfo->GetIndexKeySchema()->GetColumns();
-                                                                std::vector<Field> indexFields;
-                                                                for (auto col : cols) //每个索引列
-                                                                {
-                                                                    indexFields.push_back(*(fields[col->GetTableInd()]));
-                                                                }
-                                                                Row indexRow(indexFields);
-                                                                if (indexinfo->GetIndex()->RemoveEntry(indexRow, thisRow.GetRowId(), nullptr) == DB_SUCCESS)
-                                                                {
-                                                                }
-                                                                else {
-                                                                    std::cout << "minisql[ERROR]: Failed.\n";
-                                                                    return DB_FAILED;
-                                                                }
-                                                            }
-                                                            tableInfo->GetTableHeap()->ApplyDelete(thisRow.GetRowId(), nullptr);
-                                                        }
-                                                        else {
-                                                            std::cout << "minisql[ERROR]: Failed.\n";
-                                                            return DB_FAILED;
-                                                        }
+                                                        //索引key留到最后批量移除
+                                                        CollectIndexKeys(delIndexes, fields, thisRow.GetRowId(), delKeys, delIds);
+                                                        tableInfo->GetTableHeap()->ApplyDelete(thisRow.GetRowId(), nullptr);
                                                     }
                                                     else {
                                                         std::cout << "minisql[ERROR]: Insert failed.\n";
@@ -2501,15 +3143,20 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext* context) {
                                                     }
                                                 }
                                             }
+                                            if (!RemoveIndexKeys(delIndexes, delKeys, delIds))
+                                            {
+                                                std::cout << "minisql[ERROR]: Failed.\n";
+                                                return DB_FAILED;
+                                            }
                                             std::cout << "minisql: " << "The number of deleted records: " << delNum << ".\n";
                                             return DB_SUCCESS;
                                             break;
                                         case 2:
                                             //小于范围
-                                            ++endIter;
-                                            for (auto idxIter = bpindex->GetBeginIterator(); idxIter != endIter; ++idxIter)
+                                            goalIndex->ScanRange(nullptr, &keyRow, rangeIds, nullptr);
+                                            for (auto& rangeId : rangeIds)
                                             {
-                                                Row thisRow((*idxIter).second);
+                                                Row thisRow(rangeId);
                                                 if (tableInfo->GetTableHeap()->GetTuple(&thisRow, nullptr))
                                                 {
 
@@ -2526,33 +3173,9 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext* context) {
                                                     {
                                                         delNum++;
 
-                                                        //移除index
-                                                        std::vector<IndexInfo*> indexes;
-                                                        if (curDB->catalog_mgr_->GetTableIndexes(tableName, indexes) == DB_SUCCESS)
-                                                        {
-                                                            for (auto indexinfo : indexes)
-                                                            {
-                                                                std::vector<Column*> cols = indexinfo->GetIndexKeySchema()->GetColumns();
-                                                                std::vector<Field> indexFields;
-                                                                for (auto col : cols) //每个索引列
-                                                                {
-                                                                    indexFields.push_back(*(fields[col->GetTableInd()]));
-                                                                }
-                                                                Row indexRow(indexFields);
-                                                                if (indexinfo->GetIndex()->RemoveEntry(indexRow, thisRow.GetRowId(), nullptr) == DB_SUCCESS)
-                                                                {
-                                                                }
-                                                                else {
-                                                                    std::cout << "minisql[ERROR]: Failed.\n";
-                                                                    return DB_FAILED;
-                                                                }
-                                                            }
-                                                            tableInfo->GetTableHeap()->ApplyDelete(thisRow.GetRowId(), nullptr);
-                                                        }
-                                                        else {
-                                                            std::cout << "minisql[ERROR]: Failed.\n";
-                                                            return DB_FAILED;
-                                                        }
+                                                        //索引key留到最后批量移除
+                                                        CollectIndexKeys(delIndexes, fields, thisRow.GetRowId(), delKeys, delIds);
+                                                        tableInfo->GetTableHeap()->ApplyDelete(thisRow.GetRowId(), nullptr);
                                                     }
                                                     else {
                                                         std::cout << "minisql[ERROR]: Insert failed.\n";
@@ -2560,6 +3183,11 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext* context) {
                                                     }
                                                 }
                                             }
+                                            if (!RemoveIndexKeys(delIndexes, delKeys, delIds))
+                                            {
+                                                std::cout << "minisql[ERROR]: Failed.\n";
+                                                return DB_FAILED;
+                                            }
                                             std::cout << "minisql: " << "The number of deleted records: " << delNum << ".\n";
                                             return DB_SUCCESS;
                                             break;
@@ -2575,114 +3203,30 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext* context) {
 
 
 
-                //没有索引，用table迭代器遍历
-                for (auto iter = tableInfo->GetTableHeap()->Begin(nullptr); iter != tableInfo->GetTableHeap()->End(); iter++)
+                //没有索引，并行扫描整表，扫描时已经按子句过滤
+                std::vector<Row> matched;
+                ScanTable(tableInfo, ast->child_->next_ == nullptr ? nullptr : ast->child_->next_->child_, matched);
+                for (auto& row : matched)
                 {
                     //遍历每一行
-                    std::vector<Field*> fields = iter->GetFields();
-                    RowId rowID = iter->GetRowId();
-                    std::map<string, Field*> valMap; //用于寻找对应field的map
-                    std::map<string, TypeId> typeMap; //用于寻找对应type的id
-                    
+                    std::vector<Field*> fields = row.GetFields();
+                    RowId rowID = row.GetRowId();
+
                     //判断field和column大小是否相等
                     if (columns.size() == fields.size())
                     {
-                        for (uint32_t index = 0; index < columns.size(); index++)
-                        {
-                            valMap.insert(std::pair<string, Field*>(columns[index]->GetName(), fields[index]));
-                            typeMap.insert(std::pair<string, TypeId>(columns[index]->GetName(), columns[index]->GetType()));
-                        }
-
-                        //有没有子句问题
-                        if (ast->child_->next_ == nullptr) //没有子句
+                        //符合条件，可以删
+                        if (tableInfo->GetTableHeap()->MarkDelete(rowID, nullptr))
                         {
-                            if (tableInfo->GetTableHeap()->MarkDelete(rowID, nullptr))
-                            {
-                                delNum++;
+                            delNum++;
 
-                                //移除index
-                                std::vector<IndexInfo*> indexes;
-                                if (curDB->catalog_mgr_->GetTableIndexes(tableName, indexes) == DB_SUCCESS)
-                                {
-                                    for (auto indexinfo : indexes)
-                                    {
-                                        std::vector<Column*> cols = indexinfo->GetIndexKeySchema()->GetColumns();
-                                        std::vector<Field> indexFields;
-                                        for (auto col : cols)
-                                        {
-                                            auto i = valMap.find(col->GetName());
-                                            if (i != valMap.end())
-                                            {
-                                                indexFields.push_back(*(i->second));
-                                            }
-                                        }
-                                        Row indexRow(indexFields);
-                                        if (indexinfo->GetIndex()->RemoveEntry(indexRow, rowID, nullptr) == DB_SUCCESS)
-                                        {
-                                        }
-                                        else {
-                                            std::cout << "minisql[ERROR]: Failed.\n";
-                                            return DB_FAILED;
-                                        }
-                                    }
-                                    tableInfo->GetTableHeap()->ApplyDelete(rowID, nullptr);
-                                }
-                                else {
-                                    std::cout << "minisql[ERROR]: Failed.\n";
-                                    return DB_FAILED;
-                                }
-                            }
-                            else {
-                                std::cout << "minisql[ERROR]: Insert failed.\n";
-                                return DB_FAILED;
-                            }
+                            //索引key留到最后批量移除
+                            CollectIndexKeys(delIndexes, fields, rowID, delKeys, delIds);
+                            tableInfo->GetTableHeap()->ApplyDelete(rowID, nullptr);
                         }
                         else {
-                            //子句判断
-                            if (ClauseAnalysis(valMap, typeMap, ast->child_->next_->child_))
-                            {
-                                //符合条件，可以删
-                                if (tableInfo->GetTableHeap()->MarkDelete(rowID, nullptr))
-                                {
-                                    delNum++;
-
-                                    //移除index
-                                    std::vector<IndexInfo*> indexes;
-                                    if (curDB->catalog_mgr_->GetTableIndexes(tableName, indexes) == DB_SUCCESS)
-                                    {
-                                        for (auto indexinfo : indexes)
-                                        {
-                                            std::vector<Column*> cols = indexinfo->GetIndexKeySchema()->GetColumns();
-                                            std::vector<Field> indexFields;
-                                            for (auto col : cols)
-                                            {
-                                                auto i = valMap.find(col->GetName());
-                                                if (i != valMap.end())
-                                                {
-                                                    indexFields.push_back(*(i->second));
-                                                }
-                                            }
-                                            Row indexRow(indexFields);
-                                            if (indexinfo->GetIndex()->RemoveEntry(indexRow, rowID, nullptr) == DB_SUCCESS)
-                                            {
-                                            }
-                                            else {
-                                                std::cout << "minisql[ERROR]: Failed.\n";
-                                                return DB_FAILED;
-                                            }
-                                        }
-                                        tableInfo->GetTableHeap()->ApplyDelete(rowID, nullptr);
-                                    }
-                                    else {
-                                        std::cout << "minisql[ERROR]: Failed.\n";
-                                        return DB_FAILED;
-                                    }
-                                }
-                                else {
-                                    std::cout << "minisql[ERROR]: Insert failed.\n";
-                                    return DB_FAILED;
-                                }
-                            }
+                            std::cout << "minisql[ERROR]: Insert failed.\n";
+                            return DB_FAILED;
                         }
                     }
                     else {
@@ -2691,6 +3235,11 @@ dberr_t ExecuteEngine::ExecuteDelete(pSyntaxNode ast, ExecuteContext* context) {
                     }
                 }
                 
+                if (!RemoveIndexKeys(delIndexes, delKeys, delIds))
+                {
+                    std::cout << "minisql[ERROR]: Failed.\n";
+                    return DB_FAILED;
+                }
                 std::cout << "minisql: " << "The number of deleted records: " << delNum << ".\n";
                 return DB_SUCCESS;
             }
@@ -2804,6 +3353,13 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext* context) {
                 }
 
 
+                std::vector<IndexInfo*> tableIndexes; //更新时要维护的索引
+                if (curDB->catalog_mgr_->GetTableIndexes(tableName, tableIndexes) != DB_SUCCESS)
+                {
+                    std::cout << "minisql: Failed.\n";
+                    return DB_FAILED;
+                }
+
                 //索引查询需要更新的
                 if (ast->child_->next_ != nullptr) //索引部分，有子句
                 {
@@ -2840,7 +3396,8 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext* context) {
                                     if (colNameSet.size() == indexParser.size())
                                     {
                                         //符合index查询要求
-                                        if (etcParser.size() < etcSize)
+                                        //剩余子句一样多时选统计上每个key行数少的
+                                        if (etcParser.size() < etcSize || (etcParser.size() == etcSize && EstimateKeyRows(indexinfo) < EstimateKeyRows(indexinfoFinal)))
                                         {
                                             etcSize = etcParser.size();
                                             indexFinal = indexParser;
@@ -2871,27 +3428,14 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext* context) {
 
                                 Row keyRow(keyFields); //索引key
 
-                                GenericKey<32> gKey;
-                                gKey.SerializeFromKey(keyRow, indexinfoFinal->GetIndexKeySchema());
 
-                                BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>>* bpindex = dynamic_cast<BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>>*>(indexinfoFinal->GetIndex());
-                                if (!bpindex->IsEmpty())
+                                Index* goalIndex = indexinfoFinal->GetIndex();
+                                if (!goalIndex->IsEmpty())
                                 {
                                     std::vector<RowId> ids;
-                                    if (bpindex->ScanKey(keyRow, ids, nullptr) != DB_KEY_NOT_FOUND)
+                                    if (goalIndex->ScanKey(keyRow, ids, nullptr) != DB_KEY_NOT_FOUND)
                                     {
-                                        IndexIterator<GenericKey<32>, RowId, GenericComparator<32>> goalIter = bpindex->GetBeginIterator(gKey);
-                                        Row goalRow((*goalIter).second);
-                                        if (tableInfo->GetTableHeap()->GetTuple(&goalRow, nullptr))
-                                        {
-
-                                        }
-                                        else {
-                                            std::cout << "minisql: Row Failed.\n";
-                                            return DB_FAILED;
-                                        }
-                                        std::vector<Field*> goalFields = goalRow.GetFields();
-                                        IndexIterator<GenericKey<32>, RowId, GenericComparator<32>> endIter = goalIter;
+                                        std::vector<RowId> rangeIds;
                                         //模式选择
                                         int cmpState = -2; //-1 直接用tableiter 0完全等于 1大于iter范围 2小于iter范围
                                         for (auto& iter : indexFinal)
@@ -2936,31 +3480,35 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext* context) {
                                                 }
                                             }
                                         }
+                                        //哈希索引只能等值查找，范围条件走表遍历
+                                        if (cmpState > 0 && indexinfoFinal->GetIndexType() == "hash")
+                                        {
+                                            cmpState = -1;
+                                        }
                                         switch (cmpState)
                                         {
                                         case 0:
-                                            if (RecordJudge(goalRow, etcFinal, indexMap))
+                                            //非唯一索引同一个key可能对应多行
+                                            for (auto& id : ids)
                                             {
-                                                //符合条件，可以更新
-                                                std::vector<Field> loadField; //最后加载到row的field
-                                                std::vector<Field*> fields = goalRow.GetFields();
-                                                for (size_t i = 0; i < fields.size(); i++)
+                                                Row goalRow(id);
+                                                if (!tableInfo->GetTableHeap()->GetTuple(&goalRow, nullptr))
                                                 {
-                                                    if (updateFields[i] != nullptr)
-                                                    {
-                                                        fields[i] = updateFields[i];
-                                                    }
-
-                                                    loadField.push_back(*fields[i]);
+                                                    std::cout << "minisql: Row Failed.\n";
+                                                    return DB_FAILED;
                                                 }
-                                                Row loadRow(loadField);
-                                                if (tableInfo->GetTableHeap()->UpdateTuple(loadRow, goalRow.GetRowId(), nullptr))
+                                                std::vector<Field*> goalFields = goalRow.GetFields();
+                                                if (RecordJudge(goalRow, etcFinal, indexMap))
                                                 {
-                                                    updateNum++;
-                                                }
-                                                else {
-                                                    std::cout << "minisql[ERROR]: Insert failed.\n";
-                                                    return DB_FAILED;
+                                                    //符合条件，可以更新
+                                                    if (UpdateRow(tableInfo, tableIndexes, goalRow, updateFields))
+                                                    {
+                                                        updateNum++;
+                                                    }
+                                                    else {
+                                                        std::cout << "minisql[ERROR]: Insert failed.\n";
+                                                        return DB_FAILED;
+                                                    }
                                                 }
                                             }
                                             std::cout << "minisql: " << "The number of updated rows: " << updateNum << ".\n";
@@ -2968,9 +3516,10 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext* context) {
                                             break;
                                         case 1:
                                             //大于范围
-                                            for (auto idxIter = goalIter; idxIter != bpindex->GetEndIterator(); ++idxIter)
+                                            goalIndex->ScanRange(&keyRow, nullptr, rangeIds, nullptr);
+                                            for (auto& rangeId : rangeIds)
                                             {
-                                                Row thisRow((*idxIter).second);
+                                                Row thisRow(rangeId);
                                                 if (tableInfo->GetTableHeap()->GetTuple(&thisRow, nullptr))
                                                 {
 
@@ -2982,19 +3531,7 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext* context) {
                                                 if (RecordJudge(thisRow, etcFinal, indexMap) && RecordJudge(thisRow, indexFinal, indexMap))
                                                 {
                                                     //符合条件，可以更新
-                                                    std::vector<Field> loadField; //最后加载到row的field
-                                                    std::vector<Field*> fields = thisRow.GetFields();
-                                                    for (size_t i = 0; i < fields.size(); i++)
-                                                    {
-                                                        if (updateFields[i] != nullptr)
-                                                        {
-                                                            fields[i] = updateFields[i];
-                                                        }
-
-                                                        loadField.push_back(*fields[i]);
-                                                    }
-                                                    Row loadRow(loadField);
-                                                    if (tableInfo->GetTableHeap()->UpdateTuple(loadRow, thisRow.GetRowId(), nullptr))
+                                                    if (UpdateRow(tableInfo, tableIndexes, thisRow, updateFields))
                                                     {
                                                         updateNum++;
                                                     }
@@ -3009,10 +3546,10 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext* context) {
                                             break;
                                         case 2:
                                             //小于范围
-                                            ++endIter;
-                                            for (auto idxIter = bpindex->GetBeginIterator(); idxIter != endIter; ++idxIter)
+                                            goalIndex->ScanRange(nullptr, &keyRow, rangeIds, nullptr);
+                                            for (auto& rangeId : rangeIds)
                                             {
-                                                Row thisRow((*idxIter).second);
+                                                Row thisRow(rangeId);
                                                 if (tableInfo->GetTableHeap()->GetTuple(&thisRow, nullptr))
                                                 {
 
@@ -3024,19 +3561,7 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext* context) {
                                                 if (RecordJudge(thisRow, etcFinal, indexMap) && RecordJudge(thisRow, indexFinal, indexMap))
                                                 {
                                                     //符合条件，可以更新
-                                                    std::vector<Field> loadField; //最后加载到row的field
-                                                    std::vector<Field*> fields = thisRow.GetFields();
-                                                    for (size_t i = 0; i < fields.size(); i++)
-                                                    {
-                                                        if (updateFields[i] != nullptr)
-                                                        {
-                                                            fields[i] = updateFields[i];
-                                                        }
-
-                                                        loadField.push_back(*fields[i]);
-                                                    }
-                                                    Row loadRow(loadField);
-                                                    if (tableInfo->GetTableHeap()->UpdateTuple(loadRow, thisRow.GetRowId(), nullptr))
+                                                    if (UpdateRow(tableInfo, tableIndexes, thisRow, updateFields))
                                                     {
                                                         updateNum++;
                                                     }
@@ -3062,63 +3587,15 @@ dberr_t ExecuteEngine::ExecuteUpdate(pSyntaxNode ast, ExecuteContext* context) {
 
 
 
-                //没有索引
-                for (auto iter = tableInfo->GetTableHeap()->Begin(nullptr); iter != tableInfo->GetTableHeap()->End(); iter++)
+                //没有索引，并行扫描整表，扫描时已经按子句过滤
+                std::vector<Row> matched;
+                ScanTable(tableInfo, ast->child_->next_->next_ == nullptr ? nullptr : ast->child_->next_->next_->child_, matched);
+                for (auto& matchedRow : matched)
                 {
                     //遍历每一行
-                    std::vector<Field*> fields = iter->GetFields();
-                    RowId rowID = iter->GetRowId();
-                    std::map<string, Field*> valMap; //用于寻找对应field的map
-                    std::vector<Field> loadField; //最后加载到row的field
-
-                    //判断field和column大小是否相等
-                    if (columns.size() == fields.size())
+                    if (UpdateRow(tableInfo, tableIndexes, matchedRow, updateFields))
                     {
-                        for (uint32_t index = 0; index < columns.size(); index++)
-                        {
-                            valMap.insert(std::pair<string, Field*>(columns[index]->GetName(), fields[index]));
-                        }
-
-                        //有没有子句问题
-                        if (ast->child_->next_->next_ == nullptr) //没有子句
-                        {
-                            //没有子句 直接更新
-                            for (size_t i = 0; i < fields.size(); i++)
-                            {
-                                if (updateFields[i] != nullptr)
-                                {
-                                    fields[i] = updateFields[i];
-                                }
-
-                                loadField.push_back(*fields[i]);
-                            }
-                        }
-                        else {
-                            //子句判断
-                            if (ClauseAnalysis(valMap, typeMap, ast->child_->next_->next_->child_))
-                            {
-                                //符合条件，可以更新
-                                for (size_t i = 0; i < fields.size(); i++)
-                                {
-                                    if (updateFields[i] != nullptr)
-                                    {
-                                        fields[i] = updateFields[i];
-                                    }
-
-                                    loadField.push_back(*fields[i]);
-                                }
-                            }
-                        }
-
-                        Row row(loadField);
-                        if (tableInfo->GetTableHeap()->UpdateTuple(row, rowID, nullptr))
-                        {
-                            updateNum++;
-                        }
-                        else {
-                            std::cout << "minisql: Failed.\n";
-                            return DB_FAILED;
-                        }
+                        updateNum++;
                     }
                     else {
                         std::cout << "minisql: Failed.\n";
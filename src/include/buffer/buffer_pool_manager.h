@@ -28,6 +28,9 @@ public:
 
   bool DeletePage(page_id_t page_id);
 
+  // DeletePage for several pages, freed on disk in one batch. false if some page is pinned and kept
+  bool DeletePages(const std::vector<page_id_t> &page_ids);
+
   bool IsPageFree(page_id_t page_id);
 
   bool CheckAllUnpinned();
@@ -71,7 +71,11 @@ public:
 
   ~CatalogManager();
 
-  dberr_t CreateTable(const std::string &table_name, TableSchema *schema, Transaction *txn, TableInfo *&table_info);
+  /**
+   * A columnar table fails with DB_FAILED when a single row of the schema does not fit a page.
+   */
+  dberr_t CreateTable(const std::string &table_name, TableSchema *schema, Transaction *txn, TableInfo *&table_info,
+                      TableLayout layout = kLayoutRow);
 
   dberr_t GetTable(const std::string &table_name, TableInfo *&table_info);
 
@@ -79,7 +83,9 @@ public:
 
   dberr_t CreateIndex(const std::string &table_name, const std::string &index_name,
                       const std::vector<std::string> &index_keys, Transaction *txn,
-                      IndexInfo *&index_info);
+                      IndexInfo *&index_info, bool unique = true,
+                      const std::vector<std::string> &include_keys = {},
+                      const std::string &index_type = "bptree");
 
   dberr_t GetIndex(const std::string &table_name, const std::string &index_name, IndexInfo *&index_info) const;
 
@@ -89,13 +95,28 @@ public:
 
   dberr_t DropIndex(const std::string &table_name, const std::string &index_name);
 
+  // rebuild the statistics of every index on the table and write them to the index meta pages
+  dberr_t AnalyzeTable(const std::string &table_name, Transaction *txn);
+
+  // compact the heap of the table and point its indexes at the rows that moved, freed_pages gets the pages released
+  dberr_t VacuumTable(const std::string &table_name, Transaction *txn, uint32_t *freed_pages = nullptr);
+
+  // fill new indexes of one table from a single scan of its heap, the indexes are bulk loaded in parallel
+  dberr_t BuildIndexes(TableInfo *table_info, const std::vector<IndexInfo *> &indexes, Transaction *txn);
+
 private:
   dberr_t FlushCatalogMetaPage() const;
 
+  // write the metadata of the index, followed by its statistics if it keeps any
+  dberr_t FlushIndexMetaPage(const index_id_t index_id) const;
+
   dberr_t LoadTable(const table_id_t table_id, const page_id_t page_id);
 
   dberr_t LoadIndex(const index_id_t index_id, const page_id_t page_id);
 
+  // empty the indexes and fill them from the heap again, for indexes that no longer match the table
+  dberr_t RebuildIndexes(TableInfo *table_info, const std::vector<IndexInfo *> &indexes, Transaction *txn);
+
   dberr_t GetTable(const table_id_t table_id, TableInfo *&table_info);
 
 private:
@@ -4,8 +4,10 @@
 #include <memory>
 
 #include "catalog/table.h"
+#include "index/art_index.h"
 #include "index/generic_key.h"
 #include "index/b_plus_tree_index.h"
+#include "index/hash_index.h"
 #include "record/schema.h"
 
 class IndexMetadata {
@@ -14,7 +16,9 @@ class IndexMetadata {
 public:
   static IndexMetadata *Create(const index_id_t index_id, const std::string &index_name,
                                const table_id_t table_id, const std::vector<uint32_t> &key_map,
-                               MemHeap *heap);
+                               MemHeap *heap, bool unique = true,
+                               const std::vector<uint32_t> &include_map = {},
+                               const std::string &index_type = "bptree");
 
   uint32_t SerializeTo(char *buf) const;
 
@@ -32,15 +36,25 @@ public:
 
   inline index_id_t GetIndexId() const { return index_id_; }
 
+  inline bool IsUnique() const { return unique_; }
+
+  inline const std::vector<uint32_t> &GetIncludeMapping() const { return include_map_; }
+
+  inline const std::string &GetIndexType() const { return index_type_; }
+
 private:
   IndexMetadata() = delete;
 
   explicit IndexMetadata(const index_id_t index_id, const std::string &index_name,
-                         const table_id_t table_id, const std::vector<uint32_t> &key_map) {
+                         const table_id_t table_id, const std::vector<uint32_t> &key_map, bool unique,
+                         const std::vector<uint32_t> &include_map, const std::string &index_type) {
                            index_id_ = index_id;
                            index_name_ = index_name;
                            table_id_ = table_id;
                            key_map_ = key_map;
+                           unique_ = unique;
+                           include_map_ = include_map;
+                           index_type_ = index_type;
                          }
 
 private:
@@ -49,6 +63,9 @@ private:
   std::string index_name_;
   table_id_t table_id_;
   std::vector<uint32_t> key_map_;  /** The mapping of index key to tuple key */
+  bool unique_;  /** false if several rows may share the same key */
+  std::vector<uint32_t> include_map_;  /** tuple columns stored in the leaves next to the key(INCLUDE) */
+  std::string index_type_;  /** "bptree", "hash" or "art" */
 };
 
 /**
@@ -62,6 +79,9 @@ public:
   }
 
   ~IndexInfo() {
+    if (index_ != nullptr) {
+      index_->~Index();
+    }
     delete heap_;
   }
   void Init(IndexMetadata *meta_data, TableInfo *table_info, BufferPoolManager *buffer_pool_manager) {
@@ -72,28 +92,103 @@ public:
     table_info_ = table_info;
     vector<uint32_t> ks(meta_data_->GetKeyMapping());//Get the (index_key->tuple_key) map.
     key_schema_ = Schema::ShallowCopySchema(table_info->GetSchema(),ks,heap_); 
-    index_id_t id = meta_data_->GetIndexId();
-    
-    using INDEX_KEY_TYPE = GenericKey<32>;//Create a B+tree Index.
-    using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
-    void* mem = heap_->Allocate(sizeof(BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>));
-    Index *index = new(mem)BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>(id, key_schema_,buffer_pool_manager);
-    index_ = index;
+    if (!meta_data_->GetIncludeMapping().empty()) {
+      include_schema_ = Schema::ShallowCopySchema(table_info->GetSchema(), meta_data_->GetIncludeMapping(), heap_);
+    }
+    index_ = CreateIndex(buffer_pool_manager);
   }
 
+  /**
+   * Largest key an index over these columns can hold: a null flag per field,
+   * the field data(CHAR data is prefixed with its length), the row id of a
+   * non-unique index and the included columns, encoded the same way
+   */
+  static uint32_t GetMaxKeySize(const Schema *schema, const std::vector<uint32_t> &key_map, bool unique,
+                                const std::vector<uint32_t> &include_map = {}) {
+    uint32_t size = unique ? 0 : sizeof(int64_t);
+    for (const auto *map : {&key_map, &include_map}) {
+      for (auto i : *map) {
+        const Column *column = schema->GetColumn(i);
+        size += sizeof(bool) + column->GetLength();
+        if (column->GetType() == TypeId::kTypeChar) {
+          size += sizeof(uint32_t);
+        }
+      }
+    }
+    return size;
+  }
+
+  static constexpr uint32_t MAX_KEY_SIZE = 256;
+
   inline Index *GetIndex() { return index_; }
 
+  inline IndexMetadata *GetMetaData() const { return meta_data_; }
+
   inline std::string GetIndexName() { return meta_data_->GetIndexName(); }
 
+  inline bool IsUnique() const { return meta_data_->IsUnique(); }
+
   inline IndexSchema *GetIndexKeySchema() { return key_schema_; }
 
+  // schema of the INCLUDE columns, nullptr if there are none
+  inline IndexSchema *GetIncludeSchema() { return include_schema_; }
+
+  inline const std::vector<uint32_t> &GetIncludeMapping() const { return meta_data_->GetIncludeMapping(); }
+
+  inline const std::string &GetIndexType() const { return meta_data_->GetIndexType(); }
+
   inline MemHeap *GetMemHeap() const { return heap_; }
 
   inline TableInfo *GetTableInfo() const { return table_info_; }
 
 private:
   explicit IndexInfo() : meta_data_{nullptr}, index_{nullptr}, table_info_{nullptr},
-                         key_schema_{nullptr}, heap_(new SimpleMemHeap()) {}
+                         key_schema_{nullptr}, include_schema_{nullptr}, heap_(new SimpleMemHeap()) {}
+
+  // Create the index with the smallest key type that holds every key, a hash index never stores the row id
+  Index *CreateIndex(BufferPoolManager *buffer_pool_manager) {
+    if (meta_data_->GetIndexType() == "art") {
+      // in memory, keys are encoded to strings and have no size limit
+      void *mem = heap_->Allocate(sizeof(ArtIndex));
+      return new(mem)ArtIndex(meta_data_->GetIndexId(), key_schema_, meta_data_->IsUnique());
+    }
+    uint32_t key_size = GetMaxKeySize(table_info_->GetSchema(), meta_data_->GetKeyMapping(),
+                                      meta_data_->IsUnique() || meta_data_->GetIndexType() == "hash",
+                                      meta_data_->GetIncludeMapping());
+    ASSERT(key_size <= MAX_KEY_SIZE, "Index key size exceed max key size.");
+    if (key_size <= 4) {
+      return CreateSizedIndex<4>(buffer_pool_manager);
+    } else if (key_size <= 8) {
+      return CreateSizedIndex<8>(buffer_pool_manager);
+    } else if (key_size <= 16) {
+      return CreateSizedIndex<16>(buffer_pool_manager);
+    } else if (key_size <= 32) {
+      return CreateSizedIndex<32>(buffer_pool_manager);
+    } else if (key_size <= 64) {
+      return CreateSizedIndex<64>(buffer_pool_manager);
+    } else if (key_size <= 128) {
+      return CreateSizedIndex<128>(buffer_pool_manager);
+    }
+    return CreateSizedIndex<256>(buffer_pool_manager);
+  }
+
+  template<size_t KeySize>
+  Index *CreateSizedIndex(BufferPoolManager *buffer_pool_manager) {
+    using INDEX_KEY_TYPE = GenericKey<KeySize>;
+    using INDEX_COMPARATOR_TYPE = GenericComparator<KeySize>;
+    if (meta_data_->GetIndexType() == "hash") {
+      void *mem = heap_->Allocate(sizeof(HashIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>));
+      return new(mem)HashIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>(meta_data_->GetIndexId(), key_schema_,
+                                                                          buffer_pool_manager,
+                                                                          meta_data_->IsUnique());
+    }
+    void *mem = heap_->Allocate(sizeof(BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>));
+    return new(mem)BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>(meta_data_->GetIndexId(), key_schema_,
+                                                                               buffer_pool_manager,
+                                                                               meta_data_->IsUnique(),
+                                                                               include_schema_,
+                                                                               meta_data_->IsUnique());
+  }
 
 
 private:
@@ -101,6 +196,7 @@ private:
   Index *index_;
   TableInfo *table_info_;
   IndexSchema *key_schema_;
+  IndexSchema *include_schema_;
   MemHeap *heap_;
 };
 
@@ -19,7 +19,8 @@ public:
   //Use the heap in TableInfo.
 
   static TableMetadata *Create(table_id_t table_id, std::string table_name,
-                               page_id_t root_page_id, TableSchema *schema, MemHeap *heap);
+                               page_id_t root_page_id, TableSchema *schema, MemHeap *heap,
+                               page_id_t fsm_page_id = INVALID_PAGE_ID, TableLayout layout = kLayoutRow);
 
   inline table_id_t GetTableId() const { return table_id_; }
 
@@ -27,18 +28,25 @@ public:
 
   inline uint32_t GetFirstPageId() const { return root_page_id_; }
 
+  inline page_id_t GetFreeSpaceMapPageId() const { return fsm_page_id_; }
+
+  inline TableLayout GetLayout() const { return layout_; }
+
   inline Schema *GetSchema() const { return schema_; }
 
 private:
   TableMetadata() = delete;
 
-  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema);
+  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema,
+                page_id_t fsm_page_id, TableLayout layout);
 
 private:
   static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344528;
   table_id_t table_id_;
   std::string table_name_;
   page_id_t root_page_id_;//Record's root page id of this table.
+  page_id_t fsm_page_id_;//First page of the free space map of the table.
+  TableLayout layout_;//Row or columnar pages.
   //Meta page is managed by CatalogMeta.
   Schema *schema_;
 };
@@ -15,9 +15,18 @@ static constexpr int INDEX_ROOTS_PAGE_ID = 1;        // logical page id of the i
 
 static constexpr int PAGE_SIZE = 4096;               // size of a data page in byte
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 1024;// default size of buffer pool
+static constexpr int INDEX_MIN_FILL = 25;            // percent of a non-root index page kept before it merges
+static constexpr int BLOOM_FILTER_BITS_PER_KEY = 10; // bloom filter bits per index key, 0 turns the filters off
+static constexpr int TABLE_BATCH_SIZE = 1024;        // max tuples in a column batch of a table scan
+static constexpr int TABLE_MORSEL_PAGES = 32;        // pages a worker of a parallel table scan takes at a time
+static constexpr int AUTO_VACUUM_MIN_PAGES = 16;     // tables smaller than this are never vacuumed after DELETE
+static constexpr int AUTO_VACUUM_FREE_PERCENT = 50;  // percent of free table space that triggers a vacuum
+static constexpr int TOAST_ROW_THRESHOLD = PAGE_SIZE / 4; // rows larger than this move their largest CHAR values to overflow pages
+static constexpr int ZONE_MAP_MAX_COLUMNS = 32;      // INT and FLOAT columns of a table that get per page min/max zones
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
-static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;    // max length of varchar
+static constexpr uint32_t VARCHAR_MAX_LEN = 1 << 24;         // max length of varchar, long values live in overflow pages
+static constexpr uint32_t FIELD_OVERFLOW_FLAG = 1U << 31;     // set in the stored length of a value kept in overflow pages
 
 // static std::string DB_META_FILE = "minisql.meta.db";
 
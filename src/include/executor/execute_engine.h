@@ -15,6 +15,8 @@ extern "C" {
 #include "parser/parser.h"
 };
 
+class RowBatch;
+
 
 /**
  * ExecuteContext stores all the context necessary to run in the execute engine
@@ -66,6 +68,10 @@ private:
 
   dberr_t ExecuteDropIndex(pSyntaxNode ast, ExecuteContext *context);
 
+  dberr_t ExecuteAnalyze(pSyntaxNode ast, ExecuteContext *context);
+
+  dberr_t ExecuteVacuum(pSyntaxNode ast, ExecuteContext *context);
+
   dberr_t ExecuteSelect(pSyntaxNode ast, ExecuteContext *context);
 
   dberr_t ExecuteInsert(pSyntaxNode ast, ExecuteContext *context);
@@ -89,6 +95,21 @@ private:
         Field* field;
         std::string cmp;
     };
+    //编译好的子句节点，见ClauseCompile
+    struct clauseNode {
+        enum Kind { kAnd, kOr, kIsNull, kNotNull, kCompare, kConstant } kind;
+        std::string cmp;            //比较运算符
+        uint32_t column{ 0 };       //表中的列号
+        TypeId type{ kTypeInvalid };
+        int32_t integer{ 0 };
+        float real{ 0 };
+        std::string chars;          //CHAR常数，不补0
+        bool result{ false };       //kConstant的值
+        int left{ -1 };             //and/or两边在数组里的下标
+        int right{ -1 };
+    };
+    //索引统计估计的每个key的行数，没有统计时最大
+    static uint64_t EstimateKeyRows(IndexInfo* indexInfo);
     std::unordered_map<std::string, DBStorageEngine*> dbs_;  /** all opened databases */
     std::string current_db_;  /** current database */
     DBStorageEngine* curDB; //当前的指针
@@ -98,9 +119,21 @@ private:
     std::string dbPath; //db文件放的地方
     void DBIntialize();
     void FileCommand(char* input, const int len, std::ifstream& in);
-    bool ClauseAnalysis(std::map<std::string, Field*>& valMap, std::map<std::string, TypeId>& typeMap, pSyntaxNode kNode);
+    int ClauseCompile(std::map<std::string, uint32_t>& columnIds, std::vector<Column*>& columns, pSyntaxNode kNode, std::vector<clauseNode>& nodes);
+    template <typename Source>
+    static bool ClauseMatch(const std::vector<clauseNode>& nodes, int index, const Source& source);
     bool ClauseAndParser(std::map<std::string, TypeId>& typeMap, std::map<std::string, uint32_t>& lengthMap, pSyntaxNode kNode, std::set<std::string>& colNameSet, std::map<std::string, fieldCmp>& parserIndexRes, std::map<std::string, fieldCmp>& parserEtcRes);
     bool RecordJudge(Row& row, std::map<std::string, fieldCmp>& parser, std::map<std::string, uint32_t>& idxMap);
+    void CollectIndexKeys(std::vector<IndexInfo*>& indexes, std::vector<Field*>& fields, const RowId& rid, std::vector<std::vector<Row>>& keys, std::vector<std::vector<RowId>>& ids);
+    bool RemoveIndexKeys(std::vector<IndexInfo*>& indexes, std::vector<std::vector<Row>>& keys, std::vector<std::vector<RowId>>& ids);
+    bool UpdateRow(TableInfo* tableInfo, std::vector<IndexInfo*>& indexes, Row& oldRow, std::vector<Field*>& updateFields);
+    void ClauseColumns(pSyntaxNode kNode, std::set<std::string>& names);
+    void ScanTable(TableInfo* tableInfo, pSyntaxNode clause, std::vector<Row>& result, int* fetchColumns = nullptr);
+    void FilterBatch(const RowBatch& batch, std::vector<int>& positionOf, std::vector<clauseNode>& nodes, int index, std::vector<uint8_t>& selection);
+    bool ZoneMayMatch(TableHeap* tableHeap, page_id_t pageId, std::vector<clauseNode>& nodes, int index);
+    void EvaluateRows(const RowBatch& batch, std::vector<int>& positionOf, std::vector<clauseNode>& nodes, int index, std::vector<uint8_t>& selection);
+    void AutoVacuum(const std::string& tableName);
+    bool CoveringScan(IndexInfo* indexinfo, int cmpState, Row& keyRow, std::vector<Column*>& columns, int* isPrint, std::map<std::string, fieldCmp>& indexFinal, std::map<std::string, fieldCmp>& etcFinal, std::map<std::string, uint32_t>& idxMap, std::vector<Row>& result);
 };
 
 #endif //MINISQL_EXECUTE_ENGINE_H
@@ -0,0 +1,127 @@
+#ifndef MINISQL_ART_INDEX_H
+#define MINISQL_ART_INDEX_H
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "index/index.h"
+#include "record/schema.h"
+
+/**
+ * In-memory adaptive radix tree index(CREATE INDEX ... USING art).
+ *
+ * Keys are encoded so that memcmp order is key order: a null flag byte per
+ * field, INT and FLOAT as big-endian bytes with the sign fixed up, CHAR with
+ * 0x00 escaped as 0x00 0xFF and terminated by 0x00 0x00. A non-unique index
+ * appends the big-endian row id, so no key is a prefix of another and
+ * every key ends in a leaf.
+ *
+ * Inner nodes hold 4, 16, 48 or 256 children and grow or shrink between those
+ * sizes, and a node keeps the whole compressed path above its children. Nothing
+ * is written to disk, the catalog rebuilds the tree from the table when it
+ * loads the index.
+ */
+class ArtIndex : public Index {
+public:
+  ArtIndex(index_id_t index_id, IndexSchema *key_schema, bool unique = true);
+
+  ~ArtIndex() override;
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Transaction *txn) override;
+
+  dberr_t RemoveEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Transaction *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn) override;
+
+  dberr_t ScanRange(const Row *lower, const Row *upper, std::vector<RowId> &result, Transaction *txn) override;
+
+  dberr_t ScanRangeEntries(const Row *lower, const Row *upper, std::vector<Row> &result, Transaction *txn) override;
+
+  dberr_t Destroy() override;
+
+  bool IsEmpty() override { return root_ == nullptr; }
+
+  bool IsUnique() const { return unique_; }
+
+  size_t GetSize() const { return size_; }
+
+  // memcmp comparable encoding of the key fields
+  static void EncodeKey(const Row &key, Schema *schema, std::string &out);
+
+  // inverse of EncodeKey, return the number of bytes read
+  static size_t DecodeKey(const std::string &data, Schema *schema, std::vector<Field> &fields);
+
+private:
+  enum class NodeType : uint8_t { kLeaf, kNode4, kNode16, kNode48, kNode256 };
+
+  struct Node {
+    explicit Node(NodeType type) : type_(type) {}
+    NodeType type_;
+    uint16_t count_{0};
+    std::string prefix_;  // compressed path, inner nodes only
+  };
+
+  struct Leaf : Node {
+    Leaf(const std::string &key, RowId value) : Node(NodeType::kLeaf), key_(key), value_(value) {}
+    std::string key_;
+    RowId value_;
+  };
+
+  struct Node4 : Node {
+    Node4() : Node(NodeType::kNode4) {}
+    uint8_t keys_[4];
+    Node *children_[4];
+  };
+
+  struct Node16 : Node {
+    Node16() : Node(NodeType::kNode16) {}
+    uint8_t keys_[16];
+    Node *children_[16];
+  };
+
+  struct Node48 : Node {
+    Node48() : Node(NodeType::kNode48) { memset(child_index_, 0, sizeof(child_index_)); }
+    uint8_t child_index_[256];  // slot + 1 of each byte, 0 if absent
+    Node *children_[48];
+  };
+
+  struct Node256 : Node {
+    Node256() : Node(NodeType::kNode256) { memset(children_, 0, sizeof(children_)); }
+    Node *children_[256];
+  };
+
+  // the full encoded key of an entry
+  void MakeKey(const Row &key, RowId row_id, std::string &out) const;
+
+  static Node **FindChild(Node *node, uint8_t byte);
+
+  static void AddChild(Node *&node, uint8_t byte, Node *child);
+
+  static void RemoveChild(Node *&node, uint8_t byte);
+
+  static void FreeNode(Node *node);
+
+  bool Insert(Node *&node, Leaf *leaf, size_t depth);
+
+  bool Remove(Node *&node, const std::string &key, size_t depth);
+
+  Leaf *Lookup(const std::string &key) const;
+
+  // visit the leaves in [lower, upper] in key order, a null bound is unbounded, stop when visit returns false
+  template<typename Visitor>
+  bool Scan(Node *node, std::string &path, const std::string *lower, const std::string *upper, Visitor &visit) const;
+
+  // bounds of every entry whose key fields equal or pass lower/upper
+  void MakeBounds(const Row *lower, const Row *upper, std::string &lower_key, std::string &upper_key) const;
+
+  bool unique_;
+  Node *root_;
+  size_t size_;
+};
+
+#endif  // MINISQL_ART_INDEX_H
@@ -1,6 +1,7 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <functional>
 #include <queue>
 #include <string>
 #include <vector>
@@ -19,7 +20,8 @@
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys stored in the tree are unique; non-unique indexes make them unique
+ *     by appending the row id to the key (see GenericKey)
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
@@ -39,21 +41,51 @@ public:
   // Insert a key-value pair into this B+ tree.
   bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
-  // Remove a key and its value from this B+ tree.
-  void Remove(const KeyType &key, Transaction *transaction = nullptr);
+  // Remove a key and its value from this B+ tree, return false if the key was not there.
+  bool Remove(const KeyType &key, Transaction *transaction = nullptr);
+
+  // Insert key-value pairs sorted by key, return how many were inserted
+  int InsertBatch(const std::vector<MappingType> &items, Transaction *transaction = nullptr);
+
+  // Remove keys sorted in ascending order, return how many were removed
+  int RemoveBatch(const std::vector<KeyType> &keys, Transaction *transaction = nullptr);
+
+  // A non-root page merges or borrows only once it is less than percent full, 50 by default
+  void SetMinFill(int percent) { min_fill_ = percent; }
+
+  // Merge sparse leaves into their right(or last, left) sibling, return the number of leaves merged
+  int Compact(Transaction *transaction = nullptr);
+
+  // Walk down to the left most leaf and along all leaves: the height, the leaves, the entries and the share of
+  // leaf slots in use. visit, if given, is called for every key in order
+  void Analyze(uint32_t &height, uint32_t &leaf_count, uint64_t &entry_count, float &fill,
+               const std::function<void(const KeyType &)> &visit = nullptr);
 
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> &result, Transaction *transaction = nullptr);
 
+  // return the values of all keys in [lower, upper], a null bound is unbounded. keys, if given, gets the keys too
+  bool GetValueRange(const KeyType *lower, const KeyType *upper, std::vector<ValueType> &result,
+                     Transaction *transaction = nullptr, std::vector<KeyType> *keys = nullptr);
+
   INDEXITERATOR_TYPE Begin();
 
   INDEXITERATOR_TYPE Begin(const KeyType &key);
 
   INDEXITERATOR_TYPE End();
 
+  INDEXITERATOR_TYPE RBegin();
+
+  INDEXITERATOR_TYPE RBegin(const KeyType &key);
+
+  INDEXITERATOR_TYPE REnd();
+
   // expose for test purpose
   Page *FindLeafPage(const KeyType &key, bool leftMost = false);
 
+  // find the leaf of key and the separator that bounds the leaf from above
+  Page *FindLeafPage(const KeyType &key, KeyType &fence, bool &has_fence);
+
   // used to check whether all pages are unpinned
   bool Check();
 
@@ -96,6 +128,9 @@ private:
 
   bool AdjustRoot(BPlusTreePage *node);
 
+  // the size below which remove rebalances a page, after min_fill_
+  int MinSize(const BPlusTreePage *page) const;
+
   void UpdateRootPageId(int insert_record = 0);
 
   /* Debug Routines for FREE!! */
@@ -110,6 +145,7 @@ private:
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  int min_fill_;
 };
 
 #endif  // MINISQL_B_PLUS_TREE_H
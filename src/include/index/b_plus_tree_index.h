@@ -2,6 +2,7 @@
 #define MINISQL_B_PLUS_TREE_INDEX_H
 
 #include "index/b_plus_tree.h"
+#include "index/bloom_filter.h"
 #include "index/index.h"
 
 #define BPLUSTREE_INDEX_TYPE BPlusTreeIndex<KeyType, ValueType, KeyComparator>
@@ -9,17 +10,35 @@
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
 public:
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager);
+  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager,
+                 bool unique = true, IndexSchema *include_schema = nullptr, bool bloom_filter = false);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
   dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
+  dberr_t InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Transaction *txn) override;
+
+  dberr_t RemoveEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Transaction *txn) override;
+
   dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn) override;
 
+  dberr_t ScanRange(const Row *lower, const Row *upper, std::vector<RowId> &result, Transaction *txn) override;
+
+  dberr_t ScanRangeEntries(const Row *lower, const Row *upper, std::vector<Row> &result, Transaction *txn) override;
+
   dberr_t Destroy() override;
+
+  IndexStatistics *GetStatistics() override { return &stats_; }
+
+  dberr_t Analyze(Transaction *txn) override;
   
-  bool IsEmpty() { return container_.IsEmpty(); }
+  bool IsEmpty() override { return container_.IsEmpty(); }
+
+  bool IsUnique() const { return comparator_.IsUnique(); }
+
+  // merge the leaves left sparse by deletes, return the number of leaves merged
+  int Compact(Transaction *txn = nullptr) { return container_.Compact(txn); }
   
   INDEXITERATOR_TYPE GetBeginIterator();
 
@@ -27,11 +46,32 @@ public:
 
   INDEXITERATOR_TYPE GetEndIterator();
 
+  INDEXITERATOR_TYPE GetRBeginIterator();
+
+  INDEXITERATOR_TYPE GetRBeginIterator(const KeyType &key);
+
+  INDEXITERATOR_TYPE GetREndIterator();
+
 protected:
+  // serialize an entry row(key columns, then included columns) into an index key
+  void SerializeEntry(const Row &entry, RowId row_id, KeyType &index_key);
+
+  // refill the bloom filter from the leaves, sized for the keys found
+  void RebuildBloomFilter();
+
+  // add a key to the bloom filter, or rebuild it once it holds too many keys
+  void AddToBloomFilter(const Row &key);
+
+  // columns stored in the leaves after the key, nullptr if the index covers only its key
+  IndexSchema *include_schema_;
   // comparator for key
   KeyComparator comparator_;
   // container
   BPLUSTREE_TYPE container_;
+  // entry counts follow DML, ANALYZE rebuilds the rest
+  IndexStatistics stats_;
+  // lets ScanKey skip the tree for absent keys, disabled unless asked for
+  BloomFilter bloom_;
 };
 
 #endif //MINISQL_B_PLUS_TREE_INDEX_H
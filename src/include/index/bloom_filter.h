@@ -0,0 +1,43 @@
+#ifndef MINISQL_BLOOM_FILTER_H
+#define MINISQL_BLOOM_FILTER_H
+
+#include <vector>
+
+#include "record/row.h"
+
+/**
+ * In-memory Bloom filter over the keys of an index.
+ *
+ * The filter answers "definitely absent" or "maybe present". Removed keys are
+ * never cleared, they only cost a false positive until the filter is rebuilt.
+ * The filter holds BLOOM_FILTER_BITS_PER_KEY bits per key it was sized for
+ * and reports Overloaded() once twice that many keys were added.
+ */
+class BloomFilter {
+public:
+  // drop every key and size the filter for expected_keys keys
+  void Reset(uint64_t expected_keys);
+
+  inline bool IsEnabled() const { return !bits_.empty(); }
+
+  // true once the false positive rate has grown well past its target
+  inline bool Overloaded() const { return added_ > 2 * capacity_; }
+
+  void Add(uint64_t hash);
+
+  bool MayContain(uint64_t hash) const;
+
+  // hash of the first key_count fields, equal keys hash equal
+  static uint64_t HashKey(const Row &key, uint32_t key_count);
+
+private:
+  static constexpr uint32_t HASH_COUNT = 7;  /** about ln 2 * bits per key */
+  static constexpr uint64_t MIN_KEYS = 1024;
+
+  std::vector<uint64_t> bits_;
+  uint64_t mask_{0};  /** number of bits - 1, a power of 2 */
+  uint64_t capacity_{0};
+  uint64_t added_{0};
+};
+
+#endif  // MINISQL_BLOOM_FILTER_H
@@ -0,0 +1,74 @@
+#ifndef MINISQL_EXTENDIBLE_HASH_TABLE_H
+#define MINISQL_EXTENDIBLE_HASH_TABLE_H
+
+#include <vector>
+
+#include "page/hash_table_bucket_page.h"
+#include "page/hash_table_directory_page.h"
+#include "page/index_roots_page.h"
+#include "transaction/transaction.h"
+
+#define HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator>
+
+/**
+ * Disk based extendible hash table.
+ *
+ * The directory page is registered in the index roots page like the root of a
+ * B+ tree. A full bucket is split in two and the directory doubles when the
+ * bucket is already as deep as it, a bucket with overflow pages is split along
+ * with its whole chain. Only entries that share the same hash(or a directory at
+ * its max depth) go to overflow pages. Buckets are never merged, an emptied
+ * overflow page is unlinked and freed.
+ *
+ * The caller supplies the hash of each key, so keys that compare equal must
+ * hash alike.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExtendibleHashTable {
+  using BucketPage = HashTableBucketPage<KeyType, ValueType, KeyComparator>;
+  using Entry = typename BucketPage::Entry;
+
+public:
+  explicit ExtendibleHashTable(index_id_t index_id, BufferPoolManager *buffer_pool_manager,
+                               const KeyComparator &comparator);
+
+  // Returns true if this hash table has no keys and values.
+  bool IsEmpty();
+
+  // Insert a key-value pair, equal keys are allowed.
+  bool Insert(uint32_t hash, const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // Remove the entry with this key and value, return false if there is none.
+  bool Remove(uint32_t hash, const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // Collect the values of all entries equal to key.
+  bool GetValue(uint32_t hash, const KeyType &key, std::vector<ValueType> &result, Transaction *transaction = nullptr);
+
+  // Free every page of the table.
+  void Destroy();
+
+private:
+  void StartNewTable();
+
+  HashTableDirectoryPage *FetchDirectory();
+
+  BucketPage *FetchBucket(page_id_t page_id);
+
+  // true if every entry in the chain starting at page_id has this hash
+  bool ChainHashEqual(page_id_t page_id, uint32_t hash);
+
+  // split the bucket of this slot together with its overflow pages
+  void SplitBucket(HashTableDirectoryPage *directory, uint32_t slot);
+
+  // write entries over the given pages in order, chain new ones if they do not fit and free the ones left over.
+  // Returns the first page of the chain
+  page_id_t WriteChain(std::vector<page_id_t> pages, const std::vector<Entry> &entries);
+
+  // member variable
+  index_id_t index_id_;
+  page_id_t directory_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+};
+
+#endif  // MINISQL_EXTENDIBLE_HASH_TABLE_H
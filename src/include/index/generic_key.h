@@ -6,22 +6,68 @@
 #include "record/row.h"
 #include "record/field.h"
 
+/**
+ * Index key of a fixed slot size.
+ *
+ * The key is stored as a serialized row without the leading field count, which
+ * is the same for every key of an index and is already known from the key schema:
+ *  ------------------------------------------------------
+ * | NullMap (1 byte per field) | Field(1) | ... | Field(n) |
+ *  ------------------------------------------------------
+ * Non-unique indexes append the row id, and covering indexes then append the
+ * INCLUDE columns in the same encoding. Neither takes part in key comparison
+ * beyond the row id tie-break.
+ */
 template<size_t KeySize>
 class GenericKey {
 public:
+  // bytes a key occupies in the slot, excluding the row id of non-unique indexes
+  static inline uint32_t GetSerializedSize(const Row &key, Schema *schema) {
+    return key.GetSerializedSize(schema) - sizeof(uint32_t);
+  }
+
   inline void SerializeFromKey(const Row &key, Schema *schema) {
     // initialize to 0
-    uint32_t size = key.GetSerializedSize(schema);
+    uint32_t size = GetSerializedSize(key, schema);
     ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
     ASSERT(size <= KeySize, "Index key size exceed max key size.");
     memset(data, 0, KeySize);
-    key.SerializeTo(data, schema);
+    char buf[KeySize + sizeof(uint32_t)];
+    key.SerializeTo(buf, schema);
+    memcpy(data, buf + sizeof(uint32_t), size);
   }
 
-  inline void DeserializeToKey(Row &key, Schema *schema) const {
-    uint32_t ofs = key.DeserializeFrom(const_cast<char *>(data), schema);
+  // non-unique index: the row id is stored right after the key fields as a tiebreaker
+  inline void SerializeFromKey(const Row &key, const RowId &row_id, Schema *schema) {
+    uint32_t size = GetSerializedSize(key, schema);
+    ASSERT(size + sizeof(int64_t) <= KeySize, "Index key size exceed max key size.");
+    SerializeFromKey(key, schema);
+    MACH_WRITE_TO(int64_t, data + size, row_id.Get());
+  }
+
+  // covering index: store the included column values at ofs, right after the key
+  inline void SerializeIncluded(const Row &included, uint32_t ofs, Schema *schema) {
+    uint32_t size = GetSerializedSize(included, schema);
+    ASSERT(ofs + size <= KeySize, "Index key size exceed max key size.");
+    char buf[KeySize + sizeof(uint32_t)];
+    included.SerializeTo(buf, schema);
+    memcpy(data + ofs, buf + sizeof(uint32_t), size);
+  }
+
+  inline uint32_t DeserializeIncluded(Row &included, uint32_t ofs, Schema *schema) const {
+    char buf[KeySize + sizeof(uint32_t)];
+    MACH_WRITE_UINT32(buf, schema->GetColumnCount());
+    memcpy(buf + sizeof(uint32_t), data + ofs, KeySize - ofs);
+    return included.DeserializeFrom(buf, schema) - sizeof(uint32_t);
+  }
+
+  inline uint32_t DeserializeToKey(Row &key, Schema *schema) const {
+    char buf[KeySize + sizeof(uint32_t)];
+    MACH_WRITE_UINT32(buf, schema->GetColumnCount());
+    memcpy(buf + sizeof(uint32_t), data, KeySize);
+    uint32_t ofs = key.DeserializeFrom(buf, schema) - sizeof(uint32_t);
     ASSERT(ofs <= KeySize, "Index key size exceed max key size.");
-    return;
+    return ofs;
   }
 
   // compare
@@ -54,11 +100,27 @@ class GenericComparator {
 public:
   inline int operator()(const GenericKey<KeySize> &lhs,
                         const GenericKey<KeySize> &rhs) const {
+    if (int_key_ && !lhs.data[0] && !rhs.data[0]) {
+      // a single non-null INT column, compare the stored values without building rows
+      int32_t lhs_val = MACH_READ_FROM(int32_t, lhs.data + sizeof(bool));
+      int32_t rhs_val = MACH_READ_FROM(int32_t, rhs.data + sizeof(bool));
+      if (lhs_val != rhs_val) {
+        return lhs_val < rhs_val ? -1 : 1;
+      }
+      if (!unique_) {
+        int64_t lhs_rid = MACH_READ_FROM(int64_t, lhs.data + sizeof(bool) + sizeof(int32_t));
+        int64_t rhs_rid = MACH_READ_FROM(int64_t, rhs.data + sizeof(bool) + sizeof(int32_t));
+        if (lhs_rid != rhs_rid) {
+          return lhs_rid < rhs_rid ? -1 : 1;
+        }
+      }
+      return 0;
+    }
     int column_count = key_schema_->GetColumnCount();
     Row lhs_key(INVALID_ROWID);
     Row rhs_key(INVALID_ROWID);
-    lhs.DeserializeToKey(lhs_key, key_schema_);
-    rhs.DeserializeToKey(rhs_key, key_schema_);
+    uint32_t lhs_ofs = lhs.DeserializeToKey(lhs_key, key_schema_);
+    uint32_t rhs_ofs = rhs.DeserializeToKey(rhs_key, key_schema_);
 
     for (int i = 0; i < column_count; i++) {
       Field *lhs_value = lhs_key.GetField(i);
@@ -70,19 +132,35 @@ public:
       if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue)
         return 1;
     }
+    if (!unique_) {
+      // equal keys of a non-unique index are ordered by row id
+      int64_t lhs_rid = MACH_READ_FROM(int64_t, lhs.data + lhs_ofs);
+      int64_t rhs_rid = MACH_READ_FROM(int64_t, rhs.data + rhs_ofs);
+      if (lhs_rid != rhs_rid) {
+        return lhs_rid < rhs_rid ? -1 : 1;
+      }
+    }
     // equals
     return 0;
   }
 
   GenericComparator(const GenericComparator &other) {
     this->key_schema_ = other.key_schema_;
+    this->unique_ = other.unique_;
+    this->int_key_ = other.int_key_;
   }
 
   // constructor
-  GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
+  GenericComparator(Schema *key_schema, bool unique = true)
+          : key_schema_(key_schema), unique_(unique),
+            int_key_(key_schema->GetColumnCount() == 1 && key_schema->GetColumn(0)->GetType() == TypeId::kTypeInt) {}
+
+  inline bool IsUnique() const { return unique_; }
 
 private:
   Schema *key_schema_;
+  bool unique_;
+  bool int_key_;  /** true if the key is a single INT column */
 };
 
 #endif  // MINISQL_GENERIC_KEY_H
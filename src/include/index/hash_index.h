@@ -0,0 +1,57 @@
+#ifndef MINISQL_HASH_INDEX_H
+#define MINISQL_HASH_INDEX_H
+
+#include "index/extendible_hash_table.h"
+#include "index/index.h"
+
+#define HASH_INDEX_TYPE HashIndex<KeyType, ValueType, KeyComparator>
+
+/**
+ * Equality only index(CREATE INDEX ... USING hash). A lookup reads the
+ * directory page and one bucket instead of walking down a B+ tree.
+ *
+ * Keys are stored without the row id even if the index is not unique, equal
+ * keys simply share a bucket. Range scans are not supported, only a range
+ * whose bounds are the same key.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class HashIndex : public Index {
+public:
+  HashIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager,
+            bool unique = true);
+
+  dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
+
+  dberr_t InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Transaction *txn) override;
+
+  dberr_t RemoveEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Transaction *txn) override;
+
+  dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn) override;
+
+  dberr_t ScanRange(const Row *lower, const Row *upper, std::vector<RowId> &result, Transaction *txn) override;
+
+  dberr_t ScanRangeEntries(const Row *lower, const Row *upper, std::vector<Row> &result, Transaction *txn) override;
+
+  dberr_t Destroy() override;
+
+  bool IsEmpty() override { return container_.IsEmpty(); }
+
+  bool IsUnique() const { return unique_; }
+
+  // hash of the key values, keys that compare equal hash alike
+  static uint32_t HashKey(const Row &key);
+
+protected:
+  // true if both bounds are given and hold the same key
+  bool IsPointRange(const Row *lower, const Row *upper);
+
+  bool unique_;
+  // comparator for key, never looks at a row id
+  KeyComparator comparator_;
+  // container
+  HASH_TABLE_TYPE container_;
+};
+
+#endif  // MINISQL_HASH_INDEX_H
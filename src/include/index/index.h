@@ -4,6 +4,7 @@
 #include <memory>
 
 #include "common/dberr.h"
+#include "index/index_statistics.h"
 #include "record/row.h"
 #include "transaction/transaction.h"
 
@@ -18,10 +19,29 @@ public:
 
   virtual dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) = 0;
 
+  // batch versions of InsertEntry/RemoveEntry, keys[i] belongs to row_ids[i]
+  virtual dberr_t InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Transaction *txn) = 0;
+
+  virtual dberr_t RemoveEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Transaction *txn) = 0;
+
   virtual dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn) = 0;
 
+  // collect the row ids of all keys in [lower, upper] in key order, a null bound is unbounded
+  virtual dberr_t ScanRange(const Row *lower, const Row *upper, std::vector<RowId> &result, Transaction *txn) = 0;
+
+  // like ScanRange, but return the stored entries: key columns followed by the included columns, with the row id set
+  virtual dberr_t ScanRangeEntries(const Row *lower, const Row *upper, std::vector<Row> &result, Transaction *txn) = 0;
+
+  virtual bool IsEmpty() = 0;
+
   virtual dberr_t Destroy() = 0;
 
+  // planner statistics, nullptr if the index keeps none
+  virtual IndexStatistics *GetStatistics() { return nullptr; }
+
+  // rebuild the statistics from the whole index(ANALYZE)
+  virtual dberr_t Analyze(Transaction *txn) { return DB_FAILED; }
+
 protected:
   index_id_t index_id_;
   IndexSchema *key_schema_;
@@ -1,16 +1,33 @@
 #ifndef MINISQL_INDEX_ITERATOR_H
 #define MINISQL_INDEX_ITERATOR_H
 
+#include <vector>
+
 #include "page/b_plus_tree_leaf_page.h"
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * The iterator owns one pin on the leaf it points at, taken over from the
+ * tree when it is constructed. Moving to another leaf pins the new leaf
+ * before unpinning the old one, a copy pins the leaf again and the
+ * destructor gives the pin back, so a scan of any length keeps one leaf
+ * pinned.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
 public:
-  // you may define your own constructor based on your member variables
+  // lp is pinned by the caller and the pin now belongs to the iterator
   explicit IndexIterator(BufferPoolManager*b,page_id_t pid,BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>*lp,int index);
 
+  IndexIterator(const IndexIterator &other);
+
+  IndexIterator(IndexIterator &&other) noexcept;
+
+  IndexIterator &operator=(const IndexIterator &other);
+
+  IndexIterator &operator=(IndexIterator &&other) noexcept;
+
   ~IndexIterator();
 
   /** Return the key/value pair this iterator is currently pointing at. */
@@ -19,6 +36,15 @@ public:
   /** Move to the next key/value pair.*/
   IndexIterator &operator++();
 
+  /** Move to the previous key/value pair, one before the first pair is the reverse end.*/
+  IndexIterator &operator--();
+
+  /**
+   * Append the values from here to the end of the current leaf and move to the
+   * first pair of the next leaf. Return the number of values appended, 0 at the end.
+   */
+  int NextN(std::vector<ValueType> &values);
+
   /** Return whether two iterators are equal */
   bool operator==(const IndexIterator &itr) const;
 
@@ -26,13 +52,14 @@ public:
   bool operator!=(const IndexIterator &itr) const;
 
   page_id_t GetCurrPageID()const;
-  void SetCurrPageID(page_id_t page_id);
   BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>*GetLeafPage()const;
-  void SetLeafPage( BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>*leafpage);
   int GetIndexInPage()const;
   void SetIndexInPage(int index);
 
 private:
+  // pin page_id and make it the current leaf, then unpin the leaf left behind
+  void MoveToLeaf(page_id_t page_id);
+
   // add your own private member variables here
   BufferPoolManager*buff_pool_manager;
   page_id_t CurrPageID; //Current page_id we visit
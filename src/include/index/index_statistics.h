@@ -0,0 +1,80 @@
+#ifndef MINISQL_INDEX_STATISTICS_H
+#define MINISQL_INDEX_STATISTICS_H
+
+#include <algorithm>
+#include <vector>
+
+#include "record/row.h"
+#include "record/schema.h"
+
+/**
+ * Planner statistics of an index, stored on the index meta page after the
+ * IndexMetadata.
+ *
+ * The entry count(and the distinct count of a unique index) follows every
+ * insert and delete. The shape of the tree and the equi-depth histogram are
+ * only rebuilt by ANALYZE. Bucket i holds the keys in (bounds[i - 1], bounds[i]]
+ * and has counts[i] entries.
+ */
+class IndexStatistics {
+public:
+  static constexpr uint32_t HISTOGRAM_BUCKETS = 8;
+
+  uint32_t SerializeTo(char *buf, Schema *key_schema) const;
+
+  uint32_t GetSerializedSize(Schema *key_schema) const;
+
+  // return 0 and leave the statistics untouched if buf holds no statistics
+  uint32_t DeserializeFrom(char *buf, Schema *key_schema);
+
+  // estimated number of entries that share one key
+  uint64_t EstimateEqual() const;
+
+  // estimated number of entries in [lower, upper], a null bound is unbounded
+  uint64_t EstimateRange(const Row *lower, const Row *upper) const;
+
+  inline void OnInsert(uint64_t count, bool unique) {
+    entry_count_ += count;
+    if (unique) {
+      distinct_count_ += count;
+    }
+  }
+
+  inline void OnRemove(uint64_t count, bool unique) {
+    entry_count_ -= std::min(entry_count_, count);
+    if (unique || distinct_count_ > entry_count_) {
+      distinct_count_ = entry_count_;
+    }
+  }
+
+  inline uint64_t GetEntryCount() const { return entry_count_; }
+
+  inline uint64_t GetDistinctCount() const { return distinct_count_; }
+
+  inline uint32_t GetLeafCount() const { return leaf_count_; }
+
+  inline uint32_t GetHeight() const { return height_; }
+
+  inline float GetAverageFill() const { return avg_fill_; }
+
+  inline const std::vector<Row> &GetBounds() const { return bounds_; }
+
+  inline const std::vector<uint64_t> &GetCounts() const { return counts_; }
+
+private:
+  // ANALYZE fills in the shape and the histogram
+  template<typename KeyType, typename ValueType, typename KeyComparator>
+  friend class BPlusTreeIndex;
+
+  static constexpr uint32_t INDEX_STATISTICS_MAGIC_NUM = 271828;
+
+  uint64_t entry_count_{0};
+  uint64_t distinct_count_{0};
+  uint32_t leaf_count_{0};
+  uint32_t height_{0};
+  float avg_fill_{0};  /** entries per leaf slot, in [0, 1] */
+  std::vector<Row> bounds_;  /** largest key of each histogram bucket */
+  std::vector<uint64_t> counts_;  /** entries in each histogram bucket */
+};
+
+#endif  // MINISQL_INDEX_STATISTICS_H
@@ -13,13 +13,13 @@
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 24 bytes in total):
+ *  Header format (size in byte, 32 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | CurrentSize (4) | MaxSize (4) | ParentPageId (4) |
  *  ---------------------------------------------------------------------
- *  ------------------------------
- * | PageId (4) | NextPageId (4)
- *  ------------------------------
+ *  ---------------------------------------------
+ * | PageId (4) | NextPageId (4) | PrevPageId (4) |
+ *  ---------------------------------------------
  */
 #include <utility>
 #include <vector>
@@ -27,7 +27,7 @@
 #include "page/b_plus_tree_page.h"
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
+#define LEAF_PAGE_HEADER_SIZE 32
 #define LEAF_PAGE_SIZE (((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType)) - 1)
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -42,6 +42,10 @@ public:
 
   void SetNextPageId(page_id_t next_page_id);//link lists
 
+  page_id_t GetPrevPageId() const;
+
+  void SetPrevPageId(page_id_t prev_page_id);
+
   KeyType KeyAt(int index) const;
 
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
@@ -72,6 +76,7 @@ private:
   void CopyFirstFrom(const MappingType &item,BufferPoolManager *bufferpoolmanager,int index);
 
   page_id_t next_page_id_;
+  page_id_t prev_page_id_;
   MappingType array_[0];
 };
 
@@ -0,0 +1,118 @@
+#ifndef MINISQL_COLUMNAR_PAGE_H
+#define MINISQL_COLUMNAR_PAGE_H
+
+/**
+ * PAX page of a columnar table: the rows of the page are split into one minipage per column,
+ * so a scan reads only the minipages of the columns it needs.
+ *
+ * Format (size in byte):
+ *  -------------------------------------------------------------------------------------------
+ * | PageId (4) | LSN (4) | PrevPageId (4) | NextPageId (4) | SlotCount (4) | FreeSlotCount (4) |
+ *  -------------------------------------------------------------------------------------------
+ *  ------------------------------------------------------------
+ * | SlotStates (Capacity) | Minipage_1 | ... | Minipage_N |
+ *  ------------------------------------------------------------
+ *  Minipage format:
+ *  ----------------------------------------------------------
+ * | NullFlags (Capacity) | Value_1 | ... | Value_Capacity |
+ *  ----------------------------------------------------------
+ * Every slot has room for a whole row, so the capacity follows from the schema: INT and FLOAT values
+ * take 4 bytes, a CHAR value its length (4) and the column length. SlotCount is one past the last slot
+ * ever used. The header matches the one of TablePage up to NextPageId, so both pages chain the same way.
+ */
+
+#include <cstring>
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "page/page.h"
+#include "record/row.h"
+
+class ColumnarPage : public Page {
+public:
+  void Init(page_id_t page_id, page_id_t prev_id, Schema *schema);
+
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  page_id_t GetPrevPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_PREV_PAGE_ID); }
+
+  page_id_t GetNextPageId() { return *reinterpret_cast<page_id_t *>(GetData() + OFFSET_NEXT_PAGE_ID); }
+
+  void SetPrevPageId(page_id_t prev_page_id) {
+    memcpy(GetData() + OFFSET_PREV_PAGE_ID, &prev_page_id, sizeof(page_id_t));
+  }
+
+  void SetNextPageId(page_id_t next_page_id) {
+    memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
+  }
+
+  // rows a page of this schema holds, 0 if a single row does not fit
+  static uint32_t GetCapacity(Schema *schema);
+
+  // bytes one slot takes over all minipages
+  static uint32_t GetSlotSize(Schema *schema);
+
+  // bytes stored for a value of the column
+  static uint32_t GetValueSize(const Column *column);
+
+  // false if a CHAR value is longer than its column, such a row never fits a slot
+  static bool Fits(const Row &row, Schema *schema);
+
+  uint32_t GetFreeSpaceRemaining(Schema *schema) { return GetFreeSlotCount() * GetSlotSize(schema); }
+
+  bool InsertTuple(Row &row, Schema *schema);
+
+  bool MarkDelete(const RowId &rid);
+
+  // values have a fixed place, so the update always happens in place unless a value is too long
+  bool UpdateTuple(const Row &new_row, const RowId &rid, Schema *schema);
+
+  void ApplyDelete(const RowId &rid);
+
+  void RollbackDelete(const RowId &rid);
+
+  bool GetTuple(Row *row, Schema *schema);
+
+  bool GetFirstTupleRid(RowId *first_rid);
+
+  bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
+
+  uint32_t GetSlotCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_SLOT_COUNT); }
+
+  // the slot holds a tuple that is not deleted
+  bool IsLive(uint32_t slot) { return SlotStates()[slot] == SLOT_LIVE; }
+
+  // null flags of the column, one byte per slot
+  const char *GetNullFlags(uint32_t column, Schema *schema) { return GetData() + MinipageOffset(column, schema); }
+
+  // values of the column, GetValueSize bytes per slot
+  const char *GetValues(uint32_t column, Schema *schema) {
+    return GetData() + MinipageOffset(column, schema) + GetCapacity(schema);
+  }
+
+  // write the tuple in the Row format, for readers of serialized tuples; buf must hold a page
+  uint32_t SerializeTuple(uint32_t slot, Schema *schema, char *buf);
+
+private:
+  uint32_t GetFreeSlotCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SLOT_COUNT); }
+
+  void SetSlotCount(uint32_t count) { memcpy(GetData() + OFFSET_SLOT_COUNT, &count, sizeof(uint32_t)); }
+
+  void SetFreeSlotCount(uint32_t count) { memcpy(GetData() + OFFSET_FREE_SLOT_COUNT, &count, sizeof(uint32_t)); }
+
+  uint8_t *SlotStates() { return reinterpret_cast<uint8_t *>(GetData() + SIZE_HEADER); }
+
+  uint32_t MinipageOffset(uint32_t column, Schema *schema);
+
+  void WriteTuple(const Row &row, uint32_t slot, Schema *schema);
+
+  static constexpr uint8_t SLOT_EMPTY = 0;
+  static constexpr uint8_t SLOT_LIVE = 1;
+  static constexpr uint8_t SLOT_DELETED = 2;  // marked deleted, the delete is applied later
+  static constexpr size_t SIZE_HEADER = 24;
+  static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
+  static constexpr size_t OFFSET_SLOT_COUNT = 16;
+  static constexpr size_t OFFSET_FREE_SLOT_COUNT = 20;
+};
+
+#endif  // MINISQL_COLUMNAR_PAGE_H
@@ -0,0 +1,85 @@
+#ifndef MINISQL_FREE_SPACE_MAP_PAGE_H
+#define MINISQL_FREE_SPACE_MAP_PAGE_H
+
+#include <algorithm>
+
+#include "common/config.h"
+
+/**
+ * A chain of free space map pages records the free bytes of every page of a
+ * table heap, rounded down to a category of CATEGORY_SIZE bytes.
+ *
+ * Format (size in byte):
+ *  ----------------------------------------------------------------------------------------------------------
+ * | NextPageId (4) | LastHeapPageId (4) | ZoneMapPageId (4) | EntryCount (4) | PageId_1 (4) | PageId_2 (4) |
+ *  ----------------------------------------------------------------------------------------------------------
+ *  ------------------------------------------------
+ * | ... | Category_1 (1) | Category_2 (1) | ... |
+ *  ------------------------------------------------
+ * The page ids take the first MAX_ENTRY_COUNT slots, the categories follow.
+ * LastHeapPageId and ZoneMapPageId, the first page of the zone map chain, are only kept on the first page.
+ */
+class FreeSpaceMapPage {
+public:
+  static constexpr uint32_t CATEGORY_SIZE = PAGE_SIZE / 64;
+  static constexpr uint32_t CATEGORY_COUNT = PAGE_SIZE / CATEGORY_SIZE;
+  static constexpr int MAX_ENTRY_COUNT = (PAGE_SIZE - 16) / (sizeof(page_id_t) + sizeof(uint8_t));
+
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    last_heap_page_id_ = INVALID_PAGE_ID;
+    zone_map_page_id_ = INVALID_PAGE_ID;
+    count_ = 0;
+  }
+
+  // category of a page with free_bytes free, the page holds at least category * CATEGORY_SIZE bytes
+  static inline uint8_t ToCategory(uint32_t free_bytes) {
+    return static_cast<uint8_t>(std::min(free_bytes / CATEGORY_SIZE, CATEGORY_COUNT - 1));
+  }
+
+  // smallest category whose pages surely hold size bytes
+  static inline uint32_t NeededCategory(uint32_t size) { return (size + CATEGORY_SIZE - 1) / CATEGORY_SIZE; }
+
+  // return the slot of the new entry, -1 if the page is full
+  inline int Append(page_id_t page_id, uint8_t category) {
+    if (count_ >= MAX_ENTRY_COUNT) {
+      return -1;
+    }
+    PageIds()[count_] = page_id;
+    Categories()[count_] = category;
+    return count_++;
+  }
+
+  inline page_id_t PageIdAt(int slot) { return PageIds()[slot]; }
+
+  inline uint8_t CategoryAt(int slot) { return Categories()[slot]; }
+
+  inline void SetCategory(int slot, uint8_t category) { Categories()[slot] = category; }
+
+  inline int GetEntryCount() const { return count_; }
+
+  inline page_id_t GetNextPageId() const { return next_page_id_; }
+
+  inline void SetNextPageId(page_id_t page_id) { next_page_id_ = page_id; }
+
+  inline page_id_t GetLastHeapPageId() const { return last_heap_page_id_; }
+
+  inline void SetLastHeapPageId(page_id_t page_id) { last_heap_page_id_ = page_id; }
+
+  inline page_id_t GetZoneMapPageId() const { return zone_map_page_id_; }
+
+  inline void SetZoneMapPageId(page_id_t page_id) { zone_map_page_id_ = page_id; }
+
+private:
+  inline page_id_t *PageIds() { return reinterpret_cast<page_id_t *>(data_); }
+
+  inline uint8_t *Categories() { return reinterpret_cast<uint8_t *>(data_ + MAX_ENTRY_COUNT * sizeof(page_id_t)); }
+
+  page_id_t next_page_id_;
+  page_id_t last_heap_page_id_;
+  page_id_t zone_map_page_id_;
+  int count_;
+  char data_[0];
+};
+
+#endif  // MINISQL_FREE_SPACE_MAP_PAGE_H
@@ -0,0 +1,70 @@
+#ifndef MINISQL_HASH_TABLE_BUCKET_PAGE_H
+#define MINISQL_HASH_TABLE_BUCKET_PAGE_H
+
+/**
+ * hash_table_bucket_page.h
+ *
+ * Bucket of an extendible hash index. Entries are unordered and keep the hash
+ * of their key, so a split never has to rebuild a key and most mismatches are
+ * rejected without calling the comparator. A bucket that can not be split any
+ * more(all its keys hash alike, or the directory is at its max depth) chains
+ * overflow pages through NextPageId.
+ *
+ * Format (size in byte):
+ *  --------------------------------------------------------------------------
+ * | Size (4) | NextPageId (4) | HASH(1) + KEY(1) + RID(1) | ... | HASH(n) ...
+ *  --------------------------------------------------------------------------
+ */
+#include "page/b_plus_tree_page.h"
+
+#define HASH_TABLE_BUCKET_PAGE_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
+#define HASH_BUCKET_PAGE_HEADER_SIZE 8
+
+INDEX_TEMPLATE_ARGUMENTS
+class HashTableBucketPage {
+public:
+  struct Entry {
+    uint32_t hash_;
+    KeyType key_;
+    ValueType value_;
+  };
+
+  static constexpr int BUCKET_SIZE = (PAGE_SIZE - HASH_BUCKET_PAGE_HEADER_SIZE) / sizeof(Entry);
+
+  void Init() {
+    size_ = 0;
+    next_page_id_ = INVALID_PAGE_ID;
+  }
+
+  int GetSize() const { return size_; }
+
+  bool IsFull() const { return size_ >= BUCKET_SIZE; }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  const Entry &GetEntry(int index) const { return array_[index]; }
+
+  void Append(uint32_t hash, const KeyType &key, const ValueType &value);
+
+  // remove the entry at index, the last entry takes its place
+  void RemoveAt(int index);
+
+  // collect the values of every entry equal to key, return the number found
+  int GetValues(uint32_t hash, const KeyType &key, const KeyComparator &comparator,
+                std::vector<ValueType> &result) const;
+
+  // index of the entry equal to key with this value, -1 if there is none
+  int Find(uint32_t hash, const KeyType &key, const ValueType &value, const KeyComparator &comparator) const;
+
+  // true if every entry has this hash
+  bool AllHashEqual(uint32_t hash) const;
+
+private:
+  int size_;
+  page_id_t next_page_id_;
+  Entry array_[0];
+};
+
+#endif  // MINISQL_HASH_TABLE_BUCKET_PAGE_H
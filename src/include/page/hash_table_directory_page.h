@@ -0,0 +1,66 @@
+#ifndef MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
+#define MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
+
+#include "common/config.h"
+
+/**
+ * hash_table_directory_page.h
+ *
+ * Directory of an extendible hash index. The low global_depth bits of a key's
+ * hash select a slot, every slot points to a bucket page and records the local
+ * depth of that bucket. Slots whose low local_depth bits agree share a bucket.
+ *
+ * Format (size in byte):
+ *  -------------------------------------------------------------------------
+ * | PageId (4) | GlobalDepth (4) | EntryCount (4) | LocalDepths (512) |
+ *  -------------------------------------------------------------------------
+ *  ---------------------------
+ * | BucketPageIds (4 * 512) |
+ *  ---------------------------
+ */
+class HashTableDirectoryPage {
+public:
+  void Init(page_id_t page_id, page_id_t bucket_page_id);
+
+  page_id_t GetPageId() const { return page_id_; }
+
+  uint32_t GetGlobalDepth() const { return global_depth_; }
+
+  uint32_t GetGlobalDepthMask() const { return (1U << global_depth_) - 1; }
+
+  // number of slots in use
+  uint32_t Size() const { return 1U << global_depth_; }
+
+  bool CanIncrGlobalDepth() const { return global_depth_ < MAX_DEPTH; }
+
+  // double the directory, the new upper half mirrors the lower half
+  void IncrGlobalDepth();
+
+  page_id_t GetBucketPageId(uint32_t slot) const { return bucket_page_ids_[slot]; }
+
+  void SetBucketPageId(uint32_t slot, page_id_t bucket_page_id) { bucket_page_ids_[slot] = bucket_page_id; }
+
+  uint32_t GetLocalDepth(uint32_t slot) const { return local_depths_[slot]; }
+
+  void SetLocalDepth(uint32_t slot, uint32_t local_depth) { local_depths_[slot] = local_depth; }
+
+  // number of entries in the whole index
+  uint32_t GetEntryCount() const { return entry_count_; }
+
+  void SetEntryCount(uint32_t entry_count) { entry_count_ = entry_count; }
+
+  static constexpr uint32_t MAX_DEPTH = 9;
+
+  static constexpr uint32_t DIRECTORY_ARRAY_SIZE = 1U << MAX_DEPTH;
+
+private:
+  page_id_t page_id_;
+  uint32_t global_depth_;
+  uint32_t entry_count_;
+  uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
+  page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+};
+
+static_assert(sizeof(HashTableDirectoryPage) <= PAGE_SIZE, "Hash directory does not fit in a page.");
+
+#endif  // MINISQL_HASH_TABLE_DIRECTORY_PAGE_H
@@ -5,6 +5,8 @@
 
 #include "common/config.h"
 
+class BufferPoolManager;
+
 /**
  * Database use the one as index roots page page to store all
  * index's root page id
@@ -31,6 +33,15 @@ public:
 
   int GetIndexCount() { return count_; }
 
+  /**
+   * Set the root id of the index in the roots page of the buffer pool, adding the index if it is not there.
+   * Indexes built on several threads share the page, so the write holds the page write latch.
+   */
+  static void WriteRootId(BufferPoolManager *buffer_pool_manager, index_id_t index_id, page_id_t root_id);
+
+  // remove the index from the roots page of the buffer pool under the page write latch
+  static void EraseRootId(BufferPoolManager *buffer_pool_manager, index_id_t index_id);
+
 private:
   static constexpr int MAX_INDEX_COUNT = (PAGE_SIZE - 4) / 8;
 
@@ -0,0 +1,41 @@
+#ifndef MINISQL_OVERFLOW_PAGE_H
+#define MINISQL_OVERFLOW_PAGE_H
+
+#include <cstring>
+
+#include "common/config.h"
+
+/**
+ * A chain of overflow pages holds one CHAR value that was moved out of its row.
+ * The row keeps the length of the value and the id of the first page.
+ *
+ * Format (size in byte):
+ *  ------------------------------------------------
+ * | NextPageId (4) | DataSize (4) | Data (...) |
+ *  ------------------------------------------------
+ */
+class OverflowPage {
+public:
+  static constexpr uint32_t MAX_DATA_SIZE = PAGE_SIZE - sizeof(page_id_t) - sizeof(uint32_t);
+
+  void Init(const char *data, uint32_t size) {
+    next_page_id_ = INVALID_PAGE_ID;
+    size_ = size;
+    memcpy(data_, data, size);
+  }
+
+  inline page_id_t GetNextPageId() const { return next_page_id_; }
+
+  inline void SetNextPageId(page_id_t page_id) { next_page_id_ = page_id; }
+
+  inline uint32_t GetDataSize() const { return size_; }
+
+  inline const char *GetData() const { return data_; }
+
+private:
+  page_id_t next_page_id_;
+  uint32_t size_;
+  char data_[0];
+};
+
+#endif  // MINISQL_OVERFLOW_PAGE_H
@@ -22,12 +22,14 @@
 #include "common/rowid.h"
 #include "page/page.h"
 #include "record/row.h"
+#include "record/tuple_view.h"
 #include "transaction/lock_manager.h"
 #include "transaction/log_manager.h"
 #include "transaction/transaction.h"
 class TablePage : public Page {
 public:
   friend class TableHeap;
+  friend class TableBatchIterator;
   void Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr, Transaction *txn);
 
   page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
@@ -46,6 +48,9 @@ public:
 
   bool InsertTuple(Row &row, Schema *schema, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
 
+  // put the row in a new slot after the last one, without looking for a free slot
+  bool AppendTuple(Row &row, uint32_t serialized_size, Schema *schema);
+
   bool MarkDelete(const RowId &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
 
   bool UpdateTuple(const Row &new_row, Row *old_row, Schema *schema,
@@ -57,8 +62,19 @@ public:
 
   bool GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager *lock_manager);
 
+  // view the tuple in place, the view is valid while the page stays pinned; false if the slot holds no tuple
+  bool GetTupleView(uint32_t slot_num, Schema *schema, TupleView *view);
+
   bool GetFirstTupleRid(RowId *first_rid);
 
+  // move tuples from the last slots into empty slots before them and drop the empty slots at the end,
+  // every move is added to moves as (old slot, new slot)
+  void CompactSlots(std::vector<std::pair<uint32_t, uint32_t>> *moves);
+
+  // move every tuple of this page to new slots of dest, as (old slot, new slot) pairs in moves;
+  // nothing moves and false is returned if they do not all fit or a delete waits for commit here
+  bool MergeInto(TablePage *dest, std::vector<std::pair<uint32_t, uint32_t>> *moves);
+
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
 
 private:
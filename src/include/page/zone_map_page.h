@@ -0,0 +1,141 @@
+#ifndef MINISQL_ZONE_MAP_PAGE_H
+#define MINISQL_ZONE_MAP_PAGE_H
+
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include "common/config.h"
+#include "record/field.h"
+
+/**
+ * Min, max and null count of the values of one INT or FLOAT column on one table page.
+ * A zone is widened when values are added and never narrowed by deletes, so every value of the page
+ * lies within it. A zone without values has min above max, so every range check on it fails.
+ */
+struct ColumnZone {
+  union Value {
+    int32_t integer;
+    float real;
+  };
+
+  Value min;
+  Value max;
+  uint32_t null_count;
+
+  static ColumnZone Empty(TypeId type) {
+    ColumnZone zone;
+    if (type == TypeId::kTypeFloat) {
+      zone.min.real = std::numeric_limits<float>::infinity();
+      zone.max.real = -std::numeric_limits<float>::infinity();
+    } else {
+      zone.min.integer = std::numeric_limits<int32_t>::max();
+      zone.max.integer = std::numeric_limits<int32_t>::min();
+    }
+    zone.null_count = 0;
+    return zone;
+  }
+
+  // widen the zone to hold the value, return true if it changed
+  bool Widen(const Field &field) {
+    if (field.IsNull()) {
+      null_count++;
+      return true;
+    }
+    if (field.GetType() == TypeId::kTypeFloat) {
+      return WidenValue(field.GetFloat(), &min.real, &max.real);
+    }
+    return WidenValue(field.GetInteger(), &min.integer, &max.integer);
+  }
+
+  // false only if no value v of the zone satisfies "v op constant", op is one of = <> < <= > >=
+  bool MayMatch(const std::string &op, int32_t constant) const { return MayMatch(op, constant, min.integer, max.integer); }
+
+  bool MayMatch(const std::string &op, float constant) const { return MayMatch(op, constant, min.real, max.real); }
+
+private:
+  template <typename T>
+  static bool WidenValue(T value, T *low, T *high) {
+    bool changed = false;
+    if (value < *low) {
+      *low = value;
+      changed = true;
+    }
+    if (value > *high) {
+      *high = value;
+      changed = true;
+    }
+    return changed;
+  }
+
+  template <typename T>
+  static bool MayMatch(const std::string &op, T constant, T low, T high) {
+    if (op == "=") {
+      return low <= constant && constant <= high;
+    }
+    if (op == "<>") {
+      return !(low == constant && high == constant);
+    }
+    if (op == "<") {
+      return low < constant;
+    }
+    if (op == "<=") {
+      return low <= constant;
+    }
+    if (op == ">") {
+      return high > constant;
+    }
+    if (op == ">=") {
+      return high >= constant;
+    }
+    return true;
+  }
+};
+
+/**
+ * A chain of zone map pages keeps the zones of the INT and FLOAT columns of every page of a table heap.
+ * Entries follow the order of the free space map, so both maps find a page at the same index.
+ *
+ * Format (size in byte):
+ *  ---------------------------------------------------------------
+ * | NextPageId (4) | EntryCount (4) | Entry_1 | Entry_2 | ... |
+ *  ---------------------------------------------------------------
+ * An entry is one ColumnZone (12) per tracked column.
+ */
+class ZoneMapPage {
+public:
+  static inline int MaxEntryCount(uint32_t column_count) {
+    return (PAGE_SIZE - sizeof(page_id_t) - sizeof(int)) / (column_count * sizeof(ColumnZone));
+  }
+
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    count_ = 0;
+  }
+
+  // return the slot of the new entry, -1 if the page is full
+  inline int Append(const ColumnZone *zones, uint32_t column_count) {
+    if (count_ >= MaxEntryCount(column_count)) {
+      return -1;
+    }
+    memcpy(ZonesAt(count_, column_count), zones, column_count * sizeof(ColumnZone));
+    return count_++;
+  }
+
+  inline ColumnZone *ZonesAt(int slot, uint32_t column_count) {
+    return reinterpret_cast<ColumnZone *>(data_) + slot * column_count;
+  }
+
+  inline int GetEntryCount() const { return count_; }
+
+  inline page_id_t GetNextPageId() const { return next_page_id_; }
+
+  inline void SetNextPageId(page_id_t page_id) { next_page_id_ = page_id; }
+
+private:
+  page_id_t next_page_id_;
+  int count_;
+  char data_[0];
+};
+
+#endif  // MINISQL_ZONE_MAP_PAGE_H
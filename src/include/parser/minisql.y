@@ -1,5 +1,6 @@
 %{
   #include <stdio.h>
+  #include <strings.h>
   #include "parser/parser.h"
 
   extern char *yytext;
@@ -7,6 +8,8 @@
   int yyerror(char* error);
 %}
 
+%define api.header.include {"parser/minisql_yacc.h"}
+
 %union {
 	pSyntaxNode syntax_node;
 }
@@ -27,7 +30,7 @@
 %type <syntax_node> sql_select select_columns column_values column_value operator
 %type <syntax_node> connector where_conditions where_condition
 %type <syntax_node> sql_insert sql_delete sql_update update_values update_value
-%type <syntax_node> sql_quit sql_exec_file
+%type <syntax_node> sql_quit sql_exec_file sql_analyze
 
 %%
 
@@ -58,6 +61,7 @@ sql:
   | sql_trx_rollback { $$ = $1; }
   | sql_quit { $$ = $1; }
   | sql_exec_file { $$ = $1; }
+  | sql_analyze { $$ = $1; }
   ;
 
 sql_create_database:
@@ -101,6 +105,20 @@ sql_create_table:
     SyntaxNodeAddChildren($$, $3);
     SyntaxNodeAddChildren($$, list_node);
   }
+  | CREATE TABLE IDENTIFIER '(' column_definition_list ')' IDENTIFIER '(' IDENTIFIER EQ IDENTIFIER ')' {
+    if (strcasecmp($7->val_, "with") != 0 || strcasecmp($9->val_, "layout") != 0) {
+      yyerror("syntax error");
+      YYABORT;
+    }
+    $$ = CreateSyntaxNode(kNodeCreateTable, NULL);
+    pSyntaxNode list_node = CreateSyntaxNode(kNodeColumnDefinitionList, NULL);
+    SyntaxNodeAddChildren(list_node, $5);
+    SyntaxNodeAddChildren($$, $3);
+    SyntaxNodeAddChildren($$, list_node);
+    pSyntaxNode layout_node = CreateSyntaxNode(kNodeTableLayout, "table layout");
+    SyntaxNodeAddChildren(layout_node, $11);
+    SyntaxNodeAddChildren($$, layout_node);
+  }
   ;
 
 column_list:
@@ -180,6 +198,21 @@ sql_create_index:
       SyntaxNodeAddChildren(index_type_node, $10);
       SyntaxNodeAddChildren($$, index_type_node);
   }
+  | CREATE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' IDENTIFIER '(' column_list ')' {
+      if (strcasecmp($9->val_, "include") != 0) {
+        yyerror("syntax error");
+        YYABORT;
+      }
+      $$ = CreateSyntaxNode(kNodeCreateIndex, NULL);
+      SyntaxNodeAddChildren($$, $3);
+      SyntaxNodeAddChildren($$, $5);
+      pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
+      SyntaxNodeAddChildren(index_keys_node, $7);
+      SyntaxNodeAddChildren($$, index_keys_node);
+      pSyntaxNode include_node = CreateSyntaxNode(kNodeColumnList, "include columns");
+      SyntaxNodeAddChildren(include_node, $11);
+      SyntaxNodeAddChildren($$, include_node);
+  }
   ;
 
 sql_drop_index:
@@ -393,6 +426,20 @@ sql_exec_file:
   }
   ;
 
+sql_analyze:
+  IDENTIFIER IDENTIFIER {
+    if (strcasecmp($1->val_, "analyze") == 0) {
+      $$ = CreateSyntaxNode(kNodeAnalyze, NULL);
+    } else if (strcasecmp($1->val_, "vacuum") == 0) {
+      $$ = CreateSyntaxNode(kNodeVacuum, NULL);
+    } else {
+      yyerror("syntax error");
+      YYABORT;
+    }
+    SyntaxNodeAddChildren($$, $2);
+  }
+  ;
+
 %%
 int yyerror(char* error) {
 	MinisqlParserSetError(error);
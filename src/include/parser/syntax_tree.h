@@ -43,7 +43,10 @@ typedef enum {
   kNodeIndexType, /** type of index */
   kNodeTrxBegin, /** begin transaction command */
   kNodeTrxCommit, /** commit transaction command */
-  kNodeTrxRollback /** rollback transaction command */
+  kNodeTrxRollback, /** rollback transaction command */
+  kNodeAnalyze, /** analyze command */
+  kNodeVacuum, /** vacuum command */
+  kNodeTableLayout /** layout option of create table */
 } SyntaxNodeType;
 
 /**
@@ -62,12 +62,20 @@ public:
         }
     }
 
+    // char kept in a chain of overflow pages, the field only holds the first page id
+    explicit Field(TypeId type, uint32_t len, page_id_t overflow_page_id)
+            : type_id_(type), len_(len), overflow_page_id_(overflow_page_id) {
+        ASSERT(type == TypeId::kTypeChar, "Invalid type.");
+        value_.chars_ = nullptr;
+    }
+
     // copy constructor
     explicit Field(const Field& other) {
         type_id_ = other.type_id_;
         len_ = other.len_;
         is_null_ = other.is_null_;
         manage_data_ = other.manage_data_;
+        overflow_page_id_ = other.overflow_page_id_;
         if (type_id_ == TypeId::kTypeChar && !is_null_ && manage_data_) {
             value_.chars_ = new char[len_];
             memcpy(value_.chars_, other.value_.chars_, len_);
@@ -87,6 +95,15 @@ public:
         return is_null_;
     }
 
+    // the value is in overflow pages and has not been fetched, GetData has nothing to read
+    inline bool IsExternal() const {
+        return overflow_page_id_ != INVALID_PAGE_ID;
+    }
+
+    inline page_id_t GetOverflowPageId() const {
+        return overflow_page_id_;
+    }
+
     inline uint32_t GetLength() const {
         return Type::GetInstance(type_id_)->GetLength(*this);
     }
@@ -155,6 +172,7 @@ public:
         std::swap(first.len_, second.len_);
         std::swap(first.is_null_, second.is_null_);
         std::swap(first.manage_data_, second.manage_data_);
+        std::swap(first.overflow_page_id_, second.overflow_page_id_);
     }
 protected:
     union Val {
@@ -166,6 +184,7 @@ protected:
     uint32_t len_;
     bool is_null_{ false };
     bool manage_data_{ false };
+    page_id_t overflow_page_id_{ INVALID_PAGE_ID };
 };
 
 
@@ -0,0 +1,61 @@
+#ifndef MINISQL_TUPLE_VIEW_H
+#define MINISQL_TUPLE_VIEW_H
+
+#include "record/row.h"
+
+/**
+ * Read only view of a tuple serialized in the Row format, usually straight in a pinned page.
+ * Fields are found by walking the tuple on demand, nothing is copied or allocated. The view is only
+ * valid while the page stays pinned; Materialize into a Row to keep a tuple longer.
+ * Reading columns in ascending order walks the tuple once in total.
+ * A CHAR value kept in overflow pages is external: the view only sees its length and first page.
+ */
+class TupleView {
+public:
+  TupleView() = default;
+
+  TupleView(const char *buf, Schema *schema) : buf_(buf), schema_(schema) { Rewind(); }
+
+  inline uint32_t GetFieldCount() const { return MACH_READ_UINT32(buf_); }
+
+  inline bool IsNull(uint32_t i) const {
+    return i >= GetFieldCount() || MACH_READ_FROM(bool, buf_ + sizeof(uint32_t) + i);
+  }
+
+  inline int32_t GetInteger(uint32_t i) const { return MACH_READ_FROM(int32_t, FieldData(i)); }
+
+  inline float GetFloat(uint32_t i) const { return MACH_READ_FROM(float, FieldData(i)); }
+
+  // only for values that are not external
+  inline const char *GetChars(uint32_t i) const { return FieldData(i) + sizeof(uint32_t); }
+
+  inline uint32_t GetLength(uint32_t i) const { return MACH_READ_UINT32(FieldData(i)) & ~FIELD_OVERFLOW_FLAG; }
+
+  inline bool IsExternal(uint32_t i) const { return MACH_READ_UINT32(FieldData(i)) & FIELD_OVERFLOW_FLAG; }
+
+  inline page_id_t GetOverflowPageId(uint32_t i) const {
+    return MACH_READ_FROM(page_id_t, FieldData(i) + sizeof(uint32_t));
+  }
+
+  // field over the bytes of the view, it does not own its data; an external value stays external
+  Field GetField(uint32_t i) const;
+
+  // deserialize the whole tuple into row, which must have no fields yet
+  void Materialize(Row *row) const;
+
+private:
+  // position of the serialized value of column i, which must not be null
+  const char *FieldData(uint32_t i) const;
+
+  inline void Rewind() const {
+    cursor_column_ = 0;
+    cursor_data_ = buf_ + sizeof(uint32_t) + GetFieldCount() * sizeof(bool);
+  }
+
+  const char *buf_{nullptr};
+  Schema *schema_{nullptr};
+  mutable uint32_t cursor_column_{0};        // column the last walk stopped at
+  mutable const char *cursor_data_{nullptr};  // where the value of that column starts
+};
+
+#endif //MINISQL_TUPLE_VIEW_H
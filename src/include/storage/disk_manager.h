@@ -6,6 +6,7 @@
 #include <iostream>
 #include <mutex>
 #include <string>
+#include <vector>
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
@@ -48,6 +49,11 @@ public:
    */
   void DeAllocatePage(page_id_t logical_page_id);
 
+  /**
+   * Free several pages, the bitmap of each extent is read and written once
+   */
+  void DeAllocatePages(std::vector<page_id_t> logical_page_ids);
+
   /**
    * Return whether specific logical_page_id is free
    */
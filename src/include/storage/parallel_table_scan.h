@@ -0,0 +1,49 @@
+#ifndef MINISQL_PARALLEL_TABLE_SCAN_H
+#define MINISQL_PARALLEL_TABLE_SCAN_H
+
+#include <functional>
+#include <vector>
+
+#include "storage/table_batch_iterator.h"
+
+/**
+ * Morsel driven scan of a table heap.
+ * The pages of the table are cut into morsels of morsel_pages pages. Workers take the next morsel
+ * through an atomic cursor and scan it in column batches, so a slow morsel does not hold the others up.
+ */
+class ParallelTableScan {
+public:
+  ParallelTableScan(TableHeap *table_heap, std::vector<uint32_t> column_ids, Transaction *txn,
+                    uint32_t morsel_pages = TABLE_MORSEL_PAGES);
+
+  // scan only the given pages of the table, e.g. those left after checking zone maps, in that order
+  ParallelTableScan(TableHeap *table_heap, std::vector<uint32_t> column_ids, Transaction *txn,
+                    const std::vector<page_id_t> &page_ids, uint32_t morsel_pages = TABLE_MORSEL_PAGES);
+
+  inline uint32_t GetMorselCount() const { return morsels_.size(); }
+
+  /**
+   * Call func(batch, morsel) for every batch of every morsel. Morsels are numbered in page chain order,
+   * so callers that keep results per morsel can merge them back in table order.
+   * func runs on several threads at once, but never twice at the same time for one morsel.
+   * @param workers threads to use, 0 for one per hardware thread
+   */
+  void Run(const std::function<void(const RowBatch &, uint32_t)> &func, uint32_t workers = 0);
+
+  /**
+   * Call func(view, rid, morsel) for every tuple, in place in its pinned page and without decoding it.
+   * The view is only valid during the call. Threading is the same as for Run.
+   */
+  void RunTuples(const std::function<void(const TupleView &, const RowId &, uint32_t)> &func, uint32_t workers = 0);
+
+private:
+  // hand the morsels out to workers threads, the calling thread is one of them
+  void Dispatch(const std::function<void(uint32_t)> &scan_morsel, uint32_t workers);
+
+  TableHeap *table_heap_;
+  std::vector<uint32_t> column_ids_;
+  Transaction *txn_;
+  std::vector<std::vector<page_id_t>> morsels_;
+};
+
+#endif //MINISQL_PARALLEL_TABLE_SCAN_H
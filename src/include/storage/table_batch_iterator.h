@@ -0,0 +1,130 @@
+#ifndef MINISQL_TABLE_BATCH_ITERATOR_H
+#define MINISQL_TABLE_BATCH_ITERATOR_H
+
+#include <vector>
+
+#include "common/config.h"
+#include "common/rowid.h"
+#include "page/columnar_page.h"
+#include "record/field.h"
+#include "record/tuple_view.h"
+#include "transaction/transaction.h"
+
+class TableHeap;
+
+/**
+ * Values of one column over a batch of tuples.
+ * INT and FLOAT values sit in fixed width arrays, CHAR values are packed one after another and
+ * located by offsets. A null takes a zero value and an empty string so positions stay aligned.
+ */
+class ColumnVector {
+public:
+  explicit ColumnVector(TypeId type) : type_(type) {}
+
+  void Clear();
+
+  void AppendNull();
+
+  void AppendInteger(int32_t value);
+
+  void AppendFloat(float value);
+
+  void AppendChars(const char *data, uint32_t len);
+
+  inline TypeId GetType() const { return type_; }
+
+  inline uint32_t GetSize() const { return size_; }
+
+  inline bool IsNull(uint32_t i) const { return (nulls_[i / 64] >> (i % 64)) & 1; }
+
+  inline int32_t GetInteger(uint32_t i) const { return integers_[i]; }
+
+  inline float GetFloat(uint32_t i) const { return floats_[i]; }
+
+  // all values of an INT column, for tight loops over the batch
+  inline const int32_t *GetIntegers() const { return integers_.data(); }
+
+  // all values of a FLOAT column
+  inline const float *GetFloats() const { return floats_.data(); }
+
+  inline const char *GetChars(uint32_t i) const { return chars_.data() + offsets_[i]; }
+
+  inline uint32_t GetLength(uint32_t i) const { return offsets_[i + 1] - offsets_[i]; }
+
+  // copy the i-th value out as a field that owns its data
+  Field GetField(uint32_t i) const;
+
+private:
+  void SetNull(bool is_null);
+
+  TypeId type_;
+  uint32_t size_{0};
+  std::vector<uint64_t> nulls_;     // null bitmap, bit i is set if value i is null
+  std::vector<int32_t> integers_;
+  std::vector<float> floats_;
+  std::vector<uint32_t> offsets_{0};  // value i of a CHAR column is chars_[offsets_[i], offsets_[i + 1])
+  std::vector<char> chars_;
+};
+
+/**
+ * Tuples of a batch, column by column, for the columns the scan projects.
+ */
+class RowBatch {
+  friend class TableBatchIterator;
+
+public:
+  inline uint32_t GetSize() const { return row_ids_.size(); }
+
+  inline const RowId &GetRowId(uint32_t i) const { return row_ids_[i]; }
+
+  // the i-th projected column, in the order the columns were asked for
+  inline const ColumnVector &GetColumn(uint32_t i) const { return columns_[i]; }
+
+  inline uint32_t GetColumnCount() const { return columns_.size(); }
+
+private:
+  std::vector<RowId> row_ids_;
+  std::vector<ColumnVector> columns_;
+};
+
+/**
+ * Scans a table heap in batches of up to batch_size tuples.
+ * Each page is pinned and latched once per batch, and only the projected columns are decoded,
+ * straight from the page into the column vectors; on a columnar table only their minipages are read.
+ * column_ids must not repeat a column.
+ */
+class TableBatchIterator {
+public:
+  TableBatchIterator(TableHeap *table_heap, std::vector<uint32_t> column_ids, Transaction *txn,
+                     uint32_t batch_size = TABLE_BATCH_SIZE);
+
+  // scan only the given pages of the table, in that order, instead of the whole page chain
+  TableBatchIterator(TableHeap *table_heap, std::vector<uint32_t> column_ids, Transaction *txn,
+                     std::vector<page_id_t> page_ids, uint32_t batch_size = TABLE_BATCH_SIZE);
+
+  /**
+   * Fill batch with the next tuples of the table.
+   * @return false if the scan is over, the batch is empty then
+   */
+  bool Next(RowBatch *batch);
+
+private:
+  // decode the projected columns of a tuple
+  void AppendTuple(const TupleView &view, RowBatch *batch);
+
+  // copy the live slots of a columnar page from slot_ on, one projected minipage after another
+  void AppendMinipages(ColumnarPage *page, uint32_t slot_count, RowBatch *batch);
+
+  TableHeap *table_heap_;
+  std::vector<uint32_t> column_ids_;
+  std::vector<int> projection_;  // position of each table column in the batch, -1 if not projected
+  [[maybe_unused]] Transaction *txn_;
+  uint32_t batch_size_;
+  page_id_t page_id_;  // page the scan goes on from
+  uint32_t slot_{0};   // first slot of that page not read yet
+  bool follow_chain_;  // false if the scan only reads page_ids_
+  std::vector<page_id_t> page_ids_;
+  size_t page_index_{0};  // next page of page_ids_ to read
+};
+
+#endif //MINISQL_TABLE_BATCH_ITERATOR_H
@@ -1,8 +1,15 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <set>
+#include <unordered_map>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "page/columnar_page.h"
+#include "page/free_space_map_page.h"
 #include "page/table_page.h"
+#include "page/zone_map_page.h"
 #include "storage/table_iterator.h"
 #include "transaction/log_manager.h"
 #include "transaction/lock_manager.h"
@@ -10,34 +17,55 @@
 //ͬҳ֮ͨ˫
 //RowId¼˸ü¼ҳslot_numڶλ¼ڸҳе±λ
 
+/**
+ * How a table heap stores its tuples: whole rows in slotted pages, or one minipage per column in PAX pages.
+ */
+enum TableLayout : uint32_t { kLayoutRow = 0, kLayoutColumnar };
+
 class TableHeap {
   friend class TableIterator;
+  friend class TableBatchIterator;
+  friend class ParallelTableScan;
 
 public:
   static TableHeap *Create(BufferPoolManager *buffer_pool_manager, Schema *schema, Transaction *txn,
-                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap) {
+                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap,
+                           TableLayout layout = kLayoutRow) {
 
 
     void *buf = heap->Allocate(sizeof(TableHeap));
-    return new(buf) TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
+    return new(buf) TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager, layout);
   }
 
-  static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                           LogManager *log_manager, LockManager *lock_manager, MemHeap *heap) {
+  static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, page_id_t fsm_page_id,
+                           Schema *schema, LogManager *log_manager, LockManager *lock_manager, MemHeap *heap,
+                           TableLayout layout = kLayoutRow) {
     void *buf = heap->Allocate(sizeof(TableHeap));
-    return new(buf) TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+    return new(buf) TableHeap(buffer_pool_manager, first_page_id, fsm_page_id, schema, log_manager, lock_manager,
+                              layout);
   }
 
   ~TableHeap() {}
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Insert a tuple into the table. If the row is larger than TOAST_ROW_THRESHOLD, its longest CHAR values go
+   * to overflow pages first. If the tuple is still too large (>= page_size), return false.
+   * A columnar table keeps every value in its page and rejects CHAR values longer than their column.
    * @param[in/out] row Tuple Row to insert, the rid of the inserted tuple is wrapped in object row
    * @param[in] txn The transaction performing the insert
    * @return true iff the insert is successful
    */
   bool InsertTuple(Row &row, Transaction *txn);
 
+  /**
+   * Append rows after the last tuple of the table, for bulk loads. Rows fill the last page, then new pages
+   * linked after it; each page is pinned and latched once and the free space map is not searched.
+   * @param[in/out] rows Rows to append, the rid of every appended row is wrapped in it
+   * @param[in] txn The transaction performing the append
+   * @return false if some row is too large for a page, nothing is appended then
+   */
+  bool AppendBatch(std::vector<Row> &rows, Transaction *txn);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param[in] rid Resource id of the tuple of delete
@@ -47,8 +75,11 @@ public:
   bool MarkDelete(const RowId &rid, Transaction *txn);
 
   /**
-   * if the new tuple is too large to fit in the old page, return false (will delete and insert)
-   * @param[in] row Tuple of new row
+   * Update the tuple in its old slot when the new tuple fits in the old page, so the rid stays the same;
+   * a columnar table always updates in place.
+   * Otherwise the new tuple is inserted elsewhere and the old one marked deleted, or deleted at once when
+   * there is no transaction to commit the delete; row gets the new rid.
+   * @param[in] row Tuple of new row, its rid is set to where the tuple ends up
    * @param[in] rid Rid of the old tuple
    * @param[in] txn Transaction performing the update
    * @return true is update is successful.
@@ -77,11 +108,37 @@ public:
    */
   bool GetTuple(Row *row, Transaction *txn);
 
+  /**
+   * Read an external CHAR value out of its overflow pages, the field owns the value afterwards.
+   * Fields that are not external are left alone.
+   */
+  void FetchOverflow(Field *field);
+
+  /**
+   * Fetch every external field of row.
+   */
+  void FetchOverflow(Row *row);
+
   /**
    * Free table heap and release storage in disk file
    */
   void FreeHeap();
 
+  /**
+   * Compact the table: pack the slots of every page, merge each page into the one before it when its tuples
+   * fit there, and give the emptied pages back to the disk manager. Must not run alongside other access.
+   * Columnar pages reuse their fixed size slots already and are left alone.
+   * @param[out] moved (old rid, new rid) of every tuple that moved, for the caller to fix its indexes
+   * @param[in] txn Transaction performing the vacuum
+   * @return the number of pages freed
+   */
+  uint32_t Vacuum(std::vector<std::pair<RowId, RowId>> *moved, Transaction *txn);
+
+  /**
+   * @return true if the table has enough pages and enough of them is free that a vacuum pays off
+   */
+  bool NeedsVacuum() const;
+
   /**
    * @return the begin iterator of this table
    */
@@ -97,14 +154,37 @@ public:
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * @return how the table stores its tuples
+   */
+  inline TableLayout GetLayout() const { return layout_; }
+
+  /**
+   * @return the id of the first page of the free space map of this table
+   */
+  inline page_id_t GetFreeSpaceMapPageId() const { return fsm_pages_.front(); }
+
+  /**
+   * @return the ids of all pages of this table in chain order, read from the free space map
+   */
+  std::vector<page_id_t> GetPageIds() const;
+
+  /**
+   * Read the zone of a column on a page of the table. The first ZONE_MAP_MAX_COLUMNS INT and FLOAT columns
+   * have zones; they are widened on insert and update and only narrowed again by a vacuum.
+   * @return false if the column has no zone or the page is not in the table
+   */
+  bool GetZone(page_id_t page_id, uint32_t column_id, ColumnZone *zone) const;
+
 private:
   /**
    * create table heap and initialize first page
    */
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, Schema *schema, Transaction *txn,
-                     LogManager *log_manager, LockManager *lock_manager) :
+                     LogManager *log_manager, LockManager *lock_manager, TableLayout layout) :
           buffer_pool_manager_(buffer_pool_manager),
           schema_(schema),
+          layout_(layout),
           log_manager_(log_manager),
           lock_manager_(lock_manager) {
     //ASSERT(false, "Not implemented yet.");
@@ -114,28 +194,172 @@ private:
  
 
     //ʼһҳ
-    first_page->Init(first_page_id_,INVALID_PAGE_ID,log_manager, txn);
+    InitPage(first_page, first_page_id_, INVALID_PAGE_ID, txn);
+    uint32_t free_space = FreeSpaceOf(first_page);
     //һҳΪҳ
     buffer_pool_manager_->UnpinPage(first_page_id_, true);
+    CreateFreeSpaceMap();
+    SetFreeSpace(first_page_id_, free_space);
   };
 
   /**
    * load existing table heap by first_page_id
    */
-  explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                     LogManager *log_manager, LockManager *lock_manager)
+  explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, page_id_t fsm_page_id,
+                     Schema *schema, LogManager *log_manager, LockManager *lock_manager, TableLayout layout)
           : buffer_pool_manager_(buffer_pool_manager),
             first_page_id_(first_page_id),
             schema_(schema),
+            layout_(layout),
             log_manager_(log_manager),
-            lock_manager_(lock_manager) {}
-  
+            lock_manager_(lock_manager) {
+    LoadFreeSpaceMap(fsm_page_id);
+  }
+
+  /**
+   * initialize a new page of the table in the layout of the table; pages of both layouts share the chain
+   * header, so the chain is walked through TablePage either way
+   */
+  void InitPage(TablePage *page, page_id_t page_id, page_id_t prev_id, Transaction *txn);
+
+  /**
+   * insert the tuple into a page of the table
+   */
+  bool InsertIntoPage(TablePage *page, Row &row, Transaction *txn);
+
+  /**
+   * free bytes of a page of the table
+   */
+  uint32_t FreeSpaceOf(TablePage *page);
+
+  /**
+   * first live tuple of a page of the table
+   */
+  bool FirstTupleRid(TablePage *page, RowId *first_rid);
+
+  /**
+   * next live tuple after cur_rid in its page
+   */
+  bool NextTupleRid(TablePage *page, const RowId &cur_rid, RowId *next_rid);
+
+  /**
+   * allocate the first page of an empty free space map
+   */
+  void CreateFreeSpaceMap();
+
+  /**
+   * read the free space map chain starting at fsm_page_id into memory
+   */
+  void LoadFreeSpaceMap(page_id_t fsm_page_id);
+
+  /**
+   * record the free bytes of a table page, in memory and on its map page
+   */
+  void SetFreeSpace(page_id_t page_id, uint32_t free_space);
+
+  /**
+   * remember the new last page of the chain, in memory and on the first map page
+   */
+  void SetLastPageId(page_id_t page_id);
+
+  /**
+   * rewrite the free space map and the zone map for the given pages and free space, in chain order, keeping
+   * the first page of both; the zones are computed again from the tuples
+   */
+  void RebuildFreeSpaceMap(const std::vector<std::pair<page_id_t, uint32_t>> &pages);
+
+  /**
+   * pick the columns that get zones
+   */
+  void InitZoneColumns();
+
+  /**
+   * add empty zones for a new page at the end of the zone map
+   */
+  void AppendZone();
+
+  /**
+   * widen the zones of the page at index of the map with the values of row, in memory
+   * @return true if some zone changed
+   */
+  bool WidenZone(uint32_t index, const Row &row);
+
+  /**
+   * write the zones of the page at index of the map to their zone map page
+   */
+  void WriteZone(uint32_t index);
+
+  /**
+   * widen the zones of a page with row and write them if they changed
+   */
+  void UpdateZone(page_id_t page_id, const Row &row);
+
+  /**
+   * compute the zones of a row page again from its tuples
+   */
+  void RecomputeZone(page_id_t page_id);
+
+  /**
+   * columns whose CHAR values move to overflow pages, largest first, until the row is no larger than
+   * TOAST_ROW_THRESHOLD; size gets the stored size of the row after the move
+   */
+  std::vector<uint32_t> PlanOverflow(Row &row, uint32_t *size);
+
+  /**
+   * write the values of the given columns to overflow pages, return the row as stored with external fields
+   */
+  Row MoveToOverflow(Row &row, const std::vector<uint32_t> &columns);
+
+  /**
+   * write len bytes to a new chain of overflow pages, return its first page
+   */
+  page_id_t WriteOverflow(const char *data, uint32_t len);
+
+  /**
+   * read len bytes from the chain of overflow pages starting at page_id
+   */
+  void ReadOverflow(page_id_t page_id, uint32_t len, char *data);
+
+  /**
+   * add the first overflow page of every external value of the tuple in slot, even a deleted one
+   */
+  void CollectOverflow(TablePage *page, uint32_t slot, std::vector<page_id_t> *overflow);
+
+  /**
+   * add every page of the overflow chain starting at page_id
+   */
+  void CollectOverflowChain(page_id_t page_id, std::vector<page_id_t> *pages);
+
+  /**
+   * give a chain of overflow pages back to the disk manager
+   */
+  void FreeOverflow(page_id_t page_id);
+
+  /**
+   * free the overflow pages of every external field of row
+   */
+  void FreeOverflow(Row &row);
+
+  struct FreeSpaceSlot {
+    uint32_t index;   // entry number over the whole map chain
+    uint8_t category;
+  };
+
 private:
   BufferPoolManager *buffer_pool_manager_;
   page_id_t first_page_id_;//¼ҳ
   Schema *schema_;
+  TableLayout layout_;
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
+  page_id_t last_page_id_{INVALID_PAGE_ID};  // tail of the page chain, new pages link after it
+  std::vector<page_id_t> fsm_pages_;  // the free space map chain
+  std::unordered_map<page_id_t, FreeSpaceSlot> fsm_slots_;
+  std::vector<std::set<page_id_t>> free_pages_{FreeSpaceMapPage::CATEGORY_COUNT};  // table pages by category
+  std::vector<uint32_t> zone_columns_;  // columns with zones
+  std::vector<int> zone_positions_;     // position of each column in a zone map entry, -1 without a zone
+  std::vector<page_id_t> zone_pages_;   // the zone map chain, empty if no column has zones
+  std::vector<ColumnZone> zones_;       // zone_columns_.size() zones per page, in free space map order
 };
 
 #endif  // MINISQL_TABLE_HEAP_H
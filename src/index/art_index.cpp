@@ -0,0 +1,617 @@
+#include <algorithm>
+
+#include "index/art_index.h"
+
+ArtIndex::ArtIndex(index_id_t index_id, IndexSchema *key_schema, bool unique)
+        : Index(index_id, key_schema), unique_(unique), root_(nullptr), size_(0) {}
+
+ArtIndex::~ArtIndex() {
+  FreeNode(root_);
+}
+
+/*****************************************************************************
+ * KEY ENCODING
+ *****************************************************************************/
+namespace {
+
+void AppendBigEndian(std::string &out, uint64_t value, int bytes) {
+  for (int i = bytes - 1; i >= 0; i--) {
+    out.push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+  }
+}
+
+uint64_t ReadBigEndian(const std::string &data, size_t pos, int bytes) {
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; i++) {
+    value = (value << 8) | static_cast<uint8_t>(data[pos + i]);
+  }
+  return value;
+}
+
+}  // namespace
+
+void ArtIndex::EncodeKey(const Row &key, Schema *schema, std::string &out) {
+  ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
+  for (uint32_t i = 0; i < key.GetFieldCount(); i++) {
+    const Field *field = key.GetField(i);
+    // nulls sort first
+    if (field->IsNull()) {
+      out.push_back('\0');
+      continue;
+    }
+    out.push_back('\1');
+    switch (field->GetType()) {
+      case TypeId::kTypeInt:
+        AppendBigEndian(out, static_cast<uint32_t>(field->GetInteger()) ^ 0x80000000U, sizeof(int32_t));
+        break;
+      case TypeId::kTypeFloat: {
+        float value = field->GetFloat() == 0 ? 0 : field->GetFloat();
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        bits = (bits & 0x80000000U) ? ~bits : bits ^ 0x80000000U;
+        AppendBigEndian(out, bits, sizeof(uint32_t));
+        break;
+      }
+      case TypeId::kTypeChar: {
+        const char *chars = field->GetChars();
+        for (uint32_t j = 0; j < field->GetLength(); j++) {
+          out.push_back(chars[j]);
+          if (chars[j] == '\0') {
+            out.push_back('\xFF');
+          }
+        }
+        out.append(2, '\0');
+        break;
+      }
+      default:
+        ASSERT(false, "Unsupported key type.");
+    }
+  }
+}
+
+size_t ArtIndex::DecodeKey(const std::string &data, Schema *schema, std::vector<Field> &fields) {
+  size_t pos = 0;
+  for (auto column : schema->GetColumns()) {
+    if (data[pos++] == '\0') {
+      fields.emplace_back(column->GetType());
+      continue;
+    }
+    switch (column->GetType()) {
+      case TypeId::kTypeInt:
+        fields.emplace_back(TypeId::kTypeInt,
+                            static_cast<int32_t>(static_cast<uint32_t>(ReadBigEndian(data, pos, 4)) ^ 0x80000000U));
+        pos += sizeof(int32_t);
+        break;
+      case TypeId::kTypeFloat: {
+        auto bits = static_cast<uint32_t>(ReadBigEndian(data, pos, 4));
+        bits = (bits & 0x80000000U) ? bits ^ 0x80000000U : ~bits;
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        fields.emplace_back(TypeId::kTypeFloat, value);
+        pos += sizeof(uint32_t);
+        break;
+      }
+      case TypeId::kTypeChar: {
+        std::string chars;
+        while (!(data[pos] == '\0' && data[pos + 1] == '\0')) {
+          chars.push_back(data[pos]);
+          pos += data[pos] == '\0' ? 2 : 1;
+        }
+        pos += 2;
+        fields.emplace_back(TypeId::kTypeChar, const_cast<char *>(chars.data()), chars.size(), true);
+        break;
+      }
+      default:
+        ASSERT(false, "Unsupported key type.");
+    }
+  }
+  return pos;
+}
+
+void ArtIndex::MakeKey(const Row &key, RowId row_id, std::string &out) const {
+  EncodeKey(key, key_schema_, out);
+  if (!unique_) {
+    AppendBigEndian(out, static_cast<uint64_t>(row_id.Get()), sizeof(int64_t));
+  }
+}
+
+void ArtIndex::MakeBounds(const Row *lower, const Row *upper, std::string &lower_key, std::string &upper_key) const {
+  if (lower != nullptr) {
+    // a bare key sorts before every row id appended to it
+    EncodeKey(*lower, key_schema_, lower_key);
+  }
+  if (upper != nullptr) {
+    EncodeKey(*upper, key_schema_, upper_key);
+    if (!unique_) {
+      upper_key.append(sizeof(int64_t), '\xFF');
+    }
+  }
+}
+
+/*****************************************************************************
+ * NODES
+ *****************************************************************************/
+ArtIndex::Node **ArtIndex::FindChild(Node *node, uint8_t byte) {
+  switch (node->type_) {
+    case NodeType::kNode4: {
+      auto *n = static_cast<Node4 *>(node);
+      for (int i = 0; i < n->count_; i++) {
+        if (n->keys_[i] == byte) return &n->children_[i];
+      }
+      return nullptr;
+    }
+    case NodeType::kNode16: {
+      auto *n = static_cast<Node16 *>(node);
+      auto *it = std::lower_bound(n->keys_, n->keys_ + n->count_, byte);
+      if (it != n->keys_ + n->count_ && *it == byte) return &n->children_[it - n->keys_];
+      return nullptr;
+    }
+    case NodeType::kNode48: {
+      auto *n = static_cast<Node48 *>(node);
+      return n->child_index_[byte] ? &n->children_[n->child_index_[byte] - 1] : nullptr;
+    }
+    case NodeType::kNode256: {
+      auto *n = static_cast<Node256 *>(node);
+      return n->children_[byte] ? &n->children_[byte] : nullptr;
+    }
+    default:
+      return nullptr;
+  }
+}
+
+/*
+ * Insert child under byte, replacing node by the next larger node type if it is
+ * full
+ */
+void ArtIndex::AddChild(Node *&node, uint8_t byte, Node *child) {
+  switch (node->type_) {
+    case NodeType::kNode4:
+    case NodeType::kNode16: {
+      bool is4 = node->type_ == NodeType::kNode4;
+      uint8_t *keys = is4 ? static_cast<Node4 *>(node)->keys_ : static_cast<Node16 *>(node)->keys_;
+      Node **children = is4 ? static_cast<Node4 *>(node)->children_ : static_cast<Node16 *>(node)->children_;
+      int count = node->count_;
+      if (count < (is4 ? 4 : 16)) {
+        int pos = std::lower_bound(keys, keys + count, byte) - keys;
+        memmove(keys + pos + 1, keys + pos, count - pos);
+        memmove(children + pos + 1, children + pos, (count - pos) * sizeof(Node *));
+        keys[pos] = byte;
+        children[pos] = child;
+        node->count_++;
+        return;
+      }
+      if (is4) {
+        auto *grown = new Node16();
+        grown->prefix_ = std::move(node->prefix_);
+        grown->count_ = count;
+        memcpy(grown->keys_, keys, count);
+        memcpy(grown->children_, children, count * sizeof(Node *));
+        delete static_cast<Node4 *>(node);
+        node = grown;
+      } else {
+        auto *grown = new Node48();
+        grown->prefix_ = std::move(node->prefix_);
+        grown->count_ = count;
+        for (int i = 0; i < count; i++) {
+          grown->child_index_[keys[i]] = i + 1;
+          grown->children_[i] = children[i];
+        }
+        delete static_cast<Node16 *>(node);
+        node = grown;
+      }
+      AddChild(node, byte, child);
+      return;
+    }
+    case NodeType::kNode48: {
+      auto *n = static_cast<Node48 *>(node);
+      if (n->count_ < 48) {
+        n->children_[n->count_] = child;
+        n->child_index_[byte] = ++n->count_;
+        return;
+      }
+      auto *grown = new Node256();
+      grown->prefix_ = std::move(n->prefix_);
+      grown->count_ = n->count_;
+      for (int b = 0; b < 256; b++) {
+        if (n->child_index_[b]) grown->children_[b] = n->children_[n->child_index_[b] - 1];
+      }
+      delete n;
+      node = grown;
+      AddChild(node, byte, child);
+      return;
+    }
+    case NodeType::kNode256: {
+      auto *n = static_cast<Node256 *>(node);
+      n->children_[byte] = child;
+      n->count_++;
+      return;
+    }
+    default:
+      ASSERT(false, "Leaf has no children.");
+  }
+}
+
+/*
+ * Remove the child under byte, replacing node by the next smaller node type once
+ * it is sparse enough. A Node4 left with one child is merged into that child.
+ */
+void ArtIndex::RemoveChild(Node *&node, uint8_t byte) {
+  switch (node->type_) {
+    case NodeType::kNode4:
+    case NodeType::kNode16: {
+      bool is4 = node->type_ == NodeType::kNode4;
+      uint8_t *keys = is4 ? static_cast<Node4 *>(node)->keys_ : static_cast<Node16 *>(node)->keys_;
+      Node **children = is4 ? static_cast<Node4 *>(node)->children_ : static_cast<Node16 *>(node)->children_;
+      int pos = std::lower_bound(keys, keys + node->count_, byte) - keys;
+      memmove(keys + pos, keys + pos + 1, node->count_ - pos - 1);
+      memmove(children + pos, children + pos + 1, (node->count_ - pos - 1) * sizeof(Node *));
+      node->count_--;
+      if (is4 && node->count_ == 1) {
+        // path compression: the only child absorbs this node's prefix
+        Node *child = children[0];
+        if (child->type_ != NodeType::kLeaf) {
+          child->prefix_ = node->prefix_ + static_cast<char>(keys[0]) + child->prefix_;
+        }
+        delete static_cast<Node4 *>(node);
+        node = child;
+      } else if (!is4 && node->count_ <= 3) {
+        auto *shrunk = new Node4();
+        shrunk->prefix_ = std::move(node->prefix_);
+        shrunk->count_ = node->count_;
+        memcpy(shrunk->keys_, keys, node->count_);
+        memcpy(shrunk->children_, children, node->count_ * sizeof(Node *));
+        delete static_cast<Node16 *>(node);
+        node = shrunk;
+      }
+      return;
+    }
+    case NodeType::kNode48: {
+      auto *n = static_cast<Node48 *>(node);
+      int slot = n->child_index_[byte] - 1;
+      n->child_index_[byte] = 0;
+      // keep the slots dense by moving the last one into the hole
+      int last = n->count_ - 1;
+      if (slot != last) {
+        n->children_[slot] = n->children_[last];
+        for (int b = 0; b < 256; b++) {
+          if (n->child_index_[b] == last + 1) {
+            n->child_index_[b] = slot + 1;
+            break;
+          }
+        }
+      }
+      n->count_--;
+      if (n->count_ <= 12) {
+        auto *shrunk = new Node16();
+        shrunk->prefix_ = std::move(n->prefix_);
+        for (int b = 0; b < 256; b++) {
+          if (n->child_index_[b]) {
+            shrunk->keys_[shrunk->count_] = b;
+            shrunk->children_[shrunk->count_++] = n->children_[n->child_index_[b] - 1];
+          }
+        }
+        delete n;
+        node = shrunk;
+      }
+      return;
+    }
+    case NodeType::kNode256: {
+      auto *n = static_cast<Node256 *>(node);
+      n->children_[byte] = nullptr;
+      n->count_--;
+      if (n->count_ <= 37) {
+        auto *shrunk = new Node48();
+        shrunk->prefix_ = std::move(n->prefix_);
+        for (int b = 0; b < 256; b++) {
+          if (n->children_[b]) {
+            shrunk->children_[shrunk->count_] = n->children_[b];
+            shrunk->child_index_[b] = ++shrunk->count_;
+          }
+        }
+        delete n;
+        node = shrunk;
+      }
+      return;
+    }
+    default:
+      ASSERT(false, "Leaf has no children.");
+  }
+}
+
+void ArtIndex::FreeNode(Node *node) {
+  if (node == nullptr) {
+    return;
+  }
+  switch (node->type_) {
+    case NodeType::kLeaf:
+      delete static_cast<Leaf *>(node);
+      return;
+    case NodeType::kNode4: {
+      auto *n = static_cast<Node4 *>(node);
+      for (int i = 0; i < n->count_; i++) FreeNode(n->children_[i]);
+      delete n;
+      return;
+    }
+    case NodeType::kNode16: {
+      auto *n = static_cast<Node16 *>(node);
+      for (int i = 0; i < n->count_; i++) FreeNode(n->children_[i]);
+      delete n;
+      return;
+    }
+    case NodeType::kNode48: {
+      auto *n = static_cast<Node48 *>(node);
+      for (int i = 0; i < n->count_; i++) FreeNode(n->children_[i]);
+      delete n;
+      return;
+    }
+    case NodeType::kNode256: {
+      auto *n = static_cast<Node256 *>(node);
+      for (auto child : n->children_) FreeNode(child);
+      delete n;
+      return;
+    }
+  }
+}
+
+/*****************************************************************************
+ * TREE OPERATIONS
+ *****************************************************************************/
+bool ArtIndex::Insert(Node *&node, Leaf *leaf, size_t depth) {
+  const std::string &key = leaf->key_;
+  if (node == nullptr) {
+    node = leaf;
+    return true;
+  }
+  if (node->type_ == NodeType::kLeaf) {
+    const std::string &other = static_cast<Leaf *>(node)->key_;
+    if (other == key) {
+      return false;
+    }
+    // split the leaf with a Node4 holding the common part of both keys
+    size_t common = 0;
+    while (other[depth + common] == key[depth + common]) {
+      common++;
+    }
+    Node *inner = new Node4();
+    inner->prefix_ = key.substr(depth, common);
+    AddChild(inner, other[depth + common], node);
+    AddChild(inner, key[depth + common], leaf);
+    node = inner;
+    return true;
+  }
+  const std::string &prefix = node->prefix_;
+  size_t common = 0;
+  while (common < prefix.size() && prefix[common] == key[depth + common]) {
+    common++;
+  }
+  if (common < prefix.size()) {
+    // the key leaves the compressed path, split it
+    Node *inner = new Node4();
+    inner->prefix_ = prefix.substr(0, common);
+    uint8_t old_byte = prefix[common];
+    node->prefix_ = prefix.substr(common + 1);
+    AddChild(inner, old_byte, node);
+    AddChild(inner, key[depth + common], leaf);
+    node = inner;
+    return true;
+  }
+  depth += prefix.size();
+  Node **child = FindChild(node, key[depth]);
+  if (child != nullptr) {
+    return Insert(*child, leaf, depth + 1);
+  }
+  AddChild(node, key[depth], leaf);
+  return true;
+}
+
+bool ArtIndex::Remove(Node *&node, const std::string &key, size_t depth) {
+  if (node == nullptr) {
+    return false;
+  }
+  if (node->type_ == NodeType::kLeaf) {
+    if (static_cast<Leaf *>(node)->key_ != key) {
+      return false;
+    }
+    delete static_cast<Leaf *>(node);
+    node = nullptr;
+    return true;
+  }
+  if (key.compare(depth, node->prefix_.size(), node->prefix_) != 0) {
+    return false;
+  }
+  depth += node->prefix_.size();
+  Node **child = FindChild(node, key[depth]);
+  if (child == nullptr) {
+    return false;
+  }
+  if ((*child)->type_ == NodeType::kLeaf) {
+    if (static_cast<Leaf *>(*child)->key_ != key) {
+      return false;
+    }
+    delete static_cast<Leaf *>(*child);
+    RemoveChild(node, key[depth]);
+    return true;
+  }
+  return Remove(*child, key, depth + 1);
+}
+
+ArtIndex::Leaf *ArtIndex::Lookup(const std::string &key) const {
+  Node *node = root_;
+  size_t depth = 0;
+  while (node != nullptr) {
+    if (node->type_ == NodeType::kLeaf) {
+      auto *leaf = static_cast<Leaf *>(node);
+      return leaf->key_ == key ? leaf : nullptr;
+    }
+    if (key.compare(depth, node->prefix_.size(), node->prefix_) != 0) {
+      return nullptr;
+    }
+    depth += node->prefix_.size();
+    if (depth >= key.size()) {
+      return nullptr;
+    }
+    Node **child = FindChild(node, key[depth]);
+    node = child == nullptr ? nullptr : *child;
+    depth++;
+  }
+  return nullptr;
+}
+
+template<typename Visitor>
+bool ArtIndex::Scan(Node *node, std::string &path, const std::string *lower, const std::string *upper,
+                    Visitor &visit) const {
+  if (node->type_ == NodeType::kLeaf) {
+    auto *leaf = static_cast<Leaf *>(node);
+    if (upper != nullptr && leaf->key_ > *upper) {
+      return false;
+    }
+    if (lower != nullptr && leaf->key_ < *lower) {
+      return true;
+    }
+    return visit(leaf);
+  }
+  size_t old_size = path.size();
+  path += node->prefix_;
+  // every key below starts with path, skip the subtree if path is out of range
+  if (upper != nullptr && path.compare(0, path.size(), *upper, 0, path.size()) > 0) {
+    path.resize(old_size);
+    return false;
+  }
+  if (lower != nullptr && path.compare(0, path.size(), *lower, 0, path.size()) < 0) {
+    path.resize(old_size);
+    return true;
+  }
+  bool go_on = true;
+  auto visit_child = [&](uint8_t byte, Node *child) {
+    path.push_back(static_cast<char>(byte));
+    go_on = Scan(child, path, lower, upper, visit);
+    path.pop_back();
+  };
+  switch (node->type_) {
+    case NodeType::kNode4: {
+      auto *n = static_cast<Node4 *>(node);
+      for (int i = 0; i < n->count_ && go_on; i++) visit_child(n->keys_[i], n->children_[i]);
+      break;
+    }
+    case NodeType::kNode16: {
+      auto *n = static_cast<Node16 *>(node);
+      for (int i = 0; i < n->count_ && go_on; i++) visit_child(n->keys_[i], n->children_[i]);
+      break;
+    }
+    case NodeType::kNode48: {
+      auto *n = static_cast<Node48 *>(node);
+      for (int b = 0; b < 256 && go_on; b++) {
+        if (n->child_index_[b]) visit_child(b, n->children_[n->child_index_[b] - 1]);
+      }
+      break;
+    }
+    case NodeType::kNode256: {
+      auto *n = static_cast<Node256 *>(node);
+      for (int b = 0; b < 256 && go_on; b++) {
+        if (n->children_[b]) visit_child(b, n->children_[b]);
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  path.resize(old_size);
+  return go_on;
+}
+
+/*****************************************************************************
+ * INDEX INTERFACE
+ *****************************************************************************/
+dberr_t ArtIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+  ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
+  std::string encoded;
+  MakeKey(key, row_id, encoded);
+  auto *leaf = new Leaf(encoded, row_id);
+  if (!Insert(root_, leaf, 0)) {
+    delete leaf;
+    return DB_FAILED;
+  }
+  size_++;
+  return DB_SUCCESS;
+}
+
+dberr_t ArtIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+  std::string encoded;
+  MakeKey(key, row_id, encoded);
+  if (Remove(root_, encoded, 0)) {
+    size_--;
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t ArtIndex::InsertEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Transaction *txn) {
+  ASSERT(keys.size() == row_ids.size(), "Keys and row ids do not match.");
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (InsertEntry(keys[i], row_ids[i], txn) != DB_SUCCESS) {
+      return DB_FAILED;
+    }
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t ArtIndex::RemoveEntries(const std::vector<Row> &keys, const std::vector<RowId> &row_ids, Transaction *txn) {
+  ASSERT(keys.size() == row_ids.size(), "Keys and row ids do not match.");
+  for (size_t i = 0; i < keys.size(); i++) {
+    RemoveEntry(keys[i], row_ids[i], txn);
+  }
+  return DB_SUCCESS;
+}
+
+dberr_t ArtIndex::ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn) {
+  if (unique_) {
+    std::string encoded;
+    EncodeKey(key, key_schema_, encoded);
+    Leaf *leaf = Lookup(encoded);
+    if (leaf == nullptr) {
+      return DB_KEY_NOT_FOUND;
+    }
+    result.push_back(leaf->value_);
+    return DB_SUCCESS;
+  }
+  return ScanRange(&key, &key, result, txn);
+}
+
+dberr_t ArtIndex::ScanRange(const Row *lower, const Row *upper, std::vector<RowId> &result, Transaction *txn) {
+  if (root_ == nullptr) {
+    return DB_KEY_NOT_FOUND;
+  }
+  std::string lower_key, upper_key, path;
+  MakeBounds(lower, upper, lower_key, upper_key);
+  size_t old_size = result.size();
+  auto visit = [&result](Leaf *leaf) {
+    result.push_back(leaf->value_);
+    return true;
+  };
+  Scan(root_, path, lower == nullptr ? nullptr : &lower_key, upper == nullptr ? nullptr : &upper_key, visit);
+  return result.size() > old_size ? DB_SUCCESS : DB_KEY_NOT_FOUND;
+}
+
+dberr_t ArtIndex::ScanRangeEntries(const Row *lower, const Row *upper, std::vector<Row> &result, Transaction *txn) {
+  if (root_ == nullptr) {
+    return DB_KEY_NOT_FOUND;
+  }
+  std::string lower_key, upper_key, path;
+  MakeBounds(lower, upper, lower_key, upper_key);
+  size_t old_size = result.size();
+  auto visit = [this, &result](Leaf *leaf) {
+    std::vector<Field> fields;
+    DecodeKey(leaf->key_, key_schema_, fields);
+    result.emplace_back(fields);
+    result.back().SetRowId(leaf->value_);
+    return true;
+  };
+  Scan(root_, path, lower == nullptr ? nullptr : &lower_key, upper == nullptr ? nullptr : &upper_key, visit);
+  return result.size() > old_size ? DB_SUCCESS : DB_KEY_NOT_FOUND;
+}
+
+dberr_t ArtIndex::Destroy() {
+  FreeNode(root_);
+  root_ = nullptr;
+  size_ = 0;
+  return DB_SUCCESS;
+}
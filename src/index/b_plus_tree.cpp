@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <string>
 #include "glog/logging.h"
 #include "index/b_plus_tree.h"
@@ -16,7 +17,8 @@ BPLUSTREE_TYPE::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_ma
           buffer_pool_manager_(buffer_pool_manager),
           comparator_(comparator),
           leaf_max_size_(leaf_max_size),
-          internal_max_size_(internal_max_size) 
+          internal_max_size_(internal_max_size),
+          min_fill_(50)
 {    
      //Judge index_id exists.
     Page*p=buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
@@ -33,12 +35,41 @@ BPLUSTREE_TYPE::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_ma
         buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID,false);
 }
 
+/*
+ * Free every page of the tree. The tree is walked level by level, the child
+ * ids of one level come from the internal pages above it and leaves are never
+ * read. All pages are then freed in one batch.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::Destroy() 
 {
-     buffer_pool_manager_=NULL;
-     leaf_max_size_=internal_max_size_=0;
-     root_page_id_=INVALID_PAGE_ID;
+  if(!IsEmpty())
+  {
+    std::vector<page_id_t> pages;
+    std::vector<page_id_t> level{root_page_id_};
+    while(!level.empty())
+    {
+      pages.insert(pages.end(),level.begin(),level.end());
+      std::vector<page_id_t> next_level;
+      for(page_id_t page_id:level)
+      {
+        BPlusTreePage*node=reinterpret_cast<BPlusTreePage*>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+        if(node->IsLeafPage())//The whole level is leaves.
+        {
+          buffer_pool_manager_->UnpinPage(page_id,false);
+          break;
+        }
+        InternalPage*inner=reinterpret_cast<InternalPage*>(node);
+        for(int i=0;i<inner->GetSize();i++)
+          next_level.push_back(inner->ValueAt(i));
+        buffer_pool_manager_->UnpinPage(page_id,false);
+      }
+      level.swap(next_level);
+    }
+    buffer_pool_manager_->DeletePages(pages);
+    root_page_id_=INVALID_PAGE_ID;
+  }
+  IndexRootsPage::EraseRootId(buffer_pool_manager_,index_id_);
 }
 
 /*
@@ -62,6 +93,8 @@ INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> &result, Transaction *transaction) 
 //Transaction:Unused.
 {
+  if(IsEmpty())
+    return false;
   //Leaf page that POSSIBLY contains key.
   Page*P1=FindLeafPage(key);
   BPlusTreeLeafPage<KeyType,ValueType,KeyComparator>*bpt_lp= reinterpret_cast< BPlusTreeLeafPage<KeyType,ValueType,KeyComparator>*>(P1->GetData());
@@ -76,6 +109,50 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> &result
   return ans;
 }
 
+/*
+ * Collect the values of all keys between lower and upper(both inclusive), a
+ * null bound means the range is open on that side
+ * This method is used for range query and by non-unique indexes, where the
+ * same user key is stored once per row id.
+ * @return : true means at least one key is found
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::GetValueRange(const KeyType *lower, const KeyType *upper, std::vector<ValueType> &result,
+                                   Transaction *transaction, std::vector<KeyType> *keys) {
+  if(IsEmpty())
+    return false;
+  size_t old_size=result.size();
+  KeyType key;
+  Page*p=lower==nullptr?FindLeafPage(key,true):FindLeafPage(*lower);
+  LeafPage*leaf=reinterpret_cast<LeafPage*>(p->GetData());
+  int i=lower==nullptr?0:leaf->KeyIndex(*lower,comparator_);//first key >= lower
+  while(true)
+  {
+    if(i>=leaf->GetSize())//Move to the next leaf.
+    {
+      page_id_t next_id=leaf->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(leaf->GetPageId(),false);
+      if(next_id==INVALID_PAGE_ID)
+        break;
+      p=buffer_pool_manager_->FetchPage(next_id);
+      leaf=reinterpret_cast<LeafPage*>(p->GetData());
+      i=0;
+      continue;
+    }
+    const MappingType &item=leaf->GetItem(i);
+    if(upper!=nullptr&&comparator_(item.first,*upper)>0)//Out of range.
+    {
+      buffer_pool_manager_->UnpinPage(leaf->GetPageId(),false);
+      break;
+    }
+    result.push_back(item.second);
+    if(keys!=nullptr)
+      keys->push_back(item.first);
+    i++;
+  }
+  return result.size()>old_size;
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -113,7 +190,6 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value)
     Page*root=buffer_pool_manager_->NewPage(NewID);
     BPlusTreeLeafPage<KeyType,ValueType,KeyComparator>*ROOT=reinterpret_cast<BPlusTreeLeafPage<KeyType,ValueType,KeyComparator>*>(root->GetData());
     ROOT->Init(NewID,INVALID_PAGE_ID,leaf_max_size_);//New tree
-    ROOT->SetNextPageId(INVALID_PAGE_ID);//Set next_page_id
     //Update root_id.
     root_page_id_=NewID;   
     buffer_pool_manager_->UnpinPage(NewID,false);
@@ -188,6 +264,14 @@ N *BPLUSTREE_TYPE::Split(N *node) {
    LeafPage*newnode=reinterpret_cast<LeafPage*>(p->GetData());
    newnode->Init(NewID,node->GetParentPageId(),leaf_max_size_);
     node->MoveHalfTo(newnode);
+    //The old next leaf now follows the new node.
+    if(newnode->GetNextPageId()!=INVALID_PAGE_ID)
+    {
+      Page*next_page=buffer_pool_manager_->FetchPage(newnode->GetNextPageId());
+      LeafPage*next=reinterpret_cast<LeafPage*>(next_page->GetData());
+      next->SetPrevPageId(NewID);
+      buffer_pool_manager_->UnpinPage(next->GetPageId(),true);
+    }
   return newnode;
  }
 
@@ -254,6 +338,57 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
    }
 }
 
+/*
+ * Insert key & value pairs sorted by key
+ * The leaf of a key is kept pinned and reused for the following keys while they
+ * stay below its upper fence, so a run of keys costs one descent per leaf
+ * instead of one per key. A full leaf is left to InsertIntoLeaf to split.
+ * @return: number of inserted pairs, duplicate keys are skipped
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::InsertBatch(const std::vector<MappingType> &items, Transaction *transaction) {
+  int inserted=0;
+  LeafPage*leaf=nullptr;
+  bool dirty=false,has_fence=false;
+  KeyType fence;
+  for(auto &item:items)
+  {
+    //The key belongs to a later leaf.
+    if(leaf!=nullptr&&has_fence&&comparator_(item.first,fence)>=0)
+    {
+      buffer_pool_manager_->UnpinPage(leaf->GetPageId(),dirty);
+      leaf=nullptr;
+    }
+    if(leaf==nullptr)
+    {
+      if(IsEmpty())
+      {
+        inserted+=Insert(item.first,item.second,transaction);
+        continue;
+      }
+      leaf=reinterpret_cast<LeafPage*>(FindLeafPage(item.first,fence,has_fence)->GetData());
+      dirty=false;
+    }
+    ValueType value;
+    if(leaf->Lookup(item.first,value,comparator_))//Duplicate key.
+      continue;
+    if(leaf->GetSize()<leaf->GetMaxSize())
+    {
+      leaf->Insert(item.first,item.second,comparator_);
+      dirty=true;
+      inserted++;
+      continue;
+    }
+    //Split through the single insert, the next key descends again.
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(),dirty);
+    leaf=nullptr;
+    inserted+=InsertIntoLeaf(item.first,item.second,transaction);
+  }
+  if(leaf!=nullptr)
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(),dirty);
+  return inserted;
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -263,25 +398,171 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * If not, User needs to first find the right leaf page as deletion target, then
  * delete entry from leaf page. Remember to deal with redistribute or merge if
  * necessary.
+ * Return false if the key was not in the tree.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) 
+bool BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) 
 {
     Page*p1=FindLeafPage(key);
     
     if(p1==NULL)//Could not find.
-        return;
+        return false;
     BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>*Page_To_Del = reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>*>(p1->GetData());
   
     page_id_t del_id = Page_To_Del->GetPageId();
+    int old_size = Page_To_Del->GetSize();
     int SS = Page_To_Del->RemoveAndDeleteRecord(key, comparator_,buffer_pool_manager_);//size after deletion.
-    if(SS>=Page_To_Del->GetMinSize())//Delete directly
+    if(SS>=MinSize(Page_To_Del))//Delete directly
     {
           buffer_pool_manager_->UnpinPage(del_id, true);
     }
     else //need to Redistribute or Merge 
         CoalesceOrRedistribute(Page_To_Del, transaction);
+    return SS!=old_size;
+}
+
+/*
+ * Delete the keys sorted in ascending order
+ * Like InsertBatch, the leaf is reused while the keys stay below its upper
+ * fence. A deletion that would underflow the leaf goes through Remove, which
+ * merges or redistributes, and the next key descends again.
+ * Return how many keys were found and removed.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::RemoveBatch(const std::vector<KeyType> &keys, Transaction *transaction) {
+  LeafPage*leaf=nullptr;
+  bool dirty=false,has_fence=false;
+  int removed=0;
+  KeyType fence;
+  for(auto &key:keys)
+  {
+    //The key belongs to a later leaf.
+    if(leaf!=nullptr&&has_fence&&comparator_(key,fence)>=0)
+    {
+      buffer_pool_manager_->UnpinPage(leaf->GetPageId(),dirty);
+      leaf=nullptr;
+    }
+    if(leaf==nullptr)
+    {
+      if(IsEmpty())
+        return removed;
+      leaf=reinterpret_cast<LeafPage*>(FindLeafPage(key,fence,has_fence)->GetData());
+      dirty=false;
+    }
+    if(leaf->GetSize()-1>=MinSize(leaf))
+    {
+      int old_size=leaf->GetSize();
+      if(leaf->RemoveAndDeleteRecord(key,comparator_,buffer_pool_manager_)!=old_size)
+      {
+        dirty=true;
+        removed++;
+      }
+      continue;
+    }
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(),dirty);
+    leaf=nullptr;
+    if(Remove(key,transaction))
+      removed++;
+  }
+  if(leaf!=nullptr)
+    buffer_pool_manager_->UnpinPage(leaf->GetPageId(),dirty);
+  return removed;
+}
+
+/*
+ * Merge pass for trees that were left sparse by a lazy min fill. A leaf below
+ * half full is merged with its right sibling under the same parent(the last
+ * child uses its left sibling) if both fit in one page, and the merged leaf is
+ * tried again. Parents rebalance as in Remove.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::Compact(Transaction *transaction) {
+  if(IsEmpty())
+    return 0;
+  KeyType key;
+  Page*page=FindLeafPage(key,true);
+  page_id_t page_id=page->GetPageId();
+  buffer_pool_manager_->UnpinPage(page_id,false);
+  int merged=0;
+  while(page_id!=INVALID_PAGE_ID)
+  {
+    LeafPage*leaf=reinterpret_cast<LeafPage*>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    page_id_t next_id=leaf->GetNextPageId();
+    if(leaf->IsRootPage()||leaf->GetSize()>=leaf->GetMinSize())
+    {
+      buffer_pool_manager_->UnpinPage(page_id,false);
+      page_id=next_id;
+      continue;
+    }
+    InternalPage*parent=reinterpret_cast<InternalPage*>(buffer_pool_manager_->FetchPage(leaf->GetParentPageId())->GetData());
+    int index=parent->ValueIndex(page_id);
+    bool isleft=index+1>=parent->GetSize();
+    if(isleft&&index==0)//only child
+    {
+      buffer_pool_manager_->UnpinPage(parent->GetPageId(),false);
+      buffer_pool_manager_->UnpinPage(page_id,false);
+      page_id=next_id;
+      continue;
+    }
+    LeafPage*sib=reinterpret_cast<LeafPage*>(buffer_pool_manager_->FetchPage(parent->ValueAt(isleft?index-1:index+1))->GetData());
+    if(leaf->GetSize()+sib->GetSize()>leaf->GetMaxSize())
+    {
+      buffer_pool_manager_->UnpinPage(sib->GetPageId(),false);
+      buffer_pool_manager_->UnpinPage(parent->GetPageId(),false);
+      buffer_pool_manager_->UnpinPage(page_id,false);
+      page_id=next_id;
+      continue;
+    }
+    page_id_t parent_id=parent->GetPageId();
+    Coalesce(&sib,&leaf,&parent,index,isleft,transaction);
+    buffer_pool_manager_->UnpinPage(parent_id,true);
+    merged++;
+    //The leaf was moved into its left sibling, otherwise it took in the right one and is tried again.
+    if(isleft)
+      page_id=next_id;
+  }
+  return merged;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Analyze(uint32_t &height, uint32_t &leaf_count, uint64_t &entry_count, float &fill,
+                             const std::function<void(const KeyType &)> &visit) {
+  height=leaf_count=0;
+  entry_count=0;
+  fill=0;
+  if(IsEmpty())
     return;
+  page_id_t page_id=root_page_id_;
+  BPlusTreePage*node=reinterpret_cast<BPlusTreePage*>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  height=1;
+  while(!node->IsLeafPage())
+  {
+    page_id_t child_id=reinterpret_cast<InternalPage*>(node)->ValueAt(0);
+    buffer_pool_manager_->UnpinPage(page_id,false);
+    page_id=child_id;
+    node=reinterpret_cast<BPlusTreePage*>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    height++;
+  }
+  uint64_t capacity=0;
+  while(true)
+  {
+    LeafPage*leaf=reinterpret_cast<LeafPage*>(node);
+    leaf_count++;
+    entry_count+=leaf->GetSize();
+    capacity+=leaf->GetMaxSize();
+    if(visit)
+    {
+      for(int i=0;i<leaf->GetSize();i++)
+        visit(leaf->KeyAt(i));
+    }
+    page_id_t next_id=leaf->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id,false);
+    if(next_id==INVALID_PAGE_ID)
+      break;
+    page_id=next_id;
+    node=reinterpret_cast<BPlusTreePage*>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+  }
+  fill=capacity==0?0:static_cast<float>(entry_count)/capacity;
 }
 
 /*
@@ -295,7 +576,7 @@ INDEX_TEMPLATE_ARGUMENTS
 template<typename N>
 bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction)
 {
-   assert(node->GetMinSize() > node->GetSize());//node must be lower than Min_Size.
+   assert(MinSize(node) > node->GetSize());//node must be lower than Min_Size.
     if (node->IsRootPage()) {
         //Root 
         return AdjustRoot(node);
@@ -378,7 +659,7 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
         (*parent)->Remove(index + 1);
     }
 
-   if ((*parent)->GetSize() < (*parent)->GetMinSize()) {
+   if ((*parent)->GetSize() < MinSize(*parent)) {
        //After a parent node is deleted, the number of nodes is less than min_size, which is to process recursively.
         return CoalesceOrRedistribute(*parent, transaction);
     }
@@ -411,6 +692,15 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index,bool isle
   buffer_pool_manager_->UnpinPage(neighbor_node->GetPageId(), true);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::MinSize(const BPlusTreePage *page) const {
+  if(page->IsRootPage())
+    return page->GetMinSize();
+  //ceil(max_size * min_fill_ / 100), an internal page keeps two children
+  int min_size=(page->GetMaxSize()*min_fill_+99)/100;
+  return std::max(min_size,page->IsLeafPage()?1:2);
+}
+
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -458,7 +748,7 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
  
-  KeyType key;
+  KeyType key{};
   Page*begin=FindLeafPage(key,true);//Find the leftest leaf page.
   BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>*beginPage=reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>*>(begin->GetData());
   return INDEXITERATOR_TYPE(buffer_pool_manager_,beginPage->GetPageId(),beginPage,0);//Initial index=0;
@@ -467,7 +757,7 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
- * first, then construct index iterator
+ * first, then construct index iterator pointing at the first key >= low key
  * @return : index iterator
  */
 
@@ -475,22 +765,16 @@ INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
    Page*begin=FindLeafPage(key,false);//Find the first leaf page(>=key)
    BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>*beginPage=reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>*>(begin->GetData());
-  int Begin=0,ind=0;
-   if(beginPage!=nullptr)
-
-   {  ind=beginPage->KeyIndex(key,comparator_);
-     if(beginPage->GetSize()>=1 && ind<beginPage->GetSize() &&comparator_(beginPage->GetItem(ind).first,key)==0)
-     //Find the key in leaf.
-     {
-           Begin=ind;
-     }
-     else
-     //There doesn't exist the key in leaf.
-     {
-          Begin=beginPage->GetSize();
-     }
-
-  }
+   int Begin=beginPage->KeyIndex(key,comparator_);//the first index >=key
+   if(Begin>=beginPage->GetSize() && beginPage->GetNextPageId()!=INVALID_PAGE_ID)
+   //All keys in this leaf are smaller, the first key >=key is the head of the next leaf.
+   {
+      page_id_t NextID=beginPage->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(beginPage->GetPageId(),false);
+      begin=buffer_pool_manager_->FetchPage(NextID);
+      beginPage=reinterpret_cast<BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>*>(begin->GetData());
+      Begin=0;
+   }
     return INDEXITERATOR_TYPE(buffer_pool_manager_,beginPage->GetPageId(),beginPage,Begin);
 }
 
@@ -524,6 +808,50 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::End() {
 
 }
 
+/*
+ * Input parameter is void, construct an index iterator pointing at the last
+ * key/value pair, walk it with operator-- until it reaches REnd()
+ * @return : index iterator
+ */
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin() {
+  INDEXITERATOR_TYPE iter=End();
+  return --iter;
+}
+
+/*
+ * Input parameter is high key, find the leaf page that contains the input key
+ * first, then construct index iterator pointing at the last key <= high key
+ * @return : index iterator
+ */
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin(const KeyType &key) {
+   Page*begin=FindLeafPage(key,false);
+   LeafPage*beginPage=reinterpret_cast<LeafPage*>(begin->GetData());
+   int Begin=beginPage->KeyIndex(key,comparator_);//the first index >=key
+   if(Begin<beginPage->GetSize()&&comparator_(beginPage->KeyAt(Begin),key)==0)
+     Begin++;
+   //Begin is the first index >key, keys of the next leaf are all >key.
+   INDEXITERATOR_TYPE iter(buffer_pool_manager_,beginPage->GetPageId(),beginPage,Begin);
+   return --iter;
+}
+
+/*
+ * Input parameter is void, construct an index iterator representing the
+ * position before the first key/value pair in the leaf node
+ * @return : index iterator
+ */
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::REnd() {
+  KeyType key{};
+  Page*p=FindLeafPage(key,true);//Find the leftest leaf page.
+  LeafPage*lp=reinterpret_cast<LeafPage*>(p->GetData());
+  return INDEXITERATOR_TYPE(buffer_pool_manager_,lp->GetPageId(),lp,-1);
+}
+
 
 /*****************************************************************************
  * UTILITIES AND DEBUG
@@ -563,26 +891,47 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
   return currpage;
 }
 
+/*
+ * Find the leaf page that contains key, and the smallest separator key on the
+ * path that is greater than every key routed to that leaf
+ * has_fence is false for the rightmost leaf, which has no upper bound
+ */
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, KeyType &fence, bool &has_fence) {
+  has_fence=false;
+  Page*currpage=buffer_pool_manager_->FetchPage(root_page_id_);
+  BPlusTreePage*bptp=reinterpret_cast<BPlusTreePage*>(currpage->GetData());
+  while(!bptp->IsLeafPage())
+  {
+     InternalPage*IntBPTP=reinterpret_cast<InternalPage*>(bptp);
+     page_id_t NextTurn=IntBPTP->Lookup(key,comparator_);
+     int child=IntBPTP->ValueIndex(NextTurn);
+     if(child+1<IntBPTP->GetSize())//Deeper separators are tighter.
+     {
+       fence=IntBPTP->KeyAt(child+1);
+       has_fence=true;
+     }
+     currpage=buffer_pool_manager_->FetchPage(NextTurn);
+     bptp=reinterpret_cast<BPlusTreePage*>(currpage->GetData());
+     buffer_pool_manager_->UnpinPage(IntBPTP->GetPageId(),false);
+  }
+  return currpage;
+}
+
 /*
  * Update/Insert root page id in header page(where page_id = 0, header_page is
  * defined under include/page/header_page.h)
  * Call this method everytime root page id is changed.
  * @parameter: insert_record      default value is false. When set to true,
  * insert a record <index_name, root_page_id> into header page instead of
- * updating it.
+ * updating it. The record is written either way: updated if present, else
+ * inserted.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) 
 {
-    IndexRootsPage*root_page=reinterpret_cast<IndexRootsPage*>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID));
-    if(insert_record==0)//update in index_roots_page
-    {
-        root_page->Update(index_id_,root_page_id_);
-    }
-    else{ //insert into index_roots_page
-        root_page->Insert(index_id_,root_page_id_);
-    }
-    buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID,true);
+    //Indexes built in parallel share the header page, the write takes its latch.
+    IndexRootsPage::WriteRootId(buffer_pool_manager_,index_id_,root_page_id_);
 }
 
 /**
@@ -731,3 +1080,9 @@ class BPlusTree<GenericKey<32>, RowId, GenericComparator<32>>;
 
 template
 class BPlusTree<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class BPlusTree<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class BPlusTree<GenericKey<256>, RowId, GenericComparator<256>>;
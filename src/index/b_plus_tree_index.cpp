@@ -1,51 +1,270 @@
+#include <algorithm>
+
 #include "index/b_plus_tree_index.h"
 #include "index/generic_key.h"
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema,
-                                     BufferPoolManager *buffer_pool_manager)
+                                     BufferPoolManager *buffer_pool_manager, bool unique, IndexSchema *include_schema,
+                                     bool bloom_filter)
         : Index(index_id, key_schema),
-          comparator_(key_schema_),
+          include_schema_(include_schema),
+          comparator_(key_schema_, unique),
           container_(index_id, buffer_pool_manager, comparator_) {
   //Bplus tree Newly constructed.
+  container_.SetMinFill(INDEX_MIN_FILL);
+  if (bloom_filter && BLOOM_FILTER_BITS_PER_KEY > 0) {
+    RebuildBloomFilter();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::RebuildBloomFilter() {
+  std::vector<uint64_t> hashes;
+  uint32_t height, leaf_count;
+  uint64_t entry_count;
+  float fill;
+  container_.Analyze(height, leaf_count, entry_count, fill, [&](const KeyType &key) {
+    Row row(INVALID_ROWID);
+    key.DeserializeToKey(row, key_schema_);
+    hashes.push_back(BloomFilter::HashKey(row, key_schema_->GetColumnCount()));
+  });
+  // room for the table to double before the next rebuild
+  bloom_.Reset(2 * hashes.size());
+  for (auto hash : hashes) {
+    bloom_.Add(hash);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::AddToBloomFilter(const Row &key) {
+  if (bloom_.Overloaded()) {
+    RebuildBloomFilter();
+  } else {
+    bloom_.Add(BloomFilter::HashKey(key, key_schema_->GetColumnCount()));
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::SerializeEntry(const Row &entry, RowId row_id, KeyType &index_key) {
+  uint32_t key_count = key_schema_->GetColumnCount();
+  if (include_schema_ == nullptr || entry.GetFieldCount() == key_count) {
+    if (IsUnique()) {
+      index_key.SerializeFromKey(entry, key_schema_);
+    } else {
+      index_key.SerializeFromKey(entry, row_id, key_schema_);
+    }
+    return;
+  }
+  ASSERT(entry.GetFieldCount() == key_count + include_schema_->GetColumnCount(), "field nums not match.");
+  std::vector<Field> key_fields, include_fields;
+  for (uint32_t i = 0; i < entry.GetFieldCount(); i++) {
+    (i < key_count ? key_fields : include_fields).push_back(*entry.GetField(i));
+  }
+  Row key(key_fields), included(include_fields);
+  uint32_t ofs = KeyType::GetSerializedSize(key, key_schema_);
+  if (IsUnique()) {
+    index_key.SerializeFromKey(key, key_schema_);
+  } else {
+    index_key.SerializeFromKey(key, row_id, key_schema_);
+    ofs += sizeof(int64_t);
+  }
+  index_key.SerializeIncluded(included, ofs, include_schema_);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
   ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
   KeyType index_key;
-  index_key.SerializeFromKey(key, key_schema_);
+  SerializeEntry(key, row_id, index_key);
 
   bool status = container_.Insert(index_key, row_id, txn);
 
   if (!status) {
     return DB_FAILED;
   }
+  if (bloom_.IsEnabled()) {
+    AddToBloomFilter(key);
+  }
+  stats_.OnInsert(1, IsUnique());
   return DB_SUCCESS;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
   KeyType index_key;
-  index_key.SerializeFromKey(key, key_schema_);
+  if (IsUnique()) {
+    index_key.SerializeFromKey(key, key_schema_);
+  } else {
+    index_key.SerializeFromKey(key, row_id, key_schema_);
+  }
 
-  container_.Remove(index_key, txn);
+  if (container_.Remove(index_key, txn)) {
+    stats_.OnRemove(1, IsUnique());
+  }
+  return DB_SUCCESS;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::InsertEntries(const vector<Row> &keys, const vector<RowId> &row_ids, Transaction *txn) {
+  ASSERT(keys.size() == row_ids.size(), "Keys and row ids do not match.");
+  vector<MappingType> items(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT(row_ids[i].Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
+    SerializeEntry(keys[i], row_ids[i], items[i].first);
+    items[i].second = row_ids[i];
+  }
+  // sorted keys let the tree fill each leaf in one visit
+  std::sort(items.begin(), items.end(), [this](const MappingType &lhs, const MappingType &rhs) {
+    return comparator_(lhs.first, rhs.first) < 0;
+  });
+  int inserted = container_.InsertBatch(items, txn);
+  if (bloom_.IsEnabled()) {
+    // keys rejected as duplicates were there already, adding them again is harmless
+    for (const auto &key : keys) {
+      AddToBloomFilter(key);
+    }
+  }
+  stats_.OnInsert(inserted, IsUnique());
+  if (inserted != static_cast<int>(items.size())) {
+    return DB_FAILED;
+  }
+  return DB_SUCCESS;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::RemoveEntries(const vector<Row> &keys, const vector<RowId> &row_ids, Transaction *txn) {
+  ASSERT(keys.size() == row_ids.size(), "Keys and row ids do not match.");
+  vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (IsUnique()) {
+      index_keys[i].SerializeFromKey(keys[i], key_schema_);
+    } else {
+      index_keys[i].SerializeFromKey(keys[i], row_ids[i], key_schema_);
+    }
+  }
+  std::sort(index_keys.begin(), index_keys.end(), [this](const KeyType &lhs, const KeyType &rhs) {
+    return comparator_(lhs, rhs) < 0;
+  });
+  int removed = container_.RemoveBatch(index_keys, txn);
+  stats_.OnRemove(removed, IsUnique());
   return DB_SUCCESS;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn) {
-  KeyType index_key;
-  index_key.SerializeFromKey(key, key_schema_);
-  if (container_.GetValue(index_key, result, txn)) {
+  // most unique constraint probes miss, the filter answers those without a page fetch
+  if (bloom_.IsEnabled() && !bloom_.MayContain(BloomFilter::HashKey(key, key_schema_->GetColumnCount()))) {
+    return DB_KEY_NOT_FOUND;
+  }
+  if (IsUnique()) {
+    KeyType index_key;
+    index_key.SerializeFromKey(key, key_schema_);
+    if (container_.GetValue(index_key, result, txn)) {
+      return DB_SUCCESS;
+    }
+    return DB_KEY_NOT_FOUND;
+  }
+  return ScanRange(&key, &key, result, txn);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::ScanRange(const Row *lower, const Row *upper, vector<RowId> &result, Transaction *txn) {
+  KeyType lower_key, upper_key;
+  if (IsUnique()) {
+    if (lower != nullptr) lower_key.SerializeFromKey(*lower, key_schema_);
+    if (upper != nullptr) upper_key.SerializeFromKey(*upper, key_schema_);
+  } else {
+    // all row ids of a key lie in [key + INVALID_ROWID, key + max row id]
+    if (lower != nullptr) lower_key.SerializeFromKey(*lower, INVALID_ROWID, key_schema_);
+    if (upper != nullptr) upper_key.SerializeFromKey(*upper, RowId(INT64_MAX), key_schema_);
+  }
+  if (container_.GetValueRange(lower == nullptr ? nullptr : &lower_key, upper == nullptr ? nullptr : &upper_key,
+                               result, txn)) {
     return DB_SUCCESS;
   }
   return DB_KEY_NOT_FOUND;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::ScanRangeEntries(const Row *lower, const Row *upper, vector<Row> &result,
+                                               Transaction *txn) {
+  KeyType lower_key, upper_key;
+  if (IsUnique()) {
+    if (lower != nullptr) lower_key.SerializeFromKey(*lower, key_schema_);
+    if (upper != nullptr) upper_key.SerializeFromKey(*upper, key_schema_);
+  } else {
+    if (lower != nullptr) lower_key.SerializeFromKey(*lower, INVALID_ROWID, key_schema_);
+    if (upper != nullptr) upper_key.SerializeFromKey(*upper, RowId(INT64_MAX), key_schema_);
+  }
+  vector<RowId> row_ids;
+  vector<KeyType> index_keys;
+  if (!container_.GetValueRange(lower == nullptr ? nullptr : &lower_key, upper == nullptr ? nullptr : &upper_key,
+                                row_ids, txn, &index_keys)) {
+    return DB_KEY_NOT_FOUND;
+  }
+  result.reserve(result.size() + row_ids.size());
+  for (size_t i = 0; i < row_ids.size(); i++) {
+    Row key(INVALID_ROWID);
+    uint32_t ofs = index_keys[i].DeserializeToKey(key, key_schema_);
+    std::vector<Field> fields;
+    for (uint32_t j = 0; j < key.GetFieldCount(); j++) {
+      fields.push_back(*key.GetField(j));
+    }
+    if (include_schema_ != nullptr) {
+      Row included(INVALID_ROWID);
+      index_keys[i].DeserializeIncluded(included, IsUnique() ? ofs : ofs + sizeof(int64_t), include_schema_);
+      for (uint32_t j = 0; j < included.GetFieldCount(); j++) {
+        fields.push_back(*included.GetField(j));
+      }
+    }
+    result.emplace_back(fields);
+    result.back().SetRowId(row_ids[i]);
+  }
+  return DB_SUCCESS;
+}
+
+/*
+ * Two walks over the leaves: the first counts the entries, the second collects
+ * the distinct keys and cuts the histogram into buckets of equal depth
+ */
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t BPLUSTREE_INDEX_TYPE::Analyze(Transaction *txn) {
+  IndexStatistics stats;
+  container_.Analyze(stats.height_, stats.leaf_count_, stats.entry_count_, stats.avg_fill_);
+  uint64_t buckets = std::min<uint64_t>(IndexStatistics::HISTOGRAM_BUCKETS, stats.entry_count_);
+  // compares the key columns only, never the row id of a non-unique index
+  KeyComparator key_only(key_schema_);
+  KeyType prev;
+  uint64_t rank = 0, bucket_start = 0;
+  uint32_t height, leaf_count;
+  uint64_t entry_count;
+  float fill;
+  container_.Analyze(height, leaf_count, entry_count, fill, [&](const KeyType &key) {
+    if (rank == 0 || key_only(prev, key) != 0) {
+      stats.distinct_count_++;
+    }
+    prev = key;
+    rank++;
+    // bucket i ends at rank ceil((i + 1) * entries / buckets)
+    uint64_t bucket = stats.bounds_.size();
+    if (rank == ((bucket + 1) * stats.entry_count_ + buckets - 1) / buckets) {
+      stats.bounds_.emplace_back(INVALID_ROWID);
+      key.DeserializeToKey(stats.bounds_.back(), key_schema_);
+      stats.counts_.push_back(rank - bucket_start);
+      bucket_start = rank;
+    }
+  });
+  stats_ = std::move(stats);
+  return DB_SUCCESS;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 dberr_t BPLUSTREE_INDEX_TYPE::Destroy() {
   container_.Destroy();
+  if (bloom_.IsEnabled()) {
+    bloom_.Reset(0);
+  }
   return DB_SUCCESS;
 }
 
@@ -57,7 +276,15 @@ INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE
 BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) {
-  return container_.Begin(key);
+  if (IsUnique()) {
+    return container_.Begin(key);
+  }
+  // position before every row id of this key
+  Row key_row(INVALID_ROWID);
+  key.DeserializeToKey(key_row, key_schema_);
+  KeyType lower_key;
+  lower_key.SerializeFromKey(key_row, INVALID_ROWID, key_schema_);
+  return container_.Begin(lower_key);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -65,6 +292,30 @@ INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetEndIterator() {
   return container_.End();
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetRBeginIterator() {
+  return container_.RBegin();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE
+BPLUSTREE_INDEX_TYPE::GetRBeginIterator(const KeyType &key) {
+  if (IsUnique()) {
+    return container_.RBegin(key);
+  }
+  // position after every row id of this key
+  Row key_row(INVALID_ROWID);
+  key.DeserializeToKey(key_row, key_schema_);
+  KeyType upper_key;
+  upper_key.SerializeFromKey(key_row, RowId(INT64_MAX), key_schema_);
+  return container_.RBegin(upper_key);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetREndIterator() {
+  return container_.REnd();
+}
+
 template
 class BPlusTreeIndex<GenericKey<4>, RowId, GenericComparator<4>>;
 
@@ -78,4 +329,10 @@ template
 class BPlusTreeIndex<GenericKey<32>, RowId, GenericComparator<32>>;
 
 template
-class BPlusTreeIndex<GenericKey<64>, RowId, GenericComparator<64>>;
\ No newline at end of file
+class BPlusTreeIndex<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class BPlusTreeIndex<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class BPlusTreeIndex<GenericKey<256>, RowId, GenericComparator<256>>;
\ No newline at end of file
@@ -0,0 +1,92 @@
+#include <algorithm>
+
+#include "index/bloom_filter.h"
+
+namespace {
+
+constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+inline uint64_t HashBytes(uint64_t hash, const void *data, size_t len) {
+  auto *bytes = reinterpret_cast<const unsigned char *>(data);
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ bytes[i]) * FNV_PRIME;
+  }
+  return hash;
+}
+
+// spread the bits of an FNV hash over the whole word
+inline uint64_t Mix(uint64_t hash) {
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+}  // namespace
+
+void BloomFilter::Reset(uint64_t expected_keys) {
+  capacity_ = std::max(expected_keys, MIN_KEYS);
+  uint64_t bits = 64;
+  while (bits < capacity_ * BLOOM_FILTER_BITS_PER_KEY) {
+    bits <<= 1;
+  }
+  bits_.assign(bits / 64, 0);
+  mask_ = bits - 1;
+  added_ = 0;
+}
+
+void BloomFilter::Add(uint64_t hash) {
+  // double hashing, probe i is h1 + i * h2
+  uint64_t h1 = hash, h2 = (hash >> 32) | 1;
+  for (uint32_t i = 0; i < HASH_COUNT; i++) {
+    uint64_t bit = (h1 + i * h2) & mask_;
+    bits_[bit >> 6] |= 1ULL << (bit & 63);
+  }
+  added_++;
+}
+
+bool BloomFilter::MayContain(uint64_t hash) const {
+  uint64_t h1 = hash, h2 = (hash >> 32) | 1;
+  for (uint32_t i = 0; i < HASH_COUNT; i++) {
+    uint64_t bit = (h1 + i * h2) & mask_;
+    if ((bits_[bit >> 6] & (1ULL << (bit & 63))) == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64_t BloomFilter::HashKey(const Row &key, uint32_t key_count) {
+  uint64_t hash = FNV_OFFSET;
+  for (uint32_t i = 0; i < key_count; i++) {
+    const Field *field = key.GetField(i);
+    bool is_null = field->IsNull();
+    hash = HashBytes(hash, &is_null, sizeof(bool));
+    if (is_null) {
+      continue;
+    }
+    switch (field->GetType()) {
+      case TypeId::kTypeInt: {
+        int32_t value = field->GetInteger();
+        hash = HashBytes(hash, &value, sizeof(int32_t));
+        break;
+      }
+      case TypeId::kTypeFloat: {
+        // -0.0 equals 0.0
+        float value = field->GetFloat() == 0 ? 0 : field->GetFloat();
+        hash = HashBytes(hash, &value, sizeof(float));
+        break;
+      }
+      default: {
+        uint32_t len = field->GetLength();
+        hash = HashBytes(hash, &len, sizeof(uint32_t));
+        hash = HashBytes(hash, field->GetData(), len);
+        break;
+      }
+    }
+  }
+  return Mix(hash);
+}
@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <unordered_set>
+
+#include "index/extendible_hash_table.h"
+#include "index/generic_key.h"
+
+INDEX_TEMPLATE_ARGUMENTS
+HASH_TABLE_TYPE::ExtendibleHashTable(index_id_t index_id, BufferPoolManager *buffer_pool_manager,
+                                     const KeyComparator &comparator)
+        : index_id_(index_id),
+          directory_page_id_(INVALID_PAGE_ID),
+          buffer_pool_manager_(buffer_pool_manager),
+          comparator_(comparator) {
+  auto *roots = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+  page_id_t directory_page_id;
+  if (roots->GetRootId(index_id_, &directory_page_id)) {
+    directory_page_id_ = directory_page_id;
+  }
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::IsEmpty() {
+  if (directory_page_id_ == INVALID_PAGE_ID) {
+    return true;
+  }
+  bool empty = FetchDirectory()->GetEntryCount() == 0;
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  return empty;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+HashTableDirectoryPage *HASH_TABLE_TYPE::FetchDirectory() {
+  return reinterpret_cast<HashTableDirectoryPage *>(buffer_pool_manager_->FetchPage(directory_page_id_)->GetData());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+typename HASH_TABLE_TYPE::BucketPage *HASH_TABLE_TYPE::FetchBucket(page_id_t page_id) {
+  return reinterpret_cast<BucketPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+}
+
+/*
+ * Create the directory with a single bucket and register it in the index roots
+ * page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::StartNewTable() {
+  page_id_t bucket_page_id;
+  Page *bucket_page = buffer_pool_manager_->NewPage(bucket_page_id);
+  ASSERT(bucket_page != nullptr, "Out of memory.");
+  reinterpret_cast<BucketPage *>(bucket_page->GetData())->Init();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+
+  Page *directory_page = buffer_pool_manager_->NewPage(directory_page_id_);
+  ASSERT(directory_page != nullptr, "Out of memory.");
+  reinterpret_cast<HashTableDirectoryPage *>(directory_page->GetData())->Init(directory_page_id_, bucket_page_id);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+
+  IndexRootsPage::WriteRootId(buffer_pool_manager_, index_id_, directory_page_id_);
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::GetValue(uint32_t hash, const KeyType &key, std::vector<ValueType> &result,
+                               Transaction *transaction) {
+  if (directory_page_id_ == INVALID_PAGE_ID) {
+    return false;
+  }
+  HashTableDirectoryPage *directory = FetchDirectory();
+  page_id_t page_id = directory->GetBucketPageId(hash & directory->GetGlobalDepthMask());
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  int found = 0;
+  while (page_id != INVALID_PAGE_ID) {
+    BucketPage *bucket = FetchBucket(page_id);
+    found += bucket->GetValues(hash, key, comparator_, result);
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return found > 0;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::Insert(uint32_t hash, const KeyType &key, const ValueType &value, Transaction *transaction) {
+  if (directory_page_id_ == INVALID_PAGE_ID) {
+    StartNewTable();
+  }
+  HashTableDirectoryPage *directory = FetchDirectory();
+  while (true) {
+    uint32_t slot = hash & directory->GetGlobalDepthMask();
+    page_id_t page_id = directory->GetBucketPageId(slot);
+    BucketPage *bucket = FetchBucket(page_id);
+    if (!bucket->IsFull()) {
+      bucket->Append(hash, key, value);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      break;
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    // splitting only helps if some entry of the chain lands in the other half
+    bool can_split = !ChainHashEqual(page_id, hash) &&
+                     (directory->GetLocalDepth(slot) < directory->GetGlobalDepth() ||
+                      directory->CanIncrGlobalDepth());
+    if (can_split) {
+      SplitBucket(directory, slot);
+      continue;
+    }
+    // append to the first overflow page with room, or chain a new one
+    bucket = FetchBucket(page_id);
+    while (bucket->IsFull() && bucket->GetNextPageId() != INVALID_PAGE_ID) {
+      page_id_t next_page_id = bucket->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      page_id = next_page_id;
+      bucket = FetchBucket(page_id);
+    }
+    if (bucket->IsFull()) {
+      page_id_t overflow_page_id;
+      Page *overflow_page = buffer_pool_manager_->NewPage(overflow_page_id);
+      ASSERT(overflow_page != nullptr, "Out of memory.");
+      bucket->SetNextPageId(overflow_page_id);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      page_id = overflow_page_id;
+      bucket = reinterpret_cast<BucketPage *>(overflow_page->GetData());
+      bucket->Init();
+    }
+    bucket->Append(hash, key, value);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    break;
+  }
+  directory->SetEntryCount(directory->GetEntryCount() + 1);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::ChainHashEqual(page_id_t page_id, uint32_t hash) {
+  while (page_id != INVALID_PAGE_ID) {
+    BucketPage *bucket = FetchBucket(page_id);
+    bool equal = bucket->AllHashEqual(hash);
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (!equal) {
+      return false;
+    }
+    page_id = next_page_id;
+  }
+  return true;
+}
+
+/*
+ * Move the entries of the bucket and its overflow pages whose next hash bit is
+ * set to a new bucket and point the matching half of the slots at it, doubling
+ * the directory first if needed. Both chains are packed again, so overflow
+ * pages that are no longer needed are freed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::SplitBucket(HashTableDirectoryPage *directory, uint32_t slot) {
+  uint32_t local_depth = directory->GetLocalDepth(slot);
+  if (local_depth == directory->GetGlobalDepth()) {
+    directory->IncrGlobalDepth();
+  }
+  uint32_t high_bit = 1U << local_depth;
+  std::vector<page_id_t> pages;
+  std::vector<Entry> kept, moved;
+  page_id_t page_id = directory->GetBucketPageId(slot);
+  while (page_id != INVALID_PAGE_ID) {
+    BucketPage *bucket = FetchBucket(page_id);
+    for (int i = 0; i < bucket->GetSize(); i++) {
+      const auto &entry = bucket->GetEntry(i);
+      (entry.hash_ & high_bit ? moved : kept).push_back(entry);
+    }
+    pages.push_back(page_id);
+    page_id_t next_page_id = bucket->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  WriteChain(std::move(pages), kept);
+  page_id_t new_page_id = WriteChain({}, moved);
+
+  uint32_t low_mask = high_bit - 1;
+  for (uint32_t i = 0; i < directory->Size(); i++) {
+    if ((i & low_mask) == (slot & low_mask)) {
+      directory->SetLocalDepth(i, local_depth + 1);
+      if (i & high_bit) {
+        directory->SetBucketPageId(i, new_page_id);
+      }
+    }
+  }
+  // a half that still needs overflow pages for different hashes is split again
+  bool can_split = local_depth + 1 < directory->GetGlobalDepth() || directory->CanIncrGlobalDepth();
+  auto needs_split = [can_split](const std::vector<Entry> &entries) {
+    return can_split && entries.size() > static_cast<size_t>(BucketPage::BUCKET_SIZE) &&
+           std::any_of(entries.begin(), entries.end(),
+                       [&entries](const Entry &entry) { return entry.hash_ != entries[0].hash_; });
+  };
+  if (needs_split(kept)) {
+    SplitBucket(directory, slot & low_mask);
+  }
+  if (needs_split(moved)) {
+    SplitBucket(directory, (slot & low_mask) | high_bit);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t HASH_TABLE_TYPE::WriteChain(std::vector<page_id_t> pages, const std::vector<Entry> &entries) {
+  // a bucket keeps its first page even if it is empty
+  size_t count = std::max<size_t>(1, (entries.size() + BucketPage::BUCKET_SIZE - 1) / BucketPage::BUCKET_SIZE);
+  while (pages.size() < count) {
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(page_id);
+    ASSERT(page != nullptr, "Out of memory.");
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    pages.push_back(page_id);
+  }
+  size_t next = 0;
+  for (size_t i = 0; i < count; i++) {
+    BucketPage *bucket = FetchBucket(pages[i]);
+    bucket->Init();
+    for (; next < entries.size() && !bucket->IsFull(); next++) {
+      bucket->Append(entries[next].hash_, entries[next].key_, entries[next].value_);
+    }
+    if (i + 1 < count) {
+      bucket->SetNextPageId(pages[i + 1]);
+    }
+    buffer_pool_manager_->UnpinPage(pages[i], true);
+  }
+  if (pages.size() > count) {
+    buffer_pool_manager_->DeletePages(std::vector<page_id_t>(pages.begin() + count, pages.end()));
+  }
+  return pages[0];
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_TYPE::Remove(uint32_t hash, const KeyType &key, const ValueType &value, Transaction *transaction) {
+  if (directory_page_id_ == INVALID_PAGE_ID) {
+    return false;
+  }
+  HashTableDirectoryPage *directory = FetchDirectory();
+  page_id_t page_id = directory->GetBucketPageId(hash & directory->GetGlobalDepthMask());
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  while (page_id != INVALID_PAGE_ID) {
+    BucketPage *bucket = FetchBucket(page_id);
+    int index = bucket->Find(hash, key, value, comparator_);
+    page_id_t next_page_id = bucket->GetNextPageId();
+    if (index < 0) {
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      prev_page_id = page_id;
+      page_id = next_page_id;
+      continue;
+    }
+    bucket->RemoveAt(index);
+    if (bucket->GetSize() == 0 && prev_page_id != INVALID_PAGE_ID) {
+      // unlink the empty overflow page
+      BucketPage *prev_bucket = FetchBucket(prev_page_id);
+      prev_bucket->SetNextPageId(next_page_id);
+      buffer_pool_manager_->UnpinPage(prev_page_id, true);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+    } else {
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    }
+    directory->SetEntryCount(directory->GetEntryCount() - 1);
+    buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+    return true;
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_TYPE::Destroy() {
+  if (directory_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  HashTableDirectoryPage *directory = FetchDirectory();
+  std::unordered_set<page_id_t> buckets;
+  for (uint32_t i = 0; i < directory->Size(); i++) {
+    buckets.insert(directory->GetBucketPageId(i));
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, false);
+  std::vector<page_id_t> pages{directory_page_id_};
+  for (page_id_t page_id : buckets) {
+    while (page_id != INVALID_PAGE_ID) {
+      pages.push_back(page_id);
+      page_id_t next_page_id = FetchBucket(page_id)->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+  }
+  buffer_pool_manager_->DeletePages(pages);
+  IndexRootsPage::EraseRootId(buffer_pool_manager_, index_id_);
+  directory_page_id_ = INVALID_PAGE_ID;
+}
+
+template
+class ExtendibleHashTable<GenericKey<4>, RowId, GenericComparator<4>>;
+
+template
+class ExtendibleHashTable<GenericKey<8>, RowId, GenericComparator<8>>;
+
+template
+class ExtendibleHashTable<GenericKey<16>, RowId, GenericComparator<16>>;
+
+template
+class ExtendibleHashTable<GenericKey<32>, RowId, GenericComparator<32>>;
+
+template
+class ExtendibleHashTable<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class ExtendibleHashTable<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class ExtendibleHashTable<GenericKey<256>, RowId, GenericComparator<256>>;
@@ -0,0 +1,171 @@
+#include "index/generic_key.h"
+#include "index/hash_index.h"
+
+INDEX_TEMPLATE_ARGUMENTS
+HASH_INDEX_TYPE::HashIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager,
+                           bool unique)
+        : Index(index_id, key_schema),
+          unique_(unique),
+          comparator_(key_schema_),
+          container_(index_id, buffer_pool_manager, comparator_) {}
+
+/*
+ * FNV-1a over the field values followed by a final avalanche, since the
+ * directory only looks at the low bits
+ */
+INDEX_TEMPLATE_ARGUMENTS
+uint32_t HASH_INDEX_TYPE::HashKey(const Row &key) {
+  uint32_t hash = 2166136261U;
+  auto mix = [&hash](const void *data, size_t len) {
+    const auto *bytes = reinterpret_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < len; i++) {
+      hash = (hash ^ bytes[i]) * 16777619U;
+    }
+  };
+  for (uint32_t i = 0; i < key.GetFieldCount(); i++) {
+    const Field *field = key.GetField(i);
+    if (field->IsNull()) {
+      mix("\0", 1);
+      continue;
+    }
+    switch (field->GetType()) {
+      case TypeId::kTypeInt: {
+        int32_t value = field->GetInteger();
+        mix(&value, sizeof(value));
+        break;
+      }
+      case TypeId::kTypeFloat: {
+        // 0.0 and -0.0 compare equal
+        float value = field->GetFloat() == 0 ? 0 : field->GetFloat();
+        mix(&value, sizeof(value));
+        break;
+      }
+      case TypeId::kTypeChar:
+        mix(field->GetChars(), field->GetLength());
+        break;
+      default:
+        break;
+    }
+  }
+  hash ^= hash >> 16;
+  hash *= 0x85ebca6bU;
+  hash ^= hash >> 13;
+  hash *= 0xc2b2ae35U;
+  hash ^= hash >> 16;
+  return hash;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t HASH_INDEX_TYPE::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
+  ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
+  KeyType index_key;
+  index_key.SerializeFromKey(key, key_schema_);
+  uint32_t hash = HashKey(key);
+  if (unique_) {
+    std::vector<RowId> exists;
+    if (container_.GetValue(hash, index_key, exists, txn)) {
+      return DB_FAILED;
+    }
+  }
+  container_.Insert(hash, index_key, row_id, txn);
+  return DB_SUCCESS;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t HASH_INDEX_TYPE::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
+  KeyType index_key;
+  index_key.SerializeFromKey(key, key_schema_);
+  container_.Remove(HashKey(key), index_key, row_id, txn);
+  return DB_SUCCESS;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t HASH_INDEX_TYPE::InsertEntries(const vector<Row> &keys, const vector<RowId> &row_ids, Transaction *txn) {
+  ASSERT(keys.size() == row_ids.size(), "Keys and row ids do not match.");
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (InsertEntry(keys[i], row_ids[i], txn) != DB_SUCCESS) {
+      return DB_FAILED;
+    }
+  }
+  return DB_SUCCESS;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t HASH_INDEX_TYPE::RemoveEntries(const vector<Row> &keys, const vector<RowId> &row_ids, Transaction *txn) {
+  ASSERT(keys.size() == row_ids.size(), "Keys and row ids do not match.");
+  for (size_t i = 0; i < keys.size(); i++) {
+    RemoveEntry(keys[i], row_ids[i], txn);
+  }
+  return DB_SUCCESS;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t HASH_INDEX_TYPE::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn) {
+  KeyType index_key;
+  index_key.SerializeFromKey(key, key_schema_);
+  if (container_.GetValue(HashKey(key), index_key, result, txn)) {
+    return DB_SUCCESS;
+  }
+  return DB_KEY_NOT_FOUND;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_INDEX_TYPE::IsPointRange(const Row *lower, const Row *upper) {
+  if (lower == nullptr || upper == nullptr) {
+    return false;
+  }
+  KeyType lower_key, upper_key;
+  lower_key.SerializeFromKey(*lower, key_schema_);
+  upper_key.SerializeFromKey(*upper, key_schema_);
+  return comparator_(lower_key, upper_key) == 0;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t HASH_INDEX_TYPE::ScanRange(const Row *lower, const Row *upper, vector<RowId> &result, Transaction *txn) {
+  if (!IsPointRange(lower, upper)) {
+    return DB_FAILED;
+  }
+  return ScanKey(*lower, result, txn);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t HASH_INDEX_TYPE::ScanRangeEntries(const Row *lower, const Row *upper, vector<Row> &result,
+                                          Transaction *txn) {
+  if (!IsPointRange(lower, upper)) {
+    return DB_FAILED;
+  }
+  vector<RowId> row_ids;
+  dberr_t status = ScanKey(*lower, row_ids, txn);
+  for (auto &row_id : row_ids) {
+    result.push_back(*lower);
+    result.back().SetRowId(row_id);
+  }
+  return status;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+dberr_t HASH_INDEX_TYPE::Destroy() {
+  container_.Destroy();
+  return DB_SUCCESS;
+}
+
+template
+class HashIndex<GenericKey<4>, RowId, GenericComparator<4>>;
+
+template
+class HashIndex<GenericKey<8>, RowId, GenericComparator<8>>;
+
+template
+class HashIndex<GenericKey<16>, RowId, GenericComparator<16>>;
+
+template
+class HashIndex<GenericKey<32>, RowId, GenericComparator<32>>;
+
+template
+class HashIndex<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class HashIndex<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class HashIndex<GenericKey<256>, RowId, GenericComparator<256>>;
@@ -7,13 +7,61 @@ INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(BufferPoolManager*b,p
 {
      
 }
+INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(const IndexIterator &other)
+:buff_pool_manager(other.buff_pool_manager),CurrPageID(other.CurrPageID),CurrLeafPage(other.CurrLeafPage),index_in_page(other.index_in_page)
+{
+    if(CurrLeafPage!=nullptr)//The copy holds its own pin.
+      buff_pool_manager->FetchPage(CurrPageID);
+}
+
+INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept
+:buff_pool_manager(other.buff_pool_manager),CurrPageID(other.CurrPageID),CurrLeafPage(other.CurrLeafPage),index_in_page(other.index_in_page)
+{
+    other.CurrLeafPage=nullptr;
+    other.CurrPageID=INVALID_PAGE_ID;
+}
+
+INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator=(const IndexIterator &other)
+{
+    if(this!=&other)
+    {
+      IndexIterator copy(other);
+      *this=std::move(copy);
+    }
+    return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept
+{
+    if(this!=&other)
+    {
+      if(CurrLeafPage!=nullptr)
+        buff_pool_manager->UnpinPage(CurrPageID,false);
+      buff_pool_manager=other.buff_pool_manager;
+      CurrPageID=other.CurrPageID;
+      CurrLeafPage=other.CurrLeafPage;
+      index_in_page=other.index_in_page;
+      other.CurrLeafPage=nullptr;
+      other.CurrPageID=INVALID_PAGE_ID;
+    }
+    return *this;
+}
+
 INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE::~IndexIterator() 
 {
-    if(!CurrLeafPage)//Current leaf page is not empty.
+    if(CurrLeafPage!=nullptr)//Give back the pin of the current leaf.
     {
-     buff_pool_manager->UnpinPage(CurrLeafPage->GetPageId(),false);
+     buff_pool_manager->UnpinPage(CurrPageID,false);
     }
-   //delete buff_pool_manager;
+}
+
+INDEX_TEMPLATE_ARGUMENTS void INDEXITERATOR_TYPE::MoveToLeaf(page_id_t page_id)
+{
+    page_id_t old_id=CurrPageID;
+    Page* p = buff_pool_manager->FetchPage(page_id);
+    CurrLeafPage = reinterpret_cast<BPlusTreeLeafPage<KeyType,ValueType,KeyComparator> *>(p->GetData());
+    CurrPageID=page_id;
+    buff_pool_manager->UnpinPage(old_id,false);
 }
 
 INDEX_TEMPLATE_ARGUMENTS const MappingType &INDEXITERATOR_TYPE::operator*() {
@@ -28,11 +76,8 @@ INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++()
     page_id_t nextid =CurrLeafPage->GetNextPageId();
     if (nextid!=INVALID_PAGE_ID){
          //Fetch the next page
-      Page* p = buff_pool_manager->FetchPage(nextid);
+      MoveToLeaf(nextid);
       index_in_page=0;
-      CurrLeafPage = reinterpret_cast<BPlusTreeLeafPage<KeyType,ValueType,KeyComparator> *>(p->GetData());
-      CurrPageID=CurrLeafPage->GetPageId();
-
     }
     else{
   
@@ -45,9 +90,49 @@ INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++()
     return *this;
 }
 
+INDEX_TEMPLATE_ARGUMENTS INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator--() 
+//Subtract ,and then return
+{
+   if (index_in_page<=0){//First Element
+    page_id_t previd =CurrLeafPage->GetPrevPageId();
+    if (previd!=INVALID_PAGE_ID){
+         //Fetch the previous page
+      MoveToLeaf(previd);
+      index_in_page=CurrLeafPage->GetSize()-1;
+    }
+    else{
+      index_in_page=-1;
+    }
+  }
+  else{
+    index_in_page --;
+  }
+    return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int INDEXITERATOR_TYPE::NextN(std::vector<ValueType> &values)
+//Copy out the rest of the leaf, then stand at the head of the next one.
+{
+  int size=CurrLeafPage->GetSize();
+  if(index_in_page>=size)//End
+    return 0;
+  int count=size-index_in_page;
+  values.reserve(values.size()+count);
+  for(;index_in_page<size;index_in_page++)
+    values.push_back(CurrLeafPage->GetItem(index_in_page).second);
+  page_id_t nextid=CurrLeafPage->GetNextPageId();
+  if(nextid!=INVALID_PAGE_ID)
+  {
+    MoveToLeaf(nextid);
+    index_in_page=0;
+  }
+  return count;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 bool INDEXITERATOR_TYPE::operator==(const IndexIterator &itr) const {
- if(this->CurrLeafPage->GetPageId()==itr.CurrLeafPage->GetPageId() &&  this->GetIndexInPage()==itr.GetIndexInPage()) 
+ if(this->CurrPageID==itr.CurrPageID &&  this->GetIndexInPage()==itr.GetIndexInPage()) 
  {
       return true;
  }
@@ -56,7 +141,7 @@ bool INDEXITERATOR_TYPE::operator==(const IndexIterator &itr) const {
 
 INDEX_TEMPLATE_ARGUMENTS
 bool INDEXITERATOR_TYPE::operator!=(const IndexIterator &itr) const {
- if(this->CurrLeafPage->GetPageId()==itr.CurrLeafPage->GetPageId()  &&  this->GetIndexInPage()==itr.GetIndexInPage()) 
+ if(this->CurrPageID==itr.CurrPageID  &&  this->GetIndexInPage()==itr.GetIndexInPage()) 
  {
       return false;
  }
@@ -68,22 +153,12 @@ page_id_t INDEXITERATOR_TYPE::GetCurrPageID()const
 {
      return CurrPageID;
 }
-INDEX_TEMPLATE_ARGUMENTS
-  void INDEXITERATOR_TYPE::SetCurrPageID(page_id_t page_id)
-  {
-      this->CurrPageID=page_id;
-  }
   INDEX_TEMPLATE_ARGUMENTS
   BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>* INDEXITERATOR_TYPE:: GetLeafPage()const
   {
         return CurrLeafPage;
   }
   INDEX_TEMPLATE_ARGUMENTS
-  void INDEXITERATOR_TYPE::SetLeafPage( BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>*leafpage)
-  {
-     CurrLeafPage=leafpage;
-  }
-  INDEX_TEMPLATE_ARGUMENTS
   int INDEXITERATOR_TYPE::GetIndexInPage()const
   {
        return index_in_page;
@@ -113,3 +188,9 @@ class IndexIterator<GenericKey<32>, RowId, GenericComparator<32>>;
 
 template
 class IndexIterator<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class IndexIterator<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class IndexIterator<GenericKey<256>, RowId, GenericComparator<256>>;
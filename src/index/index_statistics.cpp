@@ -0,0 +1,111 @@
+#include "index/index_statistics.h"
+
+namespace {
+
+// compare two keys field by field, a null compares equal to anything
+int CompareKeys(const Row &lhs, const Row &rhs) {
+  for (uint32_t i = 0; i < lhs.GetFieldCount(); i++) {
+    if (lhs.GetField(i)->CompareLessThan(*rhs.GetField(i)) == CmpBool::kTrue) {
+      return -1;
+    }
+    if (lhs.GetField(i)->CompareGreaterThan(*rhs.GetField(i)) == CmpBool::kTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+uint32_t IndexStatistics::SerializeTo(char *buf, Schema *key_schema) const {
+  char *pos = buf;
+  MACH_WRITE_UINT32(pos, INDEX_STATISTICS_MAGIC_NUM);
+  pos += sizeof(uint32_t);
+  MACH_WRITE_TO(uint64_t, pos, entry_count_);
+  pos += sizeof(uint64_t);
+  MACH_WRITE_TO(uint64_t, pos, distinct_count_);
+  pos += sizeof(uint64_t);
+  MACH_WRITE_UINT32(pos, leaf_count_);
+  pos += sizeof(uint32_t);
+  MACH_WRITE_UINT32(pos, height_);
+  pos += sizeof(uint32_t);
+  MACH_WRITE_TO(float, pos, avg_fill_);
+  pos += sizeof(float);
+  MACH_WRITE_UINT32(pos, static_cast<uint32_t>(bounds_.size()));
+  pos += sizeof(uint32_t);
+  for (size_t i = 0; i < bounds_.size(); i++) {
+    MACH_WRITE_TO(uint64_t, pos, counts_[i]);
+    pos += sizeof(uint64_t);
+    pos += bounds_[i].SerializeTo(pos, key_schema);
+  }
+  return pos - buf;
+}
+
+uint32_t IndexStatistics::GetSerializedSize(Schema *key_schema) const {
+  uint32_t size = sizeof(uint32_t) * 4 + sizeof(uint64_t) * 2 + sizeof(float);
+  for (const auto &bound : bounds_) {
+    size += sizeof(uint64_t) + bound.GetSerializedSize(key_schema);
+  }
+  return size;
+}
+
+uint32_t IndexStatistics::DeserializeFrom(char *buf, Schema *key_schema) {
+  char *pos = buf;
+  if (MACH_READ_UINT32(pos) != INDEX_STATISTICS_MAGIC_NUM) {
+    return 0;
+  }
+  pos += sizeof(uint32_t);
+  entry_count_ = MACH_READ_FROM(uint64_t, pos);
+  pos += sizeof(uint64_t);
+  distinct_count_ = MACH_READ_FROM(uint64_t, pos);
+  pos += sizeof(uint64_t);
+  leaf_count_ = MACH_READ_UINT32(pos);
+  pos += sizeof(uint32_t);
+  height_ = MACH_READ_UINT32(pos);
+  pos += sizeof(uint32_t);
+  avg_fill_ = MACH_READ_FROM(float, pos);
+  pos += sizeof(float);
+  uint32_t buckets = MACH_READ_UINT32(pos);
+  pos += sizeof(uint32_t);
+  bounds_.clear();
+  counts_.clear();
+  for (uint32_t i = 0; i < buckets; i++) {
+    counts_.push_back(MACH_READ_FROM(uint64_t, pos));
+    pos += sizeof(uint64_t);
+    bounds_.emplace_back(INVALID_ROWID);
+    pos += bounds_.back().DeserializeFrom(pos, key_schema);
+  }
+  return pos - buf;
+}
+
+uint64_t IndexStatistics::EstimateEqual() const {
+  if (distinct_count_ == 0) {
+    return entry_count_;
+  }
+  return (entry_count_ + distinct_count_ - 1) / distinct_count_;
+}
+
+/*
+ * Buckets inside the range count fully, buckets that only overlap it count
+ * half. Without a histogram every entry may match.
+ */
+uint64_t IndexStatistics::EstimateRange(const Row *lower, const Row *upper) const {
+  if (bounds_.empty()) {
+    return entry_count_;
+  }
+  uint64_t estimate = 0;
+  for (size_t i = 0; i < bounds_.size(); i++) {
+    const Row *bucket_lower = i == 0 ? nullptr : &bounds_[i - 1];
+    const Row &bucket_upper = bounds_[i];
+    if (lower != nullptr && CompareKeys(bucket_upper, *lower) < 0) {
+      continue;
+    }
+    if (upper != nullptr && bucket_lower != nullptr && CompareKeys(*bucket_lower, *upper) >= 0) {
+      break;
+    }
+    bool inside = (lower == nullptr || (bucket_lower != nullptr && CompareKeys(*bucket_lower, *lower) >= 0)) &&
+                  (upper == nullptr || CompareKeys(bucket_upper, *upper) <= 0);
+    estimate += inside ? counts_[i] : (counts_[i] + 1) / 2;
+  }
+  return estimate;
+}
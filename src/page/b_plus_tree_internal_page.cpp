@@ -94,22 +94,18 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  //binary search
-  int LeftBound=1,RightBound=GetSize()-1;
-  while(LeftBound<=RightBound)
+  //branchless search for the first key > key in [1,size), its left neighbour holds the child
+  int base=1,size=GetSize()-1;
+  if(size<=0)
+    return array_[0].second;
+  while(size>1)
   {
-      int mid=(LeftBound+RightBound)/2;
-      int Comp=comparator(key,array_[mid].first);
-      if(Comp<0)
-        RightBound=mid-1;
-      else if(Comp>0)
-      {
-          LeftBound=mid+1;
-      }
-      else//Find exactly
-         return array_[mid].second;
+      int half=size/2;
+      base=comparator(array_[base+half].first,key)<=0?base+half:base;
+      size-=half;
   }
-  return array_[RightBound].second;
+  base+=(comparator(array_[base].first,key)<=0);
+  return array_[base-1].second;
 }
 
 /*****************************************************************************
@@ -407,4 +403,10 @@ template
 class BPlusTreeInternalPage<GenericKey<32>, page_id_t, GenericComparator<32>>;
 
 template
-class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
\ No newline at end of file
+class BPlusTreeInternalPage<GenericKey<64>, page_id_t, GenericComparator<64>>;
+
+template
+class BPlusTreeInternalPage<GenericKey<128>, page_id_t, GenericComparator<128>>;
+
+template
+class BPlusTreeInternalPage<GenericKey<256>, page_id_t, GenericComparator<256>>;
\ No newline at end of file
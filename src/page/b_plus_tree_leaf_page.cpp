@@ -11,7 +11,7 @@
 /**
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
- * next page id and set max size
+ * next/prev page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) 
@@ -21,6 +21,8 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, in
     SetMaxSize(max_size);
     SetSize(0);
     SetPageType(IndexPageType::LEAF_PAGE);
+    SetNextPageId(INVALID_PAGE_ID);
+    SetPrevPageId(INVALID_PAGE_ID);
 }
 
 /**
@@ -37,32 +39,37 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {
     this->next_page_id_=next_page_id;
 }
 
+/**
+ * Helper methods to set/get previous page id
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const {
+  return prev_page_id_;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) {
+    this->prev_page_id_=prev_page_id;
+}
+
 /**
  * Helper method to find the first index i so that array_[i].first >= key
  * NOTE: This method is only used when generating index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
-     int low=0,high=GetSize()-1;
-     //binary search
-     while(low<=high)
+     int size=GetSize();
+     if(size==0)
+       return 0;
+     //branchless lower bound: the probe only picks the next base, so it compiles to a conditional move
+     int base=0;
+     while(size>1)
      {
-       int middle=((high-low)/2)+low; 
-       int comp=comparator(array_[middle].first,key);
-       if(comp>0)
-       {
-         high=middle-1;
-       }  
-        else if(comp<0)
-        {
-          low=middle+1;
-        }
-        else   //[middle]==key
-        {
-          return middle;
-        }
+       int half=size/2;
+       base=comparator(array_[base+half].first,key)<0?base+half:base;
+       size-=half;
      }
-     return low;
+     return base+(comparator(array_[base].first,key)<0);
 }
 
 /*
@@ -122,8 +129,9 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient)
 {
   //NEED TO SPLIT
     assert(GetMaxSize()+1==GetSize());
-    //Insert recipient after this
+    //Insert recipient after this, the caller relinks the old next page back to recipient
     recipient->SetNextPageId(this->GetNextPageId());
+    recipient->SetPrevPageId(this->GetPageId());
     SetNextPageId(recipient->GetPageId());
 
     int End=GetSize()-1;
@@ -257,7 +265,16 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient,const Ke
    recipient->IncreaseSize(this->GetSize());
     SetSize(0);
     recipient->SetNextPageId(this->GetNextPageId());
+    //The page after me now follows recipient.
+    if(GetNextPageId()!=INVALID_PAGE_ID&&bufferpoolmanager!=nullptr)
+    {
+      Page*p=bufferpoolmanager->FetchPage(GetNextPageId());
+      BPlusTreeLeafPage*next=reinterpret_cast<BPlusTreeLeafPage*>(p->GetData());
+      next->SetPrevPageId(recipient->GetPageId());
+      bufferpoolmanager->UnpinPage(next->GetPageId(),true);
+    }
     SetNextPageId(INVALID_PAGE_ID);
+    SetPrevPageId(INVALID_PAGE_ID);
 }
 
 /*****************************************************************************
@@ -357,4 +374,10 @@ template
 class BPlusTreeLeafPage<GenericKey<32>, RowId, GenericComparator<32>>;
 
 template
-class BPlusTreeLeafPage<GenericKey<64>, RowId, GenericComparator<64>>;
\ No newline at end of file
+class BPlusTreeLeafPage<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class BPlusTreeLeafPage<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class BPlusTreeLeafPage<GenericKey<256>, RowId, GenericComparator<256>>;
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include "page/columnar_page.h"
+
+void ColumnarPage::Init(page_id_t page_id, page_id_t prev_id, Schema *schema) {
+  memcpy(GetData(), &page_id, sizeof(page_id));
+  SetPrevPageId(prev_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetSlotCount(0);
+  uint32_t capacity = GetCapacity(schema);
+  SetFreeSlotCount(capacity);
+  memset(SlotStates(), SLOT_EMPTY, capacity);
+}
+
+uint32_t ColumnarPage::GetValueSize(const Column *column) {
+  if (column->GetType() == TypeId::kTypeChar) {
+    return sizeof(uint32_t) + column->GetLength();
+  }
+  return sizeof(uint32_t);
+}
+
+uint32_t ColumnarPage::GetSlotSize(Schema *schema) {
+  // the slot state, then a null flag and a value in every minipage
+  uint32_t size = sizeof(uint8_t);
+  for (auto column : schema->GetColumns()) {
+    size += sizeof(uint8_t) + GetValueSize(column);
+  }
+  return size;
+}
+
+uint32_t ColumnarPage::GetCapacity(Schema *schema) {
+  return (PAGE_SIZE - SIZE_HEADER) / GetSlotSize(schema);
+}
+
+uint32_t ColumnarPage::MinipageOffset(uint32_t column, Schema *schema) {
+  uint32_t capacity = GetCapacity(schema);
+  uint32_t offset = SIZE_HEADER + capacity;
+  for (uint32_t i = 0; i < column; i++) {
+    offset += capacity * (sizeof(uint8_t) + GetValueSize(schema->GetColumn(i)));
+  }
+  return offset;
+}
+
+bool ColumnarPage::Fits(const Row &row, Schema *schema) {
+  if (row.GetFieldCount() != schema->GetColumnCount()) {
+    return false;
+  }
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    const Column *column = schema->GetColumn(i);
+    Field *field = row.GetField(i);
+    if (column->GetType() == TypeId::kTypeChar && !field->IsNull() &&
+        (field->IsExternal() || field->GetLength() > column->GetLength())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ColumnarPage::WriteTuple(const Row &row, uint32_t slot, Schema *schema) {
+  uint32_t capacity = GetCapacity(schema);
+  char *minipage = GetData() + SIZE_HEADER + capacity;
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    const Column *column = schema->GetColumn(i);
+    uint32_t value_size = GetValueSize(column);
+    Field *field = row.GetField(i);
+    char *value = minipage + capacity + slot * value_size;
+    minipage[slot] = field->IsNull();
+    if (field->IsNull()) {
+      memset(value, 0, value_size);
+    } else if (column->GetType() == TypeId::kTypeChar) {
+      MACH_WRITE_UINT32(value, field->GetLength());
+      memcpy(value + sizeof(uint32_t), field->GetData(), field->GetLength());
+    } else {
+      field->SerializeTo(value);
+    }
+    minipage += capacity * (sizeof(uint8_t) + value_size);
+  }
+}
+
+bool ColumnarPage::InsertTuple(Row &row, Schema *schema) {
+  if (GetFreeSlotCount() == 0 || !Fits(row, schema)) {
+    return false;
+  }
+  // take the first empty slot
+  uint32_t slot = 0;
+  while (SlotStates()[slot] != SLOT_EMPTY) {
+    slot++;
+  }
+  WriteTuple(row, slot, schema);
+  SlotStates()[slot] = SLOT_LIVE;
+  SetFreeSlotCount(GetFreeSlotCount() - 1);
+  if (slot >= GetSlotCount()) {
+    SetSlotCount(slot + 1);
+  }
+  row.SetRowId(RowId(GetTablePageId(), slot));
+  return true;
+}
+
+bool ColumnarPage::MarkDelete(const RowId &rid) {
+  uint32_t slot = rid.GetSlotNum();
+  if (slot >= GetSlotCount() || SlotStates()[slot] != SLOT_LIVE) {
+    return false;
+  }
+  SlotStates()[slot] = SLOT_DELETED;
+  return true;
+}
+
+bool ColumnarPage::UpdateTuple(const Row &new_row, const RowId &rid, Schema *schema) {
+  uint32_t slot = rid.GetSlotNum();
+  if (slot >= GetSlotCount() || SlotStates()[slot] != SLOT_LIVE || !Fits(new_row, schema)) {
+    return false;
+  }
+  WriteTuple(new_row, slot, schema);
+  return true;
+}
+
+void ColumnarPage::ApplyDelete(const RowId &rid) {
+  uint32_t slot = rid.GetSlotNum();
+  ASSERT(slot < GetSlotCount(), "Cannot have more slots than tuples.");
+  if (SlotStates()[slot] == SLOT_EMPTY) {
+    return;
+  }
+  SlotStates()[slot] = SLOT_EMPTY;
+  SetFreeSlotCount(GetFreeSlotCount() + 1);
+  // shrink the slot count over the empty slots at the end
+  uint32_t count = GetSlotCount();
+  while (count > 0 && SlotStates()[count - 1] == SLOT_EMPTY) {
+    count--;
+  }
+  SetSlotCount(count);
+}
+
+void ColumnarPage::RollbackDelete(const RowId &rid) {
+  uint32_t slot = rid.GetSlotNum();
+  ASSERT(slot < GetSlotCount(), "We can't have more slots than tuples.");
+  if (SlotStates()[slot] == SLOT_DELETED) {
+    SlotStates()[slot] = SLOT_LIVE;
+  }
+}
+
+uint32_t ColumnarPage::SerializeTuple(uint32_t slot, Schema *schema, char *buf) {
+  uint32_t capacity = GetCapacity(schema);
+  uint32_t column_count = schema->GetColumnCount();
+  const char *minipage = GetData() + SIZE_HEADER + capacity;
+  char *data = buf + sizeof(uint32_t) + column_count * sizeof(bool);
+  MACH_WRITE_UINT32(buf, column_count);
+  for (uint32_t i = 0; i < column_count; i++) {
+    const Column *column = schema->GetColumn(i);
+    uint32_t value_size = GetValueSize(column);
+    bool is_null = minipage[slot];
+    MACH_WRITE_TO(bool, buf + sizeof(uint32_t) + i * sizeof(bool), is_null);
+    if (!is_null) {
+      const char *value = minipage + capacity + slot * value_size;
+      // the row format stores a CHAR value with its own length, not the column length
+      uint32_t size = column->GetType() == TypeId::kTypeChar ? sizeof(uint32_t) + MACH_READ_UINT32(value) : value_size;
+      memcpy(data, value, size);
+      data += size;
+    }
+    minipage += capacity * (sizeof(uint8_t) + value_size);
+  }
+  return data - buf;
+}
+
+bool ColumnarPage::GetTuple(Row *row, Schema *schema) {
+  uint32_t slot = row->GetRowId().GetSlotNum();
+  if (slot >= GetSlotCount() || SlotStates()[slot] != SLOT_LIVE) {
+    return false;
+  }
+  char buf[PAGE_SIZE];
+  SerializeTuple(slot, schema, buf);
+  row->DeserializeFrom(buf, schema);
+  return true;
+}
+
+bool ColumnarPage::GetFirstTupleRid(RowId *first_rid) {
+  for (uint32_t i = 0; i < GetSlotCount(); i++) {
+    if (SlotStates()[i] == SLOT_LIVE) {
+      first_rid->Set(GetTablePageId(), i);
+      return true;
+    }
+  }
+  first_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+bool ColumnarPage::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
+  ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
+  for (auto i = cur_rid.GetSlotNum() + 1; i < GetSlotCount(); i++) {
+    if (SlotStates()[i] == SLOT_LIVE) {
+      next_rid->Set(GetTablePageId(), i);
+      return true;
+    }
+  }
+  next_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
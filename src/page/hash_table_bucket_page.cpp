@@ -0,0 +1,74 @@
+#include "index/generic_key.h"
+#include "page/hash_table_bucket_page.h"
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_BUCKET_PAGE_TYPE::Append(uint32_t hash, const KeyType &key, const ValueType &value) {
+  ASSERT(!IsFull(), "Hash bucket is full.");
+  array_[size_].hash_ = hash;
+  array_[size_].key_ = key;
+  array_[size_].value_ = value;
+  size_++;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void HASH_TABLE_BUCKET_PAGE_TYPE::RemoveAt(int index) {
+  size_--;
+  if (index != size_) {
+    array_[index] = array_[size_];
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int HASH_TABLE_BUCKET_PAGE_TYPE::GetValues(uint32_t hash, const KeyType &key, const KeyComparator &comparator,
+                                           std::vector<ValueType> &result) const {
+  int found = 0;
+  for (int i = 0; i < size_; i++) {
+    if (array_[i].hash_ == hash && comparator(array_[i].key_, key) == 0) {
+      result.push_back(array_[i].value_);
+      found++;
+    }
+  }
+  return found;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int HASH_TABLE_BUCKET_PAGE_TYPE::Find(uint32_t hash, const KeyType &key, const ValueType &value,
+                                      const KeyComparator &comparator) const {
+  for (int i = 0; i < size_; i++) {
+    if (array_[i].hash_ == hash && array_[i].value_ == value && comparator(array_[i].key_, key) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool HASH_TABLE_BUCKET_PAGE_TYPE::AllHashEqual(uint32_t hash) const {
+  for (int i = 0; i < size_; i++) {
+    if (array_[i].hash_ != hash) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template
+class HashTableBucketPage<GenericKey<4>, RowId, GenericComparator<4>>;
+
+template
+class HashTableBucketPage<GenericKey<8>, RowId, GenericComparator<8>>;
+
+template
+class HashTableBucketPage<GenericKey<16>, RowId, GenericComparator<16>>;
+
+template
+class HashTableBucketPage<GenericKey<32>, RowId, GenericComparator<32>>;
+
+template
+class HashTableBucketPage<GenericKey<64>, RowId, GenericComparator<64>>;
+
+template
+class HashTableBucketPage<GenericKey<128>, RowId, GenericComparator<128>>;
+
+template
+class HashTableBucketPage<GenericKey<256>, RowId, GenericComparator<256>>;
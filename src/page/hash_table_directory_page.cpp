@@ -0,0 +1,21 @@
+#include "page/hash_table_directory_page.h"
+
+void HashTableDirectoryPage::Init(page_id_t page_id, page_id_t bucket_page_id) {
+  page_id_ = page_id;
+  global_depth_ = 0;
+  entry_count_ = 0;
+  memset(local_depths_, 0, sizeof(local_depths_));
+  for (uint32_t i = 0; i < DIRECTORY_ARRAY_SIZE; i++) {
+    bucket_page_ids_[i] = INVALID_PAGE_ID;
+  }
+  bucket_page_ids_[0] = bucket_page_id;
+}
+
+void HashTableDirectoryPage::IncrGlobalDepth() {
+  uint32_t size = Size();
+  for (uint32_t i = 0; i < size; i++) {
+    bucket_page_ids_[i + size] = bucket_page_ids_[i];
+    local_depths_[i + size] = local_depths_[i];
+  }
+  global_depth_++;
+}
@@ -1,5 +1,7 @@
 #include "page/index_roots_page.h"
 
+#include "buffer/buffer_pool_manager.h"
+
 bool IndexRootsPage::Insert(const index_id_t index_id, const page_id_t root_id) {
   auto index = FindIndex(index_id);
   // check for duplicate index id
@@ -50,3 +52,25 @@ int IndexRootsPage::FindIndex(const index_id_t index_id) {
   }
   return -1;
 }
+
+void IndexRootsPage::WriteRootId(BufferPoolManager *buffer_pool_manager, index_id_t index_id, page_id_t root_id) {
+  Page *page = buffer_pool_manager->FetchPage(INDEX_ROOTS_PAGE_ID);
+  ASSERT(page != nullptr, "Cannot fetch the index roots page.");
+  auto *roots = reinterpret_cast<IndexRootsPage *>(page->GetData());
+  page->WLatch();
+  if (!roots->Update(index_id, root_id)) {
+    roots->Insert(index_id, root_id);
+  }
+  page->WUnlatch();
+  buffer_pool_manager->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+}
+
+void IndexRootsPage::EraseRootId(BufferPoolManager *buffer_pool_manager, index_id_t index_id) {
+  Page *page = buffer_pool_manager->FetchPage(INDEX_ROOTS_PAGE_ID);
+  ASSERT(page != nullptr, "Cannot fetch the index roots page.");
+  auto *roots = reinterpret_cast<IndexRootsPage *>(page->GetData());
+  page->WLatch();
+  roots->Delete(index_id);
+  page->WUnlatch();
+  buffer_pool_manager->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+}
@@ -43,6 +43,21 @@ bool TablePage::InsertTuple(Row &row, Schema *schema, Transaction *txn,
   return true;
 }
 
+bool TablePage::AppendTuple(Row &row, uint32_t serialized_size, Schema *schema) {
+  if (GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
+    return false;
+  }
+  uint32_t slot_num = GetTupleCount();
+  SetFreeSpacePointer(GetFreeSpacePointer() - serialized_size);
+  uint32_t __attribute__((unused)) write_bytes = row.SerializeTo(GetData() + GetFreeSpacePointer(), schema);
+  ASSERT(write_bytes == serialized_size, "Unexpected behavior in row serialize.");
+  SetTupleOffsetAtSlot(slot_num, GetFreeSpacePointer());
+  SetTupleSize(slot_num, serialized_size);
+  row.SetRowId(RowId(GetTablePageId(), slot_num));
+  SetTupleCount(slot_num + 1);
+  return true;
+}
+
 bool TablePage::MarkDelete(const RowId &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager) {
   uint32_t slot_num = rid.GetSlotNum();
   // If the slot number is invalid, abort.
@@ -84,6 +99,11 @@ bool TablePage::UpdateTuple(const Row &new_row, Row *old_row, Schema *schema,
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
   uint32_t __attribute__((unused)) read_bytes = old_row->DeserializeFrom(GetData() + tuple_offset, schema);
   ASSERT(tuple_size == read_bytes, "Unexpected behavior in tuple deserialize.");
+  // Same size: overwrite the bytes in place, no other tuple moves.
+  if (serialized_size == tuple_size) {
+    new_row.SerializeTo(GetData() + tuple_offset, schema);
+    return true;
+  }
   uint32_t free_space_pointer = GetFreeSpacePointer();
   ASSERT(tuple_offset >= free_space_pointer, "Offset should appear after current free space position.");
   memmove(GetData() + free_space_pointer + tuple_size - serialized_size, GetData() + free_space_pointer,
@@ -96,7 +116,7 @@ bool TablePage::UpdateTuple(const Row &new_row, Row *old_row, Schema *schema,
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
     uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
     if (GetTupleSize(i) > 0 && tuple_offset_i < tuple_offset + tuple_size) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - new_row.GetSerializedSize(schema));
+      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - serialized_size);
     }
   }
   return true;
@@ -165,6 +185,76 @@ bool TablePage::GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager
   return true;
 }
 
+bool TablePage::GetTupleView(uint32_t slot_num, Schema *schema, TupleView *view) {
+  if (slot_num >= GetTupleCount() || IsDeleted(GetTupleSize(slot_num))) {
+    return false;
+  }
+  *view = TupleView(GetData() + GetTupleOffsetAtSlot(slot_num), schema);
+  return true;
+}
+
+void TablePage::CompactSlots(std::vector<std::pair<uint32_t, uint32_t>> *moves) {
+  uint32_t tuple_count = GetTupleCount();
+  uint32_t hole = 0;
+  while (true) {
+    while (hole < tuple_count && GetTupleSize(hole) != 0) {
+      hole++;
+    }
+    while (tuple_count > 0 && GetTupleSize(tuple_count - 1) == 0) {
+      tuple_count--;
+    }
+    if (hole >= tuple_count) {
+      break;
+    }
+    // A tuple marked deleted keeps its slot until the delete commits.
+    uint32_t last = tuple_count - 1;
+    if (IsDeleted(GetTupleSize(last))) {
+      break;
+    }
+    // Only the slot changes, the tuple bytes stay where they are.
+    SetTupleOffsetAtSlot(hole, GetTupleOffsetAtSlot(last));
+    SetTupleSize(hole, GetTupleSize(last));
+    SetTupleOffsetAtSlot(last, 0);
+    SetTupleSize(last, 0);
+    moves->emplace_back(last, hole);
+  }
+  SetTupleCount(tuple_count);
+}
+
+bool TablePage::MergeInto(TablePage *dest, std::vector<std::pair<uint32_t, uint32_t>> *moves) {
+  uint32_t needed = 0;
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (tuple_size == 0) {
+      continue;
+    }
+    if (IsDeleted(tuple_size)) {
+      return false;
+    }
+    needed += tuple_size + SIZE_TUPLE;
+  }
+  if (needed > dest->GetFreeSpaceRemaining()) {
+    return false;
+  }
+  for (uint32_t i = 0; i < GetTupleCount(); i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (tuple_size == 0) {
+      continue;
+    }
+    // Copy the serialized tuple as it is into a new slot at the end of dest.
+    uint32_t slot_num = dest->GetTupleCount();
+    dest->SetFreeSpacePointer(dest->GetFreeSpacePointer() - tuple_size);
+    memcpy(dest->GetData() + dest->GetFreeSpacePointer(), GetData() + GetTupleOffsetAtSlot(i), tuple_size);
+    dest->SetTupleOffsetAtSlot(slot_num, dest->GetFreeSpacePointer());
+    dest->SetTupleSize(slot_num, tuple_size);
+    dest->SetTupleCount(slot_num + 1);
+    moves->emplace_back(i, slot_num);
+  }
+  SetFreeSpacePointer(PAGE_SIZE);
+  SetTupleCount(0);
+  return true;
+}
+
 bool TablePage::GetFirstTupleRid(RowId *first_rid) {
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); i++) {
@@ -52,6 +52,7 @@ uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
       fields_.push_back((Field *)mem_alloc);
     }
   }
+  delete[] null_map;
   return temp - buf;
 }
 
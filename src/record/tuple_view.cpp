@@ -0,0 +1,49 @@
+#include "record/tuple_view.h"
+
+const char *TupleView::FieldData(uint32_t i) const {
+  if (i < cursor_column_) {
+    Rewind();
+  }
+  //从上次停下的列接着往后走，null字段不占空间
+  for (; cursor_column_ < i; cursor_column_++) {
+    if (IsNull(cursor_column_)) {
+      continue;
+    }
+    switch (schema_->GetColumn(cursor_column_)->GetType()) {
+      case TypeId::kTypeInt:
+        cursor_data_ += sizeof(int32_t);
+        break;
+      case TypeId::kTypeFloat:
+        cursor_data_ += sizeof(float);
+        break;
+      default: {
+        uint32_t len = MACH_READ_UINT32(cursor_data_);
+        cursor_data_ += sizeof(uint32_t) + ((len & FIELD_OVERFLOW_FLAG) ? sizeof(page_id_t) : len);
+        break;
+      }
+    }
+  }
+  return cursor_data_;
+}
+
+Field TupleView::GetField(uint32_t i) const {
+  TypeId type = schema_->GetColumn(i)->GetType();
+  if (IsNull(i)) {
+    return Field(type);
+  }
+  switch (type) {
+    case TypeId::kTypeInt:
+      return Field(type, GetInteger(i));
+    case TypeId::kTypeFloat:
+      return Field(type, GetFloat(i));
+    default:
+      if (IsExternal(i)) {
+        return Field(type, GetLength(i), GetOverflowPageId(i));
+      }
+      return Field(type, const_cast<char *>(GetChars(i)), GetLength(i), false);
+  }
+}
+
+void TupleView::Materialize(Row *row) const {
+  row->DeserializeFrom(const_cast<char *>(buf_), schema_);
+}
@@ -236,6 +236,11 @@ CmpBool TypeFloat::CompareGreaterThanEquals(const Field &left, const Field &righ
 uint32_t TypeChar::SerializeTo(const Field &field, char *buf) const {
   if (!field.IsNull()) {
     uint32_t len = GetLength(field);
+    if (field.IsExternal()) {
+      MACH_WRITE_UINT32(buf, len | FIELD_OVERFLOW_FLAG);
+      MACH_WRITE_TO(page_id_t, buf + sizeof(uint32_t), field.overflow_page_id_);
+      return sizeof(uint32_t) + sizeof(page_id_t);
+    }
     memcpy(buf, &len, sizeof(uint32_t));
     memcpy(buf + sizeof(uint32_t), field.value_.chars_, len);
     return len + sizeof(uint32_t);
@@ -249,6 +254,11 @@ uint32_t TypeChar::DeserializeFrom(char *storage, Field **field, bool is_null, M
     return 0;
   }
   uint32_t len = MACH_READ_UINT32(storage);
+  if (len & FIELD_OVERFLOW_FLAG) {
+    *field = ALLOC_P(heap, Field)(TypeId::kTypeChar, len & ~FIELD_OVERFLOW_FLAG,
+                                  MACH_READ_FROM(page_id_t, storage + sizeof(uint32_t)));
+    return sizeof(uint32_t) + sizeof(page_id_t);
+  }
   *field = ALLOC_P(heap, Field)(TypeId::kTypeChar, storage + sizeof(uint32_t), len, true);
   return len + sizeof(uint32_t);
 }
@@ -257,6 +267,9 @@ uint32_t TypeChar::GetSerializedSize(const Field &field, bool is_null) const {
   if (is_null) {
     return 0;
   }
+  if (field.IsExternal()) {
+    return sizeof(uint32_t) + sizeof(page_id_t);
+  }
   uint32_t len = GetLength(field);
   return len + sizeof(uint32_t);
 }
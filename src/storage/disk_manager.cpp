@@ -1,4 +1,5 @@
 #include <sys/stat.h>
+#include <algorithm>
 #include <stdexcept>
 
 #include "glog/logging.h"
@@ -104,6 +105,32 @@ void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
   
 }
 
+void DiskManager::DeAllocatePages(std::vector<page_id_t> logical_page_ids) {
+  size_t PageNum = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
+  DiskFileMetaPage *MetaData = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  // sorted ids put the pages of one extent next to each other
+  std::sort(logical_page_ids.begin(), logical_page_ids.end());
+  size_t i = 0;
+  while (i < logical_page_ids.size()) {
+    uint32_t extent_id = logical_page_ids[i] / PageNum;
+    char NowBitMap[PAGE_SIZE];
+    ReadPhysicalPage((PageNum + 1) * extent_id + 1, NowBitMap);
+    auto *bitmap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(NowBitMap);
+    uint32_t freed = 0;
+    for (; i < logical_page_ids.size() && logical_page_ids[i] / PageNum == extent_id; i++) {
+      if (bitmap->DeAllocatePage(logical_page_ids[i] % PageNum)) {
+        freed++;
+      }
+    }
+    if (freed == 0) {
+      continue;
+    }
+    WritePhysicalPage((PageNum + 1) * extent_id + 1, NowBitMap);
+    MetaData->num_allocated_pages_ -= freed;
+    MetaData->extent_used_page_[extent_id] -= freed;
+  }
+}
+
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
   size_t PageNum = BitmapPage<PAGE_SIZE>::GetMaxSupportedSize();
   uint32_t extent_id = logical_page_id / PageNum;
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#include "storage/parallel_table_scan.h"
+#include "storage/table_heap.h"
+
+ParallelTableScan::ParallelTableScan(TableHeap *table_heap, std::vector<uint32_t> column_ids, Transaction *txn,
+                                     uint32_t morsel_pages)
+        : ParallelTableScan(table_heap, std::move(column_ids), txn, table_heap->GetPageIds(), morsel_pages) {}
+
+ParallelTableScan::ParallelTableScan(TableHeap *table_heap, std::vector<uint32_t> column_ids, Transaction *txn,
+                                     const std::vector<page_id_t> &page_ids, uint32_t morsel_pages)
+        : table_heap_(table_heap), column_ids_(std::move(column_ids)), txn_(txn) {
+  for (size_t i = 0; i < page_ids.size(); i += morsel_pages) {
+    size_t end = std::min(page_ids.size(), i + morsel_pages);
+    morsels_.emplace_back(page_ids.begin() + i, page_ids.begin() + end);
+  }
+}
+
+void ParallelTableScan::Run(const std::function<void(const RowBatch &, uint32_t)> &func, uint32_t workers) {
+  Dispatch([&](uint32_t morsel) {
+    RowBatch batch;
+    TableBatchIterator iter(table_heap_, column_ids_, txn_, morsels_[morsel]);
+    while (iter.Next(&batch)) {
+      func(batch, morsel);
+    }
+  }, workers);
+}
+
+void ParallelTableScan::RunTuples(const std::function<void(const TupleView &, const RowId &, uint32_t)> &func,
+                                  uint32_t workers) {
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  Schema *schema = table_heap_->schema_;
+  Dispatch([&](uint32_t morsel) {
+    for (auto page_id : morsels_[morsel]) {
+      auto page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id));
+      ASSERT(page != nullptr, "Can't have empty page!");
+      page->RLatch();
+      RowId rid;
+      TupleView view;
+      if (table_heap_->layout_ == kLayoutColumnar) {
+        //列存页里没有整行，先拼成行格式再给view看
+        auto columnar_page = reinterpret_cast<ColumnarPage *>(page);
+        std::vector<char> buf(PAGE_SIZE);
+        for (bool found = columnar_page->GetFirstTupleRid(&rid); found;
+             found = columnar_page->GetNextTupleRid(rid, &rid)) {
+          columnar_page->SerializeTuple(rid.GetSlotNum(), schema, buf.data());
+          func(TupleView(buf.data(), schema), rid, morsel);
+        }
+      } else {
+        for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+          page->GetTupleView(rid.GetSlotNum(), schema, &view);
+          func(view, rid, morsel);
+        }
+      }
+      page->RUnlatch();
+      buffer_pool_manager->UnpinPage(page_id, false);
+    }
+  }, workers);
+}
+
+void ParallelTableScan::Dispatch(const std::function<void(uint32_t)> &scan_morsel, uint32_t workers) {
+  if (workers == 0) {
+    workers = std::max(1u, std::thread::hardware_concurrency());
+  }
+  workers = std::min<uint32_t>(workers, morsels_.size());
+  std::atomic<uint32_t> next{0};
+  auto scan = [&]() {
+    for (uint32_t morsel = next++; morsel < morsels_.size(); morsel = next++) {
+      scan_morsel(morsel);
+    }
+  };
+  //调用线程自己也算一个worker
+  std::vector<std::thread> threads;
+  for (uint32_t i = 1; i < workers; i++) {
+    threads.emplace_back(scan);
+  }
+  scan();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
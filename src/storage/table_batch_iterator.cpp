@@ -0,0 +1,204 @@
+#include "storage/table_batch_iterator.h"
+#include "storage/table_heap.h"
+
+void ColumnVector::Clear() {
+  size_ = 0;
+  nulls_.clear();
+  integers_.clear();
+  floats_.clear();
+  offsets_.assign(1, 0);
+  chars_.clear();
+}
+
+void ColumnVector::SetNull(bool is_null) {
+  if (size_ % 64 == 0) {
+    nulls_.push_back(0);
+  }
+  if (is_null) {
+    nulls_.back() |= uint64_t(1) << (size_ % 64);
+  }
+  size_++;
+}
+
+void ColumnVector::AppendNull() {
+  switch (type_) {
+    case TypeId::kTypeInt:
+      integers_.push_back(0);
+      break;
+    case TypeId::kTypeFloat:
+      floats_.push_back(0);
+      break;
+    default:
+      offsets_.push_back(chars_.size());
+      break;
+  }
+  SetNull(true);
+}
+
+void ColumnVector::AppendInteger(int32_t value) {
+  integers_.push_back(value);
+  SetNull(false);
+}
+
+void ColumnVector::AppendFloat(float value) {
+  floats_.push_back(value);
+  SetNull(false);
+}
+
+void ColumnVector::AppendChars(const char *data, uint32_t len) {
+  chars_.insert(chars_.end(), data, data + len);
+  offsets_.push_back(chars_.size());
+  SetNull(false);
+}
+
+Field ColumnVector::GetField(uint32_t i) const {
+  if (IsNull(i)) {
+    return Field(type_);
+  }
+  switch (type_) {
+    case TypeId::kTypeInt:
+      return Field(type_, integers_[i]);
+    case TypeId::kTypeFloat:
+      return Field(type_, floats_[i]);
+    default: {
+      static char empty[1] = {'\0'};
+      char *data = GetLength(i) == 0 ? empty : const_cast<char *>(GetChars(i));
+      return Field(type_, data, GetLength(i), true);
+    }
+  }
+}
+
+TableBatchIterator::TableBatchIterator(TableHeap *table_heap, std::vector<uint32_t> column_ids, Transaction *txn,
+                                       uint32_t batch_size)
+        : table_heap_(table_heap),
+          column_ids_(std::move(column_ids)),
+          projection_(table_heap->schema_->GetColumnCount(), -1),
+          txn_(txn),
+          batch_size_(batch_size),
+          page_id_(table_heap->GetFirstPageId()),
+          follow_chain_(true) {
+  for (size_t i = 0; i < column_ids_.size(); i++) {
+    projection_[column_ids_[i]] = i;
+  }
+}
+
+TableBatchIterator::TableBatchIterator(TableHeap *table_heap, std::vector<uint32_t> column_ids, Transaction *txn,
+                                       std::vector<page_id_t> page_ids, uint32_t batch_size)
+        : TableBatchIterator(table_heap, std::move(column_ids), txn, batch_size) {
+  follow_chain_ = false;
+  page_ids_ = std::move(page_ids);
+  page_id_ = page_ids_.empty() ? INVALID_PAGE_ID : page_ids_[0];
+  page_index_ = 1;
+}
+
+bool TableBatchIterator::Next(RowBatch *batch) {
+  batch->row_ids_.clear();
+  if (batch->columns_.size() != column_ids_.size()) {
+    batch->columns_.clear();
+    for (auto column_id : column_ids_) {
+      batch->columns_.emplace_back(table_heap_->schema_->GetColumn(column_id)->GetType());
+    }
+  }
+  for (auto &column : batch->columns_) {
+    column.Clear();
+  }
+  BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
+  while (page_id_ != INVALID_PAGE_ID && batch->GetSize() < batch_size_) {
+    //一页只pin一次，读到批满或者页尾为止
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager->FetchPage(page_id_));
+    ASSERT(page != nullptr, "Can't have empty page!");
+    page->RLatch();
+    uint32_t tuple_count;
+    if (table_heap_->layout_ == kLayoutColumnar) {
+      auto columnar_page = reinterpret_cast<ColumnarPage *>(page);
+      tuple_count = columnar_page->GetSlotCount();
+      AppendMinipages(columnar_page, tuple_count, batch);
+    } else {
+      tuple_count = page->GetTupleCount();
+      for (; slot_ < tuple_count && batch->GetSize() < batch_size_; slot_++) {
+        if (TablePage::IsDeleted(page->GetTupleSize(slot_))) {
+          continue;
+        }
+        AppendTuple(TupleView(page->GetData() + page->GetTupleOffsetAtSlot(slot_), table_heap_->schema_), batch);
+        batch->row_ids_.emplace_back(page_id_, slot_);
+      }
+    }
+    page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager->UnpinPage(page_id_, false);
+    if (slot_ == tuple_count) {//这一页读完了
+      if (follow_chain_) {
+        page_id_ = next_page_id;
+      } else {
+        page_id_ = page_index_ < page_ids_.size() ? page_ids_[page_index_++] : INVALID_PAGE_ID;
+      }
+      slot_ = 0;
+    }
+  }
+  return batch->GetSize() > 0;
+}
+
+void TableBatchIterator::AppendTuple(const TupleView &view, RowBatch *batch) {
+  //列号递增地读，整条记录只走一遍；不投影的列只跳过，不反序列化
+  for (uint32_t i = 0; i < projection_.size(); i++) {
+    int position = projection_[i];
+    if (position < 0) {
+      continue;
+    }
+    ColumnVector &column = batch->columns_[position];
+    if (view.IsNull(i)) {
+      column.AppendNull();
+      continue;
+    }
+    switch (column.GetType()) {
+      case TypeId::kTypeInt:
+        column.AppendInteger(view.GetInteger(i));
+        break;
+      case TypeId::kTypeFloat:
+        column.AppendFloat(view.GetFloat(i));
+        break;
+      default:
+        if (view.IsExternal(i)) {
+          //只有投影到的列才去读溢出页
+          std::vector<char> value(view.GetLength(i));
+          table_heap_->ReadOverflow(view.GetOverflowPageId(i), value.size(), value.data());
+          column.AppendChars(value.data(), value.size());
+        } else {
+          column.AppendChars(view.GetChars(i), view.GetLength(i));
+        }
+        break;
+    }
+  }
+}
+
+void TableBatchIterator::AppendMinipages(ColumnarPage *page, uint32_t slot_count, RowBatch *batch) {
+  //先定下这一批取哪些slot，再逐列只读被投影列的minipage，别的列碰都不碰
+  std::vector<uint32_t> slots;
+  for (; slot_ < slot_count && batch->GetSize() + slots.size() < batch_size_; slot_++) {
+    if (page->IsLive(slot_)) {
+      slots.push_back(slot_);
+    }
+  }
+  Schema *schema = table_heap_->schema_;
+  for (size_t i = 0; i < column_ids_.size(); i++) {
+    ColumnVector &column = batch->columns_[i];
+    const char *nulls = page->GetNullFlags(column_ids_[i], schema);
+    const char *values = page->GetValues(column_ids_[i], schema);
+    uint32_t value_size = ColumnarPage::GetValueSize(schema->GetColumn(column_ids_[i]));
+    for (auto slot : slots) {
+      const char *value = values + slot * value_size;
+      if (nulls[slot]) {
+        column.AppendNull();
+      } else if (column.GetType() == TypeId::kTypeInt) {
+        column.AppendInteger(MACH_READ_FROM(int32_t, value));
+      } else if (column.GetType() == TypeId::kTypeFloat) {
+        column.AppendFloat(MACH_READ_FROM(float, value));
+      } else {
+        column.AppendChars(value + sizeof(uint32_t), MACH_READ_UINT32(value));
+      }
+    }
+  }
+  for (auto slot : slots) {
+    batch->row_ids_.emplace_back(page_id_, slot);
+  }
+}
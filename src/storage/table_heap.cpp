@@ -1,40 +1,292 @@
+#include <algorithm>
+
+#include "page/overflow_page.h"
 #include "storage/table_heap.h"
 
 bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
-  uint32_t record_len = row.GetSerializedSize(schema_); //得到row序列化的长度
-  if(record_len>TablePage::SIZE_MAX_ROW){
-    //极端情况下，只放一条记录（文件头+该记录偏移量+记录长度+记录），也放不下
-    return false;
+  uint32_t needed;
+  if (layout_ == kLayoutColumnar) {
+    //列存页的slot定长，值都留在页里，比列长的CHAR放不下
+    if (!ColumnarPage::Fits(row, schema_)) {
+      return false;
+    }
+    needed = ColumnarPage::GetSlotSize(schema_);
+  } else {
+    uint32_t record_len; //得到row存到页里的长度，长的CHAR值搬到溢出页之后
+    std::vector<uint32_t> overflow_columns = PlanOverflow(row, &record_len);
+    if(record_len>TablePage::SIZE_MAX_ROW){
+      //极端情况下，只放一条记录（文件头+该记录偏移量+记录长度+记录），也放不下
+      return false;
+    }
+    if (!overflow_columns.empty()) {//页里存的是只带溢出页指针的那一行
+      Row stored = MoveToOverflow(row, overflow_columns);
+      bool inserted = InsertTuple(stored, txn);
+      if (!inserted) {
+        FreeOverflow(stored);
+      }
+      row.SetRowId(stored.GetRowId());
+      return inserted;
+    }
+    needed = record_len + TablePage::SIZE_TUPLE;
   }
-    //把第一个page读出来
-  TablePage *NowPage = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  buffer_pool_manager_->UnpinPage(NowPage->GetPageId(),false);
-  while(1){//循环找到最近的能放的page
-    if(NowPage->InsertTuple(row,schema_,txn,lock_manager_,log_manager_)){
-      buffer_pool_manager_->UnpinPage(NowPage->GetPageId(),true);//设置为脏页
-      return true;//成功插入
+  //空闲空间表里直接挑一页空间足够的page，不再沿链表逐页尝试
+  uint32_t category = FreeSpaceMapPage::NeededCategory(needed);
+  while (category < FreeSpaceMapPage::CATEGORY_COUNT) {
+    if (free_pages_[category].empty()) {
+      category++;
+      continue;
     }
-    page_id_t NextPageId = NowPage->GetNextPageId();
-    if (NextPageId == INVALID_PAGE_ID){
-      break;
+    page_id_t page_id = *free_pages_[category].begin();
+    TablePage *NowPage = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    bool inserted = InsertIntoPage(NowPage, row, txn);
+    SetFreeSpace(page_id, FreeSpaceOf(NowPage));
+    buffer_pool_manager_->UnpinPage(page_id, inserted);
+    if (inserted) {
+      UpdateZone(page_id, row);
+      return true;//成功插入
     }
-    NowPage = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(NextPageId));
-    buffer_pool_manager_->UnpinPage(NowPage->GetPageId(),false);
+    category++;
   }
-  int new_page_id = INVALID_PAGE_ID;
-  buffer_pool_manager_->UnpinPage(NowPage->GetPageId(),true);//设置为脏页
+  //没有能放下的page，在链表末尾追加一页
+  page_id_t new_page_id = INVALID_PAGE_ID;
   TablePage *New_Page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
-  buffer_pool_manager_->UnpinPage(New_Page->GetPageId(),false);//解锁
-  if (New_Page==nullptr) return false;
+  if (New_Page == nullptr) return false;
   //完成双向连接
-  New_Page->Init(new_page_id,NowPage->GetPageId(),log_manager_,txn);
-  New_Page->InsertTuple(row,schema_,txn,lock_manager_,log_manager_);
-  buffer_pool_manager_->UnpinPage(New_Page->GetPageId(),true);//设置为脏页
-  NowPage->SetNextPageId(new_page_id);
-  buffer_pool_manager_->UnpinPage(NowPage->GetPageId(),true);//设置为脏页    
+  InitPage(New_Page, new_page_id, last_page_id_, txn);
+  InsertIntoPage(New_Page, row, txn);
+  SetFreeSpace(new_page_id, FreeSpaceOf(New_Page));
+  buffer_pool_manager_->UnpinPage(new_page_id, true);//设置为脏页
+  UpdateZone(new_page_id, row);
+  TablePage *LastPage = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
+  LastPage->SetNextPageId(new_page_id);
+  buffer_pool_manager_->UnpinPage(last_page_id_, true);//设置为脏页
+  SetLastPageId(new_page_id);
+  return true;
+}
+
+bool TableHeap::AppendBatch(std::vector<Row> &rows, Transaction *txn) {
+  std::vector<uint32_t> sizes;
+  sizes.reserve(rows.size());
+  std::vector<std::vector<uint32_t>> overflow_columns;
+  overflow_columns.reserve(rows.size());
+  bool has_overflow = false;
+  for (auto &row : rows) {//先检查所有记录，保证要么全部插入要么都不插
+    sizes.emplace_back();
+    if (layout_ == kLayoutColumnar) {//列存不用溢出页
+      overflow_columns.emplace_back();
+      if (!ColumnarPage::Fits(row, schema_)) {
+        return false;
+      }
+      continue;
+    }
+    overflow_columns.push_back(PlanOverflow(row, &sizes.back()));
+    has_overflow = has_overflow || !overflow_columns.back().empty();
+    if (sizes.back() > TablePage::SIZE_MAX_ROW) {
+      return false;
+    }
+  }
+  if (has_overflow) {//长值先写到溢出页，再追加只带指针的行
+    std::vector<Row> stored;
+    stored.reserve(rows.size());
+    for (size_t i = 0; i < rows.size(); i++) {
+      stored.push_back(overflow_columns[i].empty() ? rows[i] : MoveToOverflow(rows[i], overflow_columns[i]));
+    }
+    bool appended = AppendBatch(stored, txn);
+    for (size_t i = 0; i < rows.size(); i++) {
+      if (!appended && stored[i].GetRowId().GetPageId() == INVALID_PAGE_ID) {
+        FreeOverflow(stored[i]);
+      }
+      rows[i].SetRowId(stored[i].GetRowId());
+    }
+    return appended;
+  }
+  size_t i = 0;
+  page_id_t page_id = last_page_id_;
+  TablePage *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  while (true) {
+    //当前页一直写到放不下为止，整页只加一次锁
+    page->WLatch();
+    size_t first = i;
+    //列存页的slot定长，按空slot插入就是追加
+    while (i < rows.size() && (layout_ == kLayoutColumnar ? InsertIntoPage(page, rows[i], txn)
+                                                          : page->AppendTuple(rows[i], sizes[i], schema_))) {
+      i++;
+    }
+    page->WUnlatch();
+    SetFreeSpace(page_id, FreeSpaceOf(page));
+    //整页的zone在内存里放宽，最后只写一次
+    bool zone_changed = false;
+    for (size_t k = first; k < i && !zone_pages_.empty(); k++) {
+      zone_changed = WidenZone(fsm_slots_[page_id].index, rows[k]) || zone_changed;
+    }
+    if (zone_changed) {
+      WriteZone(fsm_slots_[page_id].index);
+    }
+    if (i == rows.size()) {
+      break;
+    }
+    //在末尾接一个新页，链好之后旧页才放掉
+    page_id_t new_page_id = INVALID_PAGE_ID;
+    TablePage *new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
+    if (new_page == nullptr) {
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      SetLastPageId(page_id);
+      return false;
+    }
+    InitPage(new_page, new_page_id, page_id, txn);
+    page->SetNextPageId(new_page_id);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    page_id = new_page_id;
+    page = new_page;
+  }
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  if (page_id != last_page_id_) {
+    SetLastPageId(page_id);
+  }
   return true;
 }
 
+void TableHeap::InitPage(TablePage *page, page_id_t page_id, page_id_t prev_id, Transaction *txn) {
+  if (layout_ == kLayoutColumnar) {
+    reinterpret_cast<ColumnarPage *>(page)->Init(page_id, prev_id, schema_);
+  } else {
+    page->Init(page_id, prev_id, log_manager_, txn);
+  }
+}
+
+bool TableHeap::InsertIntoPage(TablePage *page, Row &row, Transaction *txn) {
+  if (layout_ == kLayoutColumnar) {
+    return reinterpret_cast<ColumnarPage *>(page)->InsertTuple(row, schema_);
+  }
+  return page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+}
+
+uint32_t TableHeap::FreeSpaceOf(TablePage *page) {
+  if (layout_ == kLayoutColumnar) {
+    return reinterpret_cast<ColumnarPage *>(page)->GetFreeSpaceRemaining(schema_);
+  }
+  return page->GetFreeSpaceRemaining();
+}
+
+bool TableHeap::FirstTupleRid(TablePage *page, RowId *first_rid) {
+  if (layout_ == kLayoutColumnar) {
+    return reinterpret_cast<ColumnarPage *>(page)->GetFirstTupleRid(first_rid);
+  }
+  return page->GetFirstTupleRid(first_rid);
+}
+
+bool TableHeap::NextTupleRid(TablePage *page, const RowId &cur_rid, RowId *next_rid) {
+  if (layout_ == kLayoutColumnar) {
+    return reinterpret_cast<ColumnarPage *>(page)->GetNextTupleRid(cur_rid, next_rid);
+  }
+  return page->GetNextTupleRid(cur_rid, next_rid);
+}
+
+void TableHeap::CreateFreeSpaceMap() {
+  //新表只有第一页
+  last_page_id_ = first_page_id_;
+  InitZoneColumns();
+  page_id_t fsm_page_id;
+  auto *fsm = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(fsm_page_id)->GetData());
+  fsm->Init();
+  fsm->SetLastHeapPageId(last_page_id_);
+  if (!zone_columns_.empty()) {//zone map的链表头记在空闲空间表第一页上
+    page_id_t zone_page_id;
+    auto *zone_map = reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->NewPage(zone_page_id)->GetData());
+    zone_map->Init();
+    buffer_pool_manager_->UnpinPage(zone_page_id, true);
+    zone_pages_.push_back(zone_page_id);
+    fsm->SetZoneMapPageId(zone_page_id);
+  }
+  buffer_pool_manager_->UnpinPage(fsm_page_id, true);
+  fsm_pages_.push_back(fsm_page_id);
+}
+
+void TableHeap::LoadFreeSpaceMap(page_id_t fsm_page_id) {
+  InitZoneColumns();
+  uint32_t index = 0;
+  page_id_t page_id = fsm_page_id;
+  page_id_t zone_page_id = INVALID_PAGE_ID;
+  while (page_id != INVALID_PAGE_ID) {//沿空闲空间表的链表读入内存
+    auto *fsm = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    if (fsm_pages_.empty()) {
+      last_page_id_ = fsm->GetLastHeapPageId();
+      zone_page_id = fsm->GetZoneMapPageId();
+    }
+    fsm_pages_.push_back(page_id);
+    for (int i = 0; i < fsm->GetEntryCount(); i++, index++) {
+      fsm_slots_[fsm->PageIdAt(i)] = {index, fsm->CategoryAt(i)};
+      free_pages_[fsm->CategoryAt(i)].insert(fsm->PageIdAt(i));
+    }
+    page_id_t next_page_id = fsm->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  while (zone_page_id != INVALID_PAGE_ID) {//zone map也整个读进内存
+    auto *zone_map = reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->FetchPage(zone_page_id)->GetData());
+    zone_pages_.push_back(zone_page_id);
+    for (int i = 0; i < zone_map->GetEntryCount(); i++) {
+      ColumnZone *zones = zone_map->ZonesAt(i, zone_columns_.size());
+      zones_.insert(zones_.end(), zones, zones + zone_columns_.size());
+    }
+    page_id_t next_page_id = zone_map->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(zone_page_id, false);
+    zone_page_id = next_page_id;
+  }
+}
+
+void TableHeap::SetFreeSpace(page_id_t page_id, uint32_t free_space) {
+  uint8_t category = FreeSpaceMapPage::ToCategory(free_space);
+  auto slot = fsm_slots_.find(page_id);
+  if (slot != fsm_slots_.end()) {
+    if (slot->second.category == category) {//类别没变，不用写盘
+      return;
+    }
+    free_pages_[slot->second.category].erase(page_id);
+    free_pages_[category].insert(page_id);
+    slot->second.category = category;
+    page_id_t fsm_page_id = fsm_pages_[slot->second.index / FreeSpaceMapPage::MAX_ENTRY_COUNT];
+    auto *fsm = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_page_id)->GetData());
+    fsm->SetCategory(slot->second.index % FreeSpaceMapPage::MAX_ENTRY_COUNT, category);
+    buffer_pool_manager_->UnpinPage(fsm_page_id, true);
+    return;
+  }
+  //新page记在表尾，最后一页满了就再接一页
+  uint32_t index = fsm_slots_.size();
+  if (index / FreeSpaceMapPage::MAX_ENTRY_COUNT == fsm_pages_.size()) {
+    page_id_t new_fsm_page_id;
+    auto *new_fsm = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->NewPage(new_fsm_page_id)->GetData());
+    new_fsm->Init();
+    buffer_pool_manager_->UnpinPage(new_fsm_page_id, true);
+    auto *last_fsm = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_pages_.back())->GetData());
+    last_fsm->SetNextPageId(new_fsm_page_id);
+    buffer_pool_manager_->UnpinPage(fsm_pages_.back(), true);
+    fsm_pages_.push_back(new_fsm_page_id);
+  }
+  auto *fsm = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_pages_.back())->GetData());
+  fsm->Append(page_id, category);
+  buffer_pool_manager_->UnpinPage(fsm_pages_.back(), true);
+  fsm_slots_[page_id] = {index, category};
+  free_pages_[category].insert(page_id);
+  AppendZone();
+}
+
+std::vector<page_id_t> TableHeap::GetPageIds() const {
+  //新页总是接在链表末尾并同时登记进空闲空间表，所以登记顺序就是链表顺序
+  std::vector<page_id_t> page_ids(fsm_slots_.size());
+  for (auto &slot : fsm_slots_) {
+    page_ids[slot.second.index] = slot.first;
+  }
+  return page_ids;
+}
+
+void TableHeap::SetLastPageId(page_id_t page_id) {
+  last_page_id_ = page_id;
+  auto *fsm = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_pages_.front())->GetData());
+  fsm->SetLastHeapPageId(page_id);
+  buffer_pool_manager_->UnpinPage(fsm_pages_.front(), true);
+}
+
 bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
@@ -44,52 +296,82 @@ bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
   }
   // Otherwise, mark the tuple as deleted.
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  if (layout_ == kLayoutColumnar) {
+    reinterpret_cast<ColumnarPage *>(page)->MarkDelete(rid);
+  } else {
+    page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
   return true;
 }
 
 bool TableHeap::UpdateTuple(Row &row, const RowId &rid, Transaction *txn) {
+  if (layout_ == kLayoutColumnar) {//列存的值位置固定，总是在原slot里改
+    auto page = reinterpret_cast<ColumnarPage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+    if (page == nullptr) {
+      return false;
+    }
+    page->WLatch();
+    bool updated = page->UpdateTuple(row, rid, schema_);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), updated);
+    if (updated) {
+      row.SetRowId(rid);
+      UpdateZone(rid.GetPageId(), row);
+    }
+    return updated;
+  }
+  uint32_t size;
+  std::vector<uint32_t> overflow_columns = PlanOverflow(row, &size);
+  if (!overflow_columns.empty()) {//新值里长的CHAR先写到溢出页
+    Row stored = MoveToOverflow(row, overflow_columns);
+    bool updated = UpdateTuple(stored, rid, txn);
+    if (!updated) {
+      FreeOverflow(stored);
+    }
+    row.SetRowId(stored.GetRowId());
+    return updated;
+  }
   //先找到旧的记录所在页
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  if(page==nullptr){//找不到这个记录
+  if (page == nullptr) {//找不到这个记录
     return false;
   }
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
-  //找的到
   Row old_row(rid);  //把原来的row存下来,方便rollback
-  bool Isupdate;//保存子函数结果
-  Isupdate=page->UpdateTuple(row, &old_row, schema_, txn, lock_manager_, log_manager_);
-  if(Isupdate){//成功更新
-    //RowId new_row_id (rid.GetPageId(),row.GetRowId().GetSlotNum());
+  std::vector<page_id_t> old_overflow;
+  page->WLatch();
+  //放得下就在原slot里改，rowid不变，只写这一页
+  CollectOverflow(page, rid.GetSlotNum(), &old_overflow);
+  if (page->UpdateTuple(row, &old_row, schema_, txn, lock_manager_, log_manager_)) {
+    page->WUnlatch();
     row.SetRowId(rid);
-    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
-    ASSERT(row.GetRowId().GetPageId()!=INVALID_PAGE_ID, "cuocuocuo in page!");
-    return true;
-  }else{//更新失败
-    uint32_t serialized_size = row.GetSerializedSize(schema_);
-    ASSERT(serialized_size > 0, "Can not have empty row.");
-    uint32_t slot_num = old_row.GetRowId().GetSlotNum();
-    uint32_t tuple_size = page->GetTupleSize(slot_num);
-    if(slot_num>=page->GetTupleCount() || TablePage::IsDeleted(tuple_size)){
-      buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
-      return false;
-    }else{//因为空间不足导致插入失败
-      //page_id_t next_page_id=page->GetNextPageId();
-      //auto next_page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      bool isInsert;
-      isInsert=InsertTuple(row,txn);//判断有没有成功插入
-      ASSERT(row.GetRowId().GetPageId()!=INVALID_PAGE_ID, "cuocuocuo OutPage!!!");
-      //当前无法插入可以直接调用插入函数插到别的地方，但同时rid会被修改，所以更改了参数类型
-      if(isInsert)
-        MarkDelete(rid,txn);//将旧记录处标记为删除
-      buffer_pool_manager_->UnpinPage(page->GetTablePageId(), isInsert);
-      return isInsert;
+    SetFreeSpace(rid.GetPageId(), page->GetFreeSpaceRemaining());
+    buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+    UpdateZone(rid.GetPageId(), row);//旧值还算在zone里，只放宽不收窄
+    for (auto overflow_page_id : old_overflow) {//旧值的溢出页没人用了
+      FreeOverflow(overflow_page_id);
     }
+    return true;
   }
-
-  //return false;
+  uint32_t slot_num = rid.GetSlotNum();
+  bool exists = slot_num < page->GetTupleCount() && !TablePage::IsDeleted(page->GetTupleSize(slot_num));
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+  if (!exists) {
+    return false;
+  }
+  //本页空间不足，插到别的页再删掉旧记录，row的rowid会变成新位置
+  if (!InsertTuple(row, txn)) {
+    return false;
+  }
+  ASSERT(row.GetRowId().GetPageId() != INVALID_PAGE_ID, "Updated row must have a page.");
+  MarkDelete(rid, txn);
+  //没有事务来提交删除，旧记录当场删掉，否则它的槽位和溢出页永远不会回收
+  if (txn == nullptr) {
+    ApplyDelete(rid, txn);
+  }
+  return true;
 }
 
 void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
@@ -97,8 +379,18 @@ void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
   // Step2: Delete the tuple from the page.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   assert(page!=nullptr);
-  page->ApplyDelete(rid,txn,log_manager_);
+  std::vector<page_id_t> overflow;//记录删掉后它的溢出页也一起释放
+  if (layout_ == kLayoutColumnar) {
+    reinterpret_cast<ColumnarPage *>(page)->ApplyDelete(rid);
+  } else {
+    CollectOverflow(page, rid.GetSlotNum(), &overflow);
+    page->ApplyDelete(rid,txn,log_manager_);
+  }
+  SetFreeSpace(rid.GetPageId(), FreeSpaceOf(page));
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(),true);
+  for (auto overflow_page_id : overflow) {
+    FreeOverflow(overflow_page_id);
+  }
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
@@ -107,35 +399,247 @@ void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
   assert(page != nullptr);
   // Rollback the delete.
   page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
+  if (layout_ == kLayoutColumnar) {
+    reinterpret_cast<ColumnarPage *>(page)->RollbackDelete(rid);
+  } else {
+    page->RollbackDelete(rid, txn, log_manager_);
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
 void TableHeap::FreeHeap() {
   //把第一个page读出来
-  TablePage *NowPage = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  while(1){//循环找到最近的能放的page
-    buffer_pool_manager_->UnpinPage(NowPage->GetPageId(),true);//设置为脏页
+  std::vector<page_id_t> pages;
+  page_id_t NowPageId = first_page_id_;
+  while (NowPageId != INVALID_PAGE_ID) {//沿链表收集所有page
+    pages.push_back(NowPageId);
+    TablePage *NowPage = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(NowPageId));
+    std::vector<page_id_t> overflow;//每条记录的溢出页也要释放，列存没有溢出页
+    for (uint32_t slot = 0; layout_ == kLayoutRow && slot < NowPage->GetTupleCount(); slot++) {
+      CollectOverflow(NowPage, slot, &overflow);
+    }
+    for (auto overflow_page_id : overflow) {
+      CollectOverflowChain(overflow_page_id, &pages);
+    }
     page_id_t NextPageId = NowPage->GetNextPageId();//找到下一页
-    buffer_pool_manager_->DeletePage(NowPage->GetPageId());//删到这一页
-    if (NextPageId == INVALID_PAGE_ID){
-      return;
+    buffer_pool_manager_->UnpinPage(NowPageId, false);
+    NowPageId = NextPageId;
+  }
+  pages.insert(pages.end(), fsm_pages_.begin(), fsm_pages_.end());//空闲空间表和zone map一起释放
+  pages.insert(pages.end(), zone_pages_.begin(), zone_pages_.end());
+  buffer_pool_manager_->DeletePages(pages);//一次性释放
+}
+
+uint32_t TableHeap::Vacuum(std::vector<std::pair<RowId, RowId>> *moved, Transaction *txn) {
+  if (layout_ == kLayoutColumnar) {//列存页的空slot本来就会被重用
+    return 0;
+  }
+  std::vector<std::pair<page_id_t, uint32_t>> kept;//留下的页和它们的空闲空间
+  std::vector<page_id_t> freed;
+  std::vector<std::pair<uint32_t, uint32_t>> slot_moves;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  TablePage *prev_page = nullptr;//前一页一直pin着，后面的页往里并
+  page_id_t page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    page->WLatch();
+    page_id_t next_page_id = page->GetNextPageId();
+    slot_moves.clear();
+    if (prev_page != nullptr && page->MergeInto(prev_page, &slot_moves)) {
+      //整页并进前一页，从链表上摘掉
+      for (auto &slot_move : slot_moves) {
+        moved->emplace_back(RowId(page_id, slot_move.first), RowId(prev_page_id, slot_move.second));
+      }
+      prev_page->SetNextPageId(next_page_id);
+      if (next_page_id != INVALID_PAGE_ID) {
+        auto next_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+        next_page->SetPrevPageId(prev_page_id);
+        buffer_pool_manager_->UnpinPage(next_page_id, true);
+      }
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      freed.push_back(page_id);
+    } else {
+      //并不进去就在页内把slot压紧，它成为新的前一页
+      page->CompactSlots(&slot_moves);
+      for (auto &slot_move : slot_moves) {
+        moved->emplace_back(RowId(page_id, slot_move.first), RowId(page_id, slot_move.second));
+      }
+      if (prev_page != nullptr) {
+        kept.emplace_back(prev_page_id, prev_page->GetFreeSpaceRemaining());
+        prev_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(prev_page_id, true);
+      }
+      prev_page = page;
+      prev_page_id = page_id;
+    }
+    page_id = next_page_id;
+  }
+  kept.emplace_back(prev_page_id, prev_page->GetFreeSpaceRemaining());
+  prev_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(prev_page_id, true);
+  uint32_t freed_count = freed.size();
+  freed.insert(freed.end(), fsm_pages_.begin() + 1, fsm_pages_.end());//空闲空间表只留第一页，重写
+  fsm_pages_.resize(1);
+  if (!zone_pages_.empty()) {//zone map也一样
+    freed.insert(freed.end(), zone_pages_.begin() + 1, zone_pages_.end());
+    zone_pages_.resize(1);
+  }
+  buffer_pool_manager_->DeletePages(freed);
+  RebuildFreeSpaceMap(kept);
+  return freed_count;
+}
+
+bool TableHeap::NeedsVacuum() const {
+  if (layout_ == kLayoutColumnar) {
+    return false;
+  }
+  if (fsm_slots_.size() < static_cast<size_t>(AUTO_VACUUM_MIN_PAGES)) {
+    return false;
+  }
+  //按类别估计，每页至少有category * CATEGORY_SIZE字节空闲
+  uint64_t free_bytes = 0;
+  for (uint32_t category = 0; category < FreeSpaceMapPage::CATEGORY_COUNT; category++) {
+    free_bytes += static_cast<uint64_t>(category) * FreeSpaceMapPage::CATEGORY_SIZE * free_pages_[category].size();
+  }
+  return free_bytes * 100 >= static_cast<uint64_t>(AUTO_VACUUM_FREE_PERCENT) * PAGE_SIZE * fsm_slots_.size();
+}
+
+void TableHeap::RebuildFreeSpaceMap(const std::vector<std::pair<page_id_t, uint32_t>> &pages) {
+  fsm_slots_.clear();
+  for (auto &category_pages : free_pages_) {
+    category_pages.clear();
+  }
+  auto *fsm = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(fsm_pages_.front())->GetData());
+  fsm->Init();
+  if (!zone_pages_.empty()) {
+    fsm->SetZoneMapPageId(zone_pages_.front());
+    auto *zone_map = reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->FetchPage(zone_pages_.front())->GetData());
+    zone_map->Init();
+    buffer_pool_manager_->UnpinPage(zone_pages_.front(), true);
+  }
+  buffer_pool_manager_->UnpinPage(fsm_pages_.front(), true);
+  zones_.clear();
+  SetLastPageId(pages.back().first);
+  for (auto &page : pages) {
+    SetFreeSpace(page.first, page.second);
+  }
+  //搬过的页zone重新算，删掉的值不再占着范围
+  for (auto &page : pages) {
+    RecomputeZone(page.first);
+  }
+}
+
+void TableHeap::InitZoneColumns() {
+  zone_positions_.assign(schema_->GetColumnCount(), -1);
+  for (uint32_t i = 0; i < schema_->GetColumnCount() && zone_columns_.size() < ZONE_MAP_MAX_COLUMNS; i++) {
+    TypeId type = schema_->GetColumn(i)->GetType();
+    if (type == TypeId::kTypeInt || type == TypeId::kTypeFloat) {
+      zone_positions_[i] = zone_columns_.size();
+      zone_columns_.push_back(i);
     }
-    NowPage = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(NextPageId));
   }
 }
 
+void TableHeap::AppendZone() {
+  if (zone_pages_.empty()) {
+    return;
+  }
+  for (auto column_id : zone_columns_) {
+    zones_.push_back(ColumnZone::Empty(schema_->GetColumn(column_id)->GetType()));
+  }
+  const ColumnZone *zones = zones_.data() + zones_.size() - zone_columns_.size();
+  auto *zone_map = reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->FetchPage(zone_pages_.back())->GetData());
+  if (zone_map->Append(zones, zone_columns_.size()) < 0) {//最后一页满了就再接一页
+    page_id_t new_page_id;
+    auto *new_zone_map = reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->NewPage(new_page_id)->GetData());
+    new_zone_map->Init();
+    new_zone_map->Append(zones, zone_columns_.size());
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+    zone_map->SetNextPageId(new_page_id);
+    buffer_pool_manager_->UnpinPage(zone_pages_.back(), true);
+    zone_pages_.push_back(new_page_id);
+    return;
+  }
+  buffer_pool_manager_->UnpinPage(zone_pages_.back(), true);
+}
+
+bool TableHeap::WidenZone(uint32_t index, const Row &row) {
+  bool changed = false;
+  for (size_t i = 0; i < zone_columns_.size(); i++) {
+    changed = zones_[index * zone_columns_.size() + i].Widen(*row.GetField(zone_columns_[i])) || changed;
+  }
+  return changed;
+}
+
+void TableHeap::WriteZone(uint32_t index) {
+  uint32_t per_page = ZoneMapPage::MaxEntryCount(zone_columns_.size());
+  page_id_t zone_page_id = zone_pages_[index / per_page];
+  auto *zone_map = reinterpret_cast<ZoneMapPage *>(buffer_pool_manager_->FetchPage(zone_page_id)->GetData());
+  memcpy(zone_map->ZonesAt(index % per_page, zone_columns_.size()), zones_.data() + index * zone_columns_.size(),
+         zone_columns_.size() * sizeof(ColumnZone));
+  buffer_pool_manager_->UnpinPage(zone_page_id, true);
+}
+
+void TableHeap::UpdateZone(page_id_t page_id, const Row &row) {
+  if (zone_pages_.empty()) {
+    return;
+  }
+  uint32_t index = fsm_slots_[page_id].index;
+  if (WidenZone(index, row)) {//范围没变就不用写盘
+    WriteZone(index);
+  }
+}
+
+void TableHeap::RecomputeZone(page_id_t page_id) {
+  if (zone_pages_.empty()) {
+    return;
+  }
+  uint32_t index = fsm_slots_[page_id].index;
+  for (size_t i = 0; i < zone_columns_.size(); i++) {
+    zones_[index * zone_columns_.size() + i] = ColumnZone::Empty(schema_->GetColumn(zone_columns_[i])->GetType());
+  }
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  RowId rid;
+  TupleView view;
+  for (bool found = page->GetFirstTupleRid(&rid); found; found = page->GetNextTupleRid(rid, &rid)) {
+    page->GetTupleView(rid.GetSlotNum(), schema_, &view);
+    for (size_t i = 0; i < zone_columns_.size(); i++) {
+      zones_[index * zone_columns_.size() + i].Widen(view.GetField(zone_columns_[i]));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  WriteZone(index);
+}
+
+bool TableHeap::GetZone(page_id_t page_id, uint32_t column_id, ColumnZone *zone) const {
+  auto slot = fsm_slots_.find(page_id);
+  if (zone_pages_.empty() || column_id >= zone_positions_.size() || zone_positions_[column_id] < 0 ||
+      slot == fsm_slots_.end()) {
+    return false;
+  }
+  *zone = zones_[slot->second.index * zone_columns_.size() + zone_positions_[column_id]];
+  return true;
+}
+
 bool TableHeap::GetTuple(Row *row, Transaction *txn) {
   auto page=reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(row->GetRowId().GetPageId()));
   if(page==nullptr){
     return false;
   }else{
     bool isGet;
-    isGet=page->GetTuple(row,schema_,txn,lock_manager_);
+    if (layout_ == kLayoutColumnar) {
+      isGet = reinterpret_cast<ColumnarPage *>(page)->GetTuple(row, schema_);
+    } else {
+      isGet=page->GetTuple(row,schema_,txn,lock_manager_);
+    }
     
 
     buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+    if (isGet) {//整行读取，溢出页里的值也取回来
+      FetchOverflow(row);
+    }
     return isGet;
   }
   return false;
@@ -150,7 +654,7 @@ TableIterator TableHeap::Begin(Transaction *txn) {
   ///First_Page_ID CHANGES.
   while(page_id!=INVALID_PAGE_ID){
     auto page=static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
-    auto isFound=page->GetFirstTupleRid(&FirstId);
+    auto isFound=FirstTupleRid(page,&FirstId);
     buffer_pool_manager_->UnpinPage(page_id,false);
     if(isFound){
       break;
@@ -166,3 +670,124 @@ TableIterator TableHeap::End() {
   return TableIterator(this,RowId(INVALID_ROWID));
 }
 
+void TableHeap::FetchOverflow(Field *field) {
+  if (!field->IsExternal()) {
+    return;
+  }
+  std::vector<char> value(field->GetLength());
+  ReadOverflow(field->GetOverflowPageId(), value.size(), value.data());
+  Field fetched(TypeId::kTypeChar, value.data(), value.size(), true);
+  Swap(*field, fetched);
+}
+
+void TableHeap::FetchOverflow(Row *row) {
+  for (auto field : row->GetFields()) {
+    FetchOverflow(field);
+  }
+}
+
+std::vector<uint32_t> TableHeap::PlanOverflow(Row &row, uint32_t *size) {
+  std::vector<uint32_t> columns;
+  *size = row.GetSerializedSize(schema_);
+  if (*size <= TOAST_ROW_THRESHOLD) {
+    return columns;
+  }
+  //从最长的CHAR值开始搬，直到行够小，换成指针后变长的值不搬
+  for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+    Field *field = row.GetField(i);
+    if (field->GetType() == TypeId::kTypeChar && !field->IsNull() && !field->IsExternal() &&
+        field->GetLength() > sizeof(page_id_t)) {
+      columns.push_back(i);
+    }
+  }
+  std::sort(columns.begin(), columns.end(), [&row](uint32_t a, uint32_t b) {
+    return row.GetField(a)->GetLength() > row.GetField(b)->GetLength();
+  });
+  size_t count = 0;
+  while (count < columns.size() && *size > TOAST_ROW_THRESHOLD) {
+    *size -= row.GetField(columns[count++])->GetLength() - sizeof(page_id_t);
+  }
+  columns.resize(count);
+  return columns;
+}
+
+Row TableHeap::MoveToOverflow(Row &row, const std::vector<uint32_t> &columns) {
+  std::vector<Field> fields;
+  fields.reserve(row.GetFieldCount());
+  for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+    Field *field = row.GetField(i);
+    if (std::find(columns.begin(), columns.end(), i) == columns.end()) {
+      fields.emplace_back(*field);
+    } else {
+      fields.emplace_back(TypeId::kTypeChar, field->GetLength(), WriteOverflow(field->GetData(), field->GetLength()));
+    }
+  }
+  Row stored(fields);
+  stored.SetRowId(row.GetRowId());
+  return stored;
+}
+
+page_id_t TableHeap::WriteOverflow(const char *data, uint32_t len) {
+  //从最后一段往前写，每页写的时候已经知道下一页，只pin一次
+  page_id_t next_page_id = INVALID_PAGE_ID;
+  uint32_t pages = (len + OverflowPage::MAX_DATA_SIZE - 1) / OverflowPage::MAX_DATA_SIZE;
+  for (uint32_t i = pages; i > 0; i--) {
+    uint32_t offset = (i - 1) * OverflowPage::MAX_DATA_SIZE;
+    page_id_t page_id;
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->NewPage(page_id)->GetData());
+    page->Init(data + offset, std::min(len - offset, OverflowPage::MAX_DATA_SIZE));
+    page->SetNextPageId(next_page_id);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    next_page_id = page_id;
+  }
+  return next_page_id;
+}
+
+void TableHeap::ReadOverflow(page_id_t page_id, uint32_t len, char *data) {
+  uint32_t offset = 0;
+  while (page_id != INVALID_PAGE_ID && offset < len) {
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    memcpy(data + offset, page->GetData(), page->GetDataSize());
+    offset += page->GetDataSize();
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+void TableHeap::CollectOverflow(TablePage *page, uint32_t slot, std::vector<page_id_t> *overflow) {
+  if (slot >= page->GetTupleCount() || page->GetTupleSize(slot) == 0) {
+    return;
+  }
+  //标记删除的记录也还占着它的溢出页
+  TupleView view(page->GetData() + page->GetTupleOffsetAtSlot(slot), schema_);
+  for (uint32_t i = 0; i < schema_->GetColumnCount(); i++) {
+    if (schema_->GetColumn(i)->GetType() == TypeId::kTypeChar && !view.IsNull(i) && view.IsExternal(i)) {
+      overflow->push_back(view.GetOverflowPageId(i));
+    }
+  }
+}
+
+void TableHeap::CollectOverflowChain(page_id_t page_id, std::vector<page_id_t> *pages) {
+  while (page_id != INVALID_PAGE_ID) {
+    pages->push_back(page_id);
+    auto page = reinterpret_cast<OverflowPage *>(buffer_pool_manager_->FetchPage(page_id)->GetData());
+    page_id_t next_page_id = page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+void TableHeap::FreeOverflow(page_id_t page_id) {
+  std::vector<page_id_t> pages;
+  CollectOverflowChain(page_id, &pages);
+  buffer_pool_manager_->DeletePages(pages);
+}
+
+void TableHeap::FreeOverflow(Row &row) {
+  for (auto field : row.GetFields()) {
+    if (field->IsExternal()) {
+      FreeOverflow(field->GetOverflowPageId());
+    }
+  }
+}
@@ -58,7 +58,7 @@ TableIterator &TableIterator::operator++() {
   //õǰrecordҳ
   RowId NextId;//õһrecordrid
   bool isGet;
-  isGet=page->GetNextTupleRid(row->GetRowId(),&NextId);
+  isGet=table_heap->NextTupleRid(page,row->GetRowId(),&NextId);
   //Row Nextrow(NextId);
   if(!isGet){//Ҳһ¼
     //ǰ¼Ϊһҳһ¼S
@@ -66,7 +66,7 @@ TableIterator &TableIterator::operator++() {
       auto next_page=static_cast<TablePage *>(buffer_pool_manager->FetchPage(page->GetNextPageId()));
       buffer_pool_manager->UnpinPage(page->GetTablePageId(),false);//д
       page=next_page;
-      if(page->GetFirstTupleRid(&NextId)){
+      if(table_heap->FirstTupleRid(page,&NextId)){
         break;//ҵnext
       }
     }
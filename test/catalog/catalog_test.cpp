@@ -137,3 +137,238 @@ TEST(CatalogTest, CatalogIndexTest) {
   }
   delete db_02;
 }
+
+TEST(CatalogTest, CatalogLongKeyIndexTest) {
+  SimpleMemHeap heap;
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  TableInfo *table_info = nullptr;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 200, 1, true, false),
+          ALLOC_COLUMN(heap)("comment", TypeId::kTypeChar, 300, 2, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  catalog_01->CreateTable("table-1", schema.get(), &txn, table_info);
+  ASSERT_TRUE(table_info != nullptr);
+  // a key that does not fit in the largest key type is rejected up front
+  IndexInfo *index_info = nullptr;
+  std::vector<std::string> too_long_keys{"comment"};
+  ASSERT_EQ(DB_INDEX_KEY_TOO_LONG, catalog_01->CreateIndex("table-1", "index-0", too_long_keys, &txn, index_info));
+  std::vector<std::string> index_keys{"name"};
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-1", index_keys, &txn, index_info, false));
+  std::string prefix(190, 'x');
+  for (int i = 0; i < 100; i++) {
+    std::string name = prefix + std::to_string(i / 2 + 10);
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(row, RowId(1000, i), nullptr));
+  }
+  std::string name = prefix + "20";
+  std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+  Row key(fields);
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, ret, &txn));
+  ASSERT_EQ(2, ret.size());
+  ASSERT_EQ(RowId(1000, 20).Get(), ret[0].Get());
+  ASSERT_EQ(RowId(1000, 21).Get(), ret[1].Get());
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanRange(nullptr, &key, ret, &txn));
+  ASSERT_EQ(22, ret.size());
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanRange(&key, nullptr, ret, &txn));
+  ASSERT_EQ(80, ret.size());
+  delete db_01;
+}
+
+TEST(CatalogTest, CatalogCoveringIndexTest) {
+  SimpleMemHeap heap;
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  TableInfo *table_info = nullptr;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false),
+          ALLOC_COLUMN(heap)("comment", TypeId::kTypeChar, 250, 2, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  catalog_01->CreateTable("table-1", schema.get(), &txn, table_info);
+  ASSERT_TRUE(table_info != nullptr);
+  // included columns count towards the key size
+  IndexInfo *index_info = nullptr;
+  std::vector<std::string> index_keys{"id"};
+  std::vector<std::string> too_long_include{"comment"};
+  ASSERT_EQ(DB_INDEX_KEY_TOO_LONG,
+            catalog_01->CreateIndex("table-1", "index-0", index_keys, &txn, index_info, false, too_long_include));
+  std::vector<std::string> include_keys{"name"};
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-1", index_keys, &txn, index_info, false, include_keys));
+  for (int i = 0; i < 100; i++) {
+    std::string name = "name-" + std::to_string(i);
+    std::vector<Field> fields{
+            Field(TypeId::kTypeInt, i / 2),
+            Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)
+    };
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->InsertEntry(row, RowId(1000, i), nullptr));
+  }
+  // removal only needs the key columns
+  std::vector<Field> key_fields{Field(TypeId::kTypeInt, 10)};
+  Row key(key_fields);
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->RemoveEntry(key, RowId(1000, 21), nullptr));
+  delete db_01;
+  // the included columns survive a reload
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  auto &catalog_02 = db_02->catalog_mgr_;
+  IndexInfo *index_info_02 = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetIndex("table-1", "index-1", index_info_02));
+  ASSERT_EQ(1, index_info_02->GetIncludeMapping().size());
+  ASSERT_EQ(1, index_info_02->GetIncludeMapping()[0]);
+  std::vector<Row> entries;
+  ASSERT_EQ(DB_SUCCESS, index_info_02->GetIndex()->ScanRangeEntries(&key, &key, entries, &txn));
+  ASSERT_EQ(1, entries.size());
+  ASSERT_EQ(2, entries[0].GetFieldCount());
+  ASSERT_EQ(10, entries[0].GetField(0)->GetInteger());
+  ASSERT_EQ(std::string("name-20"), std::string(entries[0].GetField(1)->GetChars(), entries[0].GetField(1)->GetLength()));
+  ASSERT_EQ(RowId(1000, 20).Get(), entries[0].GetRowId().Get());
+  entries.clear();
+  ASSERT_EQ(DB_SUCCESS, index_info_02->GetIndex()->ScanRangeEntries(nullptr, &key, entries, &txn));
+  ASSERT_EQ(21, entries.size());
+  ASSERT_EQ(std::string("name-19"), std::string(entries[19].GetField(1)->GetChars(), entries[19].GetField(1)->GetLength()));
+  delete db_02;
+}
+
+TEST(CatalogTest, CatalogBuildIndexesTest) {
+  SimpleMemHeap heap;
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  TableInfo *table_info = nullptr;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  catalog_01->CreateTable("table-1", schema.get(), &txn, table_info);
+  ASSERT_TRUE(table_info != nullptr);
+  const int n = 2000;
+  for (int i = 0; i < n; i++) {
+    std::string name = "name-" + std::to_string(i % 100);
+    std::vector<Field> fields{
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)
+    };
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+  }
+  // three indexes of different kinds filled from one scan
+  std::vector<std::string> id_keys{"id"}, name_keys{"name"};
+  std::vector<IndexInfo *> indexes(3);
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-id", id_keys, &txn, indexes[0]));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-name", name_keys, &txn, indexes[1], false, id_keys));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-art", id_keys, &txn, indexes[2], true, {}, "art"));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->BuildIndexes(table_info, indexes, &txn));
+  for (int i = 0; i < n; i += 7) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row key(fields);
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, indexes[0]->GetIndex()->ScanKey(key, ret, &txn));
+    ASSERT_EQ(DB_SUCCESS, indexes[2]->GetIndex()->ScanKey(key, ret, &txn));
+    ASSERT_EQ(2, ret.size());
+    ASSERT_EQ(ret[0].Get(), ret[1].Get());
+  }
+  std::string name = "name-42";
+  std::vector<Field> name_fields{Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+  Row name_key(name_fields);
+  std::vector<Row> entries;
+  ASSERT_EQ(DB_SUCCESS, indexes[1]->GetIndex()->ScanRangeEntries(&name_key, &name_key, entries, &txn));
+  ASSERT_EQ(n / 100, entries.size());
+  for (auto &entry : entries) {
+    ASSERT_EQ(42, entry.GetField(1)->GetInteger() % 100);
+  }
+  delete db_01;
+  // the ART index is rebuilt from the table on load
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  IndexInfo *art_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, db_02->catalog_mgr_->GetIndex("table-1", "index-art", art_info));
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, art_info->GetIndex()->ScanRange(nullptr, nullptr, ret, &txn));
+  ASSERT_EQ(n, ret.size());
+  delete db_02;
+}
+
+TEST(CatalogTest, CatalogVacuumTableTest) {
+  SimpleMemHeap heap;
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  TableInfo *table_info = nullptr;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  catalog_01->CreateTable("table-1", schema.get(), &txn, table_info);
+  std::vector<std::string> id_keys{"id"}, name_keys{"name"};
+  std::vector<IndexInfo *> indexes(2);
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-id", id_keys, &txn, indexes[0]));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("table-1", "index-name", name_keys, &txn, indexes[1], false, id_keys));
+  const int n = 3000;
+  std::vector<RowId> row_ids;
+  for (int i = 0; i < n; i++) {
+    std::string name = "name-" + std::to_string(i % 100) + std::string(40, 'x');
+    std::vector<Field> fields{
+            Field(TypeId::kTypeInt, i),
+            Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)
+    };
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+    row_ids.push_back(row.GetRowId());
+  }
+  ASSERT_EQ(DB_SUCCESS, catalog_01->BuildIndexes(table_info, indexes, &txn));
+  // delete nine rows out of ten, from the heap and the indexes
+  std::vector<Row> id_keys_removed, name_keys_removed;
+  std::vector<RowId> ids_removed;
+  for (int i = 0; i < n; i++) {
+    if (i % 10 == 0) {
+      continue;
+    }
+    Row row(row_ids[i]);
+    ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, &txn));
+    std::vector<Field> id_fields{Field(*row.GetField(0))}, name_fields{Field(*row.GetField(1))};
+    id_keys_removed.emplace_back(id_fields);
+    name_keys_removed.emplace_back(name_fields);
+    ids_removed.push_back(row_ids[i]);
+    ASSERT_TRUE(table_info->GetTableHeap()->MarkDelete(row_ids[i], &txn));
+    table_info->GetTableHeap()->ApplyDelete(row_ids[i], &txn);
+  }
+  ASSERT_EQ(DB_SUCCESS, indexes[0]->GetIndex()->RemoveEntries(id_keys_removed, ids_removed, &txn));
+  ASSERT_EQ(DB_SUCCESS, indexes[1]->GetIndex()->RemoveEntries(name_keys_removed, ids_removed, &txn));
+  ASSERT_TRUE(table_info->GetTableHeap()->NeedsVacuum());
+  uint32_t freed_pages = 0;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->VacuumTable("table-1", &txn, &freed_pages));
+  ASSERT_GT(freed_pages, 0u);
+  ASSERT_FALSE(table_info->GetTableHeap()->NeedsVacuum());
+  // the index finds every remaining row at its new place
+  for (int i = 0; i < n; i += 10) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row key(fields);
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, indexes[0]->GetIndex()->ScanKey(key, ret, &txn));
+    ASSERT_EQ(1, ret.size());
+    Row row(ret[0]);
+    ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, &txn));
+    ASSERT_EQ(i, row.GetField(0)->GetInteger());
+  }
+  // entries of the covering index carry the moved row ids too
+  std::vector<Row> entries;
+  ASSERT_EQ(DB_SUCCESS, indexes[1]->GetIndex()->ScanRangeEntries(nullptr, nullptr, entries, &txn));
+  ASSERT_EQ(n / 10, entries.size());
+  for (auto &entry : entries) {
+    Row row(entry.GetRowId());
+    ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, &txn));
+    ASSERT_EQ(entry.GetField(1)->GetInteger(), row.GetField(0)->GetInteger());
+  }
+  delete db_01;
+}
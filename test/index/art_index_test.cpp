@@ -0,0 +1,122 @@
+#include <algorithm>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "index/art_index.h"
+
+TEST(ArtIndexTests, ArtIndexSimpleTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false)
+  };
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  ArtIndex index(0, index_schema);
+  ASSERT_TRUE(index.IsEmpty());
+  // negative keys and enough keys to grow nodes up to Node256
+  std::vector<int> keys;
+  for (int i = -1000; i < 1000; i++) {
+    keys.push_back(i * 7);
+  }
+  std::random_shuffle(keys.begin(), keys.end());
+  for (auto k : keys) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, k)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index.InsertEntry(row, RowId(k + 10000, 0), nullptr));
+  }
+  ASSERT_EQ(keys.size(), index.GetSize());
+  std::vector<Field> dup_fields{Field(TypeId::kTypeInt, 7)};
+  Row dup_row(dup_fields);
+  ASSERT_EQ(DB_FAILED, index.InsertEntry(dup_row, RowId(1, 1), nullptr));
+  // range scans come back in key order
+  std::vector<Field> lower_fields{Field(TypeId::kTypeInt, -30)};
+  std::vector<Field> upper_fields{Field(TypeId::kTypeInt, 30)};
+  Row lower(lower_fields), upper(upper_fields);
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index.ScanRange(&lower, &upper, ret, nullptr));
+  ASSERT_EQ(9, ret.size());
+  for (size_t i = 0; i < ret.size(); i++) {
+    ASSERT_EQ(RowId(-28 + 7 * static_cast<int>(i) + 10000, 0).Get(), ret[i].Get());
+  }
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index.ScanRange(nullptr, nullptr, ret, nullptr));
+  ASSERT_EQ(keys.size(), ret.size());
+  ASSERT_TRUE(std::is_sorted(ret.begin(), ret.end(),
+                             [](const RowId &a, const RowId &b) { return a.GetPageId() < b.GetPageId(); }));
+  // removing most keys shrinks the nodes again
+  for (auto k : keys) {
+    if (k % 5 != 0) {
+      std::vector<Field> fields{Field(TypeId::kTypeInt, k)};
+      Row row(fields);
+      ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(row, RowId(k + 10000, 0), nullptr));
+    }
+  }
+  for (auto k : keys) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, k)};
+    Row row(fields);
+    ret.clear();
+    ASSERT_EQ(k % 5 == 0 ? DB_SUCCESS : DB_KEY_NOT_FOUND, index.ScanKey(row, ret, nullptr));
+  }
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index.ScanRange(nullptr, nullptr, ret, nullptr));
+  ASSERT_EQ(400, ret.size());
+  ASSERT_EQ(DB_SUCCESS, index.Destroy());
+  ASSERT_TRUE(index.IsEmpty());
+}
+
+TEST(ArtIndexTests, ArtIndexDuplicateKeyTest) {
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false)
+  };
+  std::vector<uint32_t> index_key_map{1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  ArtIndex index(0, index_schema, false);
+  // keys that are prefixes of each other, one holding a 0 byte
+  std::vector<std::string> names{"a", "ab", "abc", "b", std::string("a\0c", 3)};
+  const int copies = 50;
+  for (int i = 0; i < copies; i++) {
+    for (size_t j = 0; j < names.size(); j++) {
+      std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(names[j].data()), names[j].size(), true)};
+      Row row(fields);
+      ASSERT_EQ(DB_SUCCESS, index.InsertEntry(row, RowId(j, i), nullptr));
+    }
+  }
+  for (size_t j = 0; j < names.size(); j++) {
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(names[j].data()), names[j].size(), true)};
+    Row row(fields);
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index.ScanKey(row, ret, nullptr));
+    ASSERT_EQ(copies, ret.size());
+    for (int i = 0; i < copies; i++) {
+      ASSERT_EQ(RowId(j, i).Get(), ret[i].Get());
+    }
+  }
+  // entries decode back to the key, in key order
+  std::string lower = "a", upper = "abc";
+  std::vector<Field> lower_fields{Field(TypeId::kTypeChar, const_cast<char *>(lower.data()), lower.size(), true)};
+  std::vector<Field> upper_fields{Field(TypeId::kTypeChar, const_cast<char *>(upper.data()), upper.size(), true)};
+  Row lower_row(lower_fields), upper_row(upper_fields);
+  std::vector<Row> entries;
+  ASSERT_EQ(DB_SUCCESS, index.ScanRangeEntries(&lower_row, &upper_row, entries, nullptr));
+  ASSERT_EQ(4 * copies, entries.size());
+  std::vector<std::string> expected{"a", std::string("a\0c", 3), "ab", "abc"};
+  for (size_t i = 0; i < entries.size(); i++) {
+    const Field *field = entries[i].GetField(0);
+    ASSERT_EQ(expected[i / copies], std::string(field->GetChars(), field->GetLength()));
+  }
+  for (int i = 0; i < copies; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(names[1].data()), names[1].size(), true)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index.RemoveEntry(row, RowId(1, i), nullptr));
+  }
+  std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(names[1].data()), names[1].size(), true)};
+  Row row(fields);
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index.ScanKey(row, ret, nullptr));
+  ASSERT_EQ(4 * copies, index.GetSize());
+}
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <random>
 #include <string>
 
 #include "common/instance.h"
@@ -32,6 +34,19 @@ TEST(BPlusTreeTests, BPlusTreeIndexGenericKeyTest) {
   k2.SerializeFromKey(copy_key, key_schema);
   INDEX_COMPARATOR_TYPE comparator(key_schema);
   ASSERT_EQ(0, comparator(k1, k2));
+  // the field count is not stored in the key, so a 22 byte string still fits
+  std::vector<Field> long_fields{
+          Field(TypeId::kTypeInt, 27),
+          Field(TypeId::kTypeChar, const_cast<char *>("minisql-minisql-minisq"), 22, true)
+  };
+  Row long_key(long_fields);
+  ASSERT_EQ(32, INDEX_KEY_TYPE::GetSerializedSize(long_key, key_schema));
+  INDEX_KEY_TYPE k3;
+  k3.SerializeFromKey(long_key, key_schema);
+  Row out_key(INVALID_ROWID);
+  ASSERT_EQ(32, k3.DeserializeToKey(out_key, key_schema));
+  ASSERT_EQ(CmpBool::kTrue, out_key.GetField(1)->CompareEquals(long_fields[1]));
+  ASSERT_GT(0, comparator(k1, k3));
 }
 
 TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
@@ -78,4 +93,223 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
     ASSERT_EQ(i, (*iter).second.GetSlotNum());
     i++;
   }
-}
\ No newline at end of file
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexDuplicateKeyTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("status", TypeId::kTypeInt, 1, false, false)
+  };
+  std::vector<uint32_t> index_key_map{1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  auto *unique_index = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_);
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(1, index_schema, engine.bpm_, false);
+  const int n = 2000, keys = 10;
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i % keys)};
+    Row row(fields);
+    RowId rid(1000 + i / 100, i % 100);
+    ASSERT_EQ(i < keys ? DB_SUCCESS : DB_FAILED, unique_index->InsertEntry(row, rid, nullptr));
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, rid, nullptr));
+  }
+  // Every row id of a key is returned, in row id order
+  for (int k = 0; k < keys; k++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, k)};
+    Row row(fields);
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(row, ret, nullptr));
+    ASSERT_EQ(n / keys, ret.size());
+    for (size_t j = 0; j < ret.size(); j++) {
+      int i = static_cast<int>(j) * keys + k;
+      ASSERT_EQ(RowId(1000 + i / 100, i % 100).Get(), ret[j].Get());
+    }
+  }
+  // Remove only the given row ids of a key
+  for (int i = 3; i < n; i += 2 * keys) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, 3)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(row, RowId(1000 + i / 100, i % 100), nullptr));
+  }
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 3)};
+  Row row(fields);
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(row, ret, nullptr));
+  ASSERT_EQ(n / keys / 2, ret.size());
+  std::vector<Field> missing_fields{Field(TypeId::kTypeInt, keys)};
+  Row missing(missing_fields);
+  ret.clear();
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(missing, ret, nullptr));
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexIntKeyOrderTest) {
+  using INDEX_KEY_TYPE = GenericKey<16>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<16>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+  };
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  auto *unique_index = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_);
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(1, index_schema, engine.bpm_, false);
+  // single INT keys are compared in place, negative values must still sort first
+  const int n = 3000;
+  std::vector<int> keys;
+  for (int i = 0; i < n; i++) {
+    keys.push_back(i - n / 2);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, keys[i])};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, unique_index->InsertEntry(row, RowId(keys[i] + n, 0), nullptr));
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(keys[i] + n, 1), nullptr));
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(keys[i] + n, 0), nullptr));
+  }
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, unique_index->ScanRange(nullptr, nullptr, ret, nullptr));
+  ASSERT_EQ(n, ret.size());
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(RowId(i - n / 2 + n, 0).Get(), ret[i].Get());
+  }
+  std::vector<Field> fields{Field(TypeId::kTypeInt, -7)};
+  Row row(fields);
+  ret.clear();
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(row, ret, nullptr));
+  ASSERT_EQ(2, ret.size());
+  ASSERT_EQ(RowId(n - 7, 0).Get(), ret[0].Get());
+  ASSERT_EQ(RowId(n - 7, 1).Get(), ret[1].Get());
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexStatisticsTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("status", TypeId::kTypeInt, 1, false, false)
+  };
+  std::vector<uint32_t> index_key_map{1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_, false);
+  const int n = 4000, keys = 100;
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i % keys)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(1000 + i / 100, i % 100), nullptr));
+  }
+  // DML keeps the entry count, the rest waits for Analyze
+  IndexStatistics *stats = index->GetStatistics();
+  ASSERT_EQ(n, stats->GetEntryCount());
+  ASSERT_EQ(0, stats->GetHeight());
+  // removing an entry that is not there leaves the count alone
+  std::vector<Field> missing_fields{Field(TypeId::kTypeInt, keys)};
+  Row missing(missing_fields);
+  ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(missing, RowId(1000, 0), nullptr));
+  ASSERT_EQ(DB_SUCCESS, index->RemoveEntries({missing}, {RowId(1000, 1)}, nullptr));
+  ASSERT_EQ(n, stats->GetEntryCount());
+  ASSERT_EQ(DB_SUCCESS, index->Analyze(nullptr));
+  ASSERT_EQ(n, stats->GetEntryCount());
+  ASSERT_EQ(keys, stats->GetDistinctCount());
+  ASSERT_EQ(n / keys, stats->EstimateEqual());
+  ASSERT_GE(stats->GetHeight(), 2);
+  ASSERT_GT(stats->GetLeafCount(), 1);
+  ASSERT_GT(stats->GetAverageFill(), 0);
+  ASSERT_LE(stats->GetAverageFill(), 1);
+  // equi-depth buckets of 500 entries, the last key of each bucket is its bound
+  ASSERT_EQ(IndexStatistics::HISTOGRAM_BUCKETS, stats->GetBounds().size());
+  for (size_t i = 0; i < stats->GetBounds().size(); i++) {
+    ASSERT_EQ(n / IndexStatistics::HISTOGRAM_BUCKETS, stats->GetCounts()[i]);
+    ASSERT_EQ(static_cast<int>(((i + 1) * n / IndexStatistics::HISTOGRAM_BUCKETS - 1) / (n / keys)),
+              stats->GetBounds()[i].GetField(0)->GetInteger());
+  }
+  // buckets that only overlap the range count half
+  std::vector<Field> lower_fields{Field(TypeId::kTypeInt, 30)};
+  std::vector<Field> upper_fields{Field(TypeId::kTypeInt, 49)};
+  Row lower(lower_fields), upper(upper_fields);
+  ASSERT_EQ(n / 2, stats->EstimateRange(nullptr, &upper));
+  ASSERT_EQ(n / 8 + n / 16, stats->EstimateRange(&lower, &upper));
+  ASSERT_EQ(n, stats->EstimateRange(nullptr, nullptr));
+  // the statistics survive a round trip through a page
+  char buf[PAGE_SIZE];
+  uint32_t size = stats->SerializeTo(buf, index_schema);
+  ASSERT_EQ(stats->GetSerializedSize(index_schema), size);
+  IndexStatistics loaded;
+  ASSERT_EQ(size, loaded.DeserializeFrom(buf, index_schema));
+  ASSERT_EQ(keys, loaded.GetDistinctCount());
+  ASSERT_EQ(stats->GetHeight(), loaded.GetHeight());
+  ASSERT_EQ(n / 2, loaded.EstimateRange(nullptr, &upper));
+  memset(buf, 0, sizeof(buf));
+  ASSERT_EQ(0, loaded.DeserializeFrom(buf, index_schema));
+  for (int i = 0; i < n / 2; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i % keys)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(row, RowId(1000 + i / 100, i % 100), nullptr));
+  }
+  ASSERT_EQ(n / 2, stats->GetEntryCount());
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexBloomFilterTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  using BP_TREE_INDEX = BPlusTreeIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 16, 1, true, false)
+  };
+  std::vector<uint32_t> index_key_map{0, 1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  auto *index = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_, true, nullptr, true);
+  // past the initial size of the filter, so it is rebuilt on the way
+  const int n = 5000;
+  auto make_key = [](int i, std::string &name) {
+    name = "k" + std::to_string(i);
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(name.data()),
+                                                                 name.size(), true)};
+    return Row(fields);
+  };
+  std::string name;
+  for (int i = 0; i < n; i += 2) {
+    Row row = make_key(i, name);
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(i, 0), nullptr));
+  }
+  // a filter never hides a key, the tree still answers the false positives
+  std::vector<RowId> ret;
+  for (int i = 0; i < n; i++) {
+    Row row = make_key(i, name);
+    ret.clear();
+    ASSERT_EQ(i % 2 == 0 ? DB_SUCCESS : DB_KEY_NOT_FOUND, index->ScanKey(row, ret, nullptr));
+  }
+  // a second index over the same tree rebuilds its filter from the leaves
+  auto *reloaded = ALLOC(heap, BP_TREE_INDEX)(0, index_schema, engine.bpm_, true, nullptr, true);
+  for (int i = 0; i < n; i++) {
+    Row row = make_key(i, name);
+    ret.clear();
+    ASSERT_EQ(i % 2 == 0 ? DB_SUCCESS : DB_KEY_NOT_FOUND, reloaded->ScanKey(row, ret, nullptr));
+  }
+  // removed keys stay in the filter but are still not found
+  for (int i = 0; i < n; i += 4) {
+    Row row = make_key(i, name);
+    ASSERT_EQ(DB_SUCCESS, reloaded->RemoveEntry(row, RowId(i, 0), nullptr));
+  }
+  for (int i = 0; i < n; i += 2) {
+    Row row = make_key(i, name);
+    ret.clear();
+    ASSERT_EQ(i % 4 == 0 ? DB_KEY_NOT_FOUND : DB_SUCCESS, reloaded->ScanKey(row, ret, nullptr));
+  }
+}
@@ -116,3 +116,122 @@ TEST(BPlusTreeTests, BigTest) {
     ASSERT_EQ(kv_map[delete_seq[i]], ans[ans.size() - 1]);
   }
 }
+
+TEST(BPlusTreeTests, BatchTest) {
+  // Init engine
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator, 8, 8);
+  // Prepare data, odd keys go in one by one and even keys as two sorted batches
+  const int n = 4000;
+  for (int i = 1; i < n; i += 2) {
+    tree.Insert(i, i * 10);
+  }
+  vector<std::pair<int, int>> batch;
+  for (int i = 0; i < n; i += 2) {
+    batch.emplace_back(i, i * 10);
+  }
+  vector<std::pair<int, int>> first(batch.begin(), batch.begin() + batch.size() / 2);
+  vector<std::pair<int, int>> second(batch.begin() + batch.size() / 2, batch.end());
+  ASSERT_EQ(static_cast<int>(first.size()), tree.InsertBatch(first));
+  ASSERT_EQ(static_cast<int>(second.size()), tree.InsertBatch(second));
+  // Duplicate keys are skipped
+  ASSERT_EQ(0, tree.InsertBatch(first));
+  ASSERT_TRUE(tree.Check());
+  vector<int> ans;
+  for (int i = 0; i < n; i++) {
+    ASSERT_TRUE(tree.GetValue(i, ans));
+    ASSERT_EQ(i * 10, ans[ans.size() - 1]);
+  }
+  // Delete a dense run and a sparse set of keys
+  vector<int> delete_seq;
+  for (int i = 0; i < n; i++) {
+    if (i < n / 2 || i % 3 == 0) {
+      delete_seq.push_back(i);
+    }
+  }
+  ASSERT_EQ(static_cast<int>(delete_seq.size()), tree.RemoveBatch(delete_seq));
+  ASSERT_TRUE(tree.Check());
+  // keys that are gone already count nothing
+  ASSERT_EQ(0, tree.RemoveBatch(delete_seq));
+  ASSERT_FALSE(tree.Remove(delete_seq[0]));
+  ans.clear();
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(!(i < n / 2 || i % 3 == 0), tree.GetValue(i, ans));
+  }
+  int expect = n / 2;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter, ++expect) {
+    while (expect % 3 == 0) {
+      expect++;
+    }
+    ASSERT_EQ(expect, (*iter).first);
+  }
+}
+
+TEST(BPlusTreeTests, MinFillTest) {
+  // Init engine
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator, 16, 16);
+  tree.SetMinFill(25);
+  const int n = 4000;
+  for (int i = 0; i < n; i++) {
+    tree.Insert(i, i * 10);
+  }
+  // Sequential inserts leave the leaves half full, deleting every other key takes them to a quarter
+  // which is still above the min fill, so nothing merges until Compact
+  for (int i = 0; i < n; i++) {
+    if (i % 2 != 0) {
+      tree.Remove(i);
+    }
+  }
+  ASSERT_TRUE(tree.Check());
+  ASSERT_GT(tree.Compact(), 0);
+  ASSERT_EQ(0, tree.Compact());
+  ASSERT_TRUE(tree.Check());
+  vector<int> ans;
+  for (int i = 0; i < n; i++) {
+    ASSERT_EQ(i % 2 == 0, tree.GetValue(i, ans));
+  }
+  int expect = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter, expect += 2) {
+    ASSERT_EQ(expect, (*iter).first);
+  }
+  ASSERT_EQ(n, expect);
+  for (auto iter = tree.RBegin(); iter != tree.REnd(); --iter) {
+    expect -= 2;
+    ASSERT_EQ(expect, (*iter).first);
+  }
+  ASSERT_EQ(0, expect);
+  ASSERT_TRUE(tree.Check());
+  for (int i = 0; i < n; i += 2) {
+    tree.Remove(i);
+  }
+  ASSERT_TRUE(tree.IsEmpty());
+}
+
+TEST(BPlusTreeTests, DestroyTest) {
+  // Init engine
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator, 16, 16);
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(engine.disk_mgr_->GetMetaData());
+  uint32_t allocated = meta_page->GetAllocatedPages();
+  const int n = 4000;
+  for (int i = 0; i < n; i++) {
+    tree.Insert(i, i * 10);
+  }
+  ASSERT_GT(meta_page->GetAllocatedPages(), allocated);
+  // every index page goes back to disk, the tree stays usable
+  tree.Destroy();
+  ASSERT_TRUE(tree.IsEmpty());
+  ASSERT_EQ(allocated, meta_page->GetAllocatedPages());
+  vector<int> ans;
+  ASSERT_FALSE(tree.GetValue(1, ans));
+  for (int i = 0; i < n; i++) {
+    tree.Insert(i, i * 10);
+  }
+  ASSERT_TRUE(tree.Check());
+  tree.Destroy();
+  ASSERT_EQ(allocated, meta_page->GetAllocatedPages());
+}
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <string>
+
+#include "common/instance.h"
+#include "gtest/gtest.h"
+#include "index/generic_key.h"
+#include "index/hash_index.h"
+
+static const std::string db_name = "hash_index_test.db";
+
+TEST(HashIndexTests, HashIndexSimpleTest) {
+  using INDEX_KEY_TYPE = GenericKey<32>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<32>;
+  using HASH_INDEX = HashIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("token", TypeId::kTypeChar, 16, 1, true, false)
+  };
+  std::vector<uint32_t> index_key_map{1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  auto *index = ALLOC(heap, HASH_INDEX)(0, index_schema, engine.bpm_);
+  ASSERT_TRUE(index->IsEmpty());
+  // enough keys to split buckets and grow the directory several times
+  const int n = 5000;
+  for (int i = 0; i < n; i++) {
+    std::string token = "token-" + std::to_string(i);
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(token.c_str()), token.size(), true)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(1000 + i / 100, i % 100), nullptr));
+  }
+  ASSERT_FALSE(index->IsEmpty());
+  std::string dup = "token-7";
+  std::vector<Field> dup_fields{Field(TypeId::kTypeChar, const_cast<char *>(dup.c_str()), dup.size(), true)};
+  Row dup_row(dup_fields);
+  ASSERT_EQ(DB_FAILED, index->InsertEntry(dup_row, RowId(1, 1), nullptr));
+  for (int i = 0; i < n; i++) {
+    std::string token = "token-" + std::to_string(i);
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(token.c_str()), token.size(), true)};
+    Row row(fields);
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(row, ret, nullptr));
+    ASSERT_EQ(1, ret.size());
+    ASSERT_EQ(RowId(1000 + i / 100, i % 100).Get(), ret[0].Get());
+  }
+  // only point ranges are supported
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index->ScanRange(&dup_row, &dup_row, ret, nullptr));
+  ASSERT_EQ(1, ret.size());
+  ASSERT_EQ(DB_FAILED, index->ScanRange(&dup_row, nullptr, ret, nullptr));
+  for (int i = 0; i < n; i += 2) {
+    std::string token = "token-" + std::to_string(i);
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(token.c_str()), token.size(), true)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(row, RowId(1000 + i / 100, i % 100), nullptr));
+  }
+  for (int i = 0; i < n; i++) {
+    std::string token = "token-" + std::to_string(i);
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(token.c_str()), token.size(), true)};
+    Row row(fields);
+    ret.clear();
+    ASSERT_EQ(i % 2 == 0 ? DB_KEY_NOT_FOUND : DB_SUCCESS, index->ScanKey(row, ret, nullptr));
+  }
+  ASSERT_EQ(DB_SUCCESS, index->Destroy());
+  ASSERT_TRUE(index->IsEmpty());
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(HashIndexTests, HashIndexDuplicateKeyTest) {
+  using INDEX_KEY_TYPE = GenericKey<8>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<8>;
+  using HASH_INDEX = HashIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("status", TypeId::kTypeInt, 1, false, false)
+  };
+  std::vector<uint32_t> index_key_map{1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  auto *index = ALLOC(heap, HASH_INDEX)(0, index_schema, engine.bpm_, false);
+  // a few keys with many rows each end up in overflow pages
+  const int n = 3000, keys = 3;
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i % keys)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(1000 + i / 100, i % 100), nullptr));
+  }
+  for (int k = 0; k < keys; k++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, k)};
+    Row row(fields);
+    std::vector<RowId> ret;
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(row, ret, nullptr));
+    ASSERT_EQ(n / keys, ret.size());
+  }
+  for (int i = 1; i < n; i += keys) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, 1)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->RemoveEntry(row, RowId(1000 + i / 100, i % 100), nullptr));
+  }
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 1)};
+  Row row(fields);
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_KEY_NOT_FOUND, index->ScanKey(row, ret, nullptr));
+  ASSERT_FALSE(index->IsEmpty());
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
+
+TEST(HashIndexTests, HashIndexOverflowSplitTest) {
+  using INDEX_KEY_TYPE = GenericKey<8>;
+  using INDEX_COMPARATOR_TYPE = GenericComparator<8>;
+  using HASH_INDEX = HashIndex<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  using BUCKET_PAGE = HashTableBucketPage<INDEX_KEY_TYPE, RowId, INDEX_COMPARATOR_TYPE>;
+  DBStorageEngine engine(db_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("status", TypeId::kTypeInt, 1, false, false)
+  };
+  std::vector<uint32_t> index_key_map{1};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map, &heap);
+  auto *index = ALLOC(heap, HASH_INDEX)(0, index_schema, engine.bpm_, false);
+  auto fetch_directory = [&engine]() {
+    auto *roots = reinterpret_cast<IndexRootsPage *>(engine.bpm_->FetchPage(INDEX_ROOTS_PAGE_ID)->GetData());
+    page_id_t directory_page_id;
+    EXPECT_TRUE(roots->GetRootId(0, &directory_page_id));
+    engine.bpm_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
+    auto *page = engine.bpm_->FetchPage(directory_page_id);
+    return std::make_pair(directory_page_id, reinterpret_cast<HashTableDirectoryPage *>(page->GetData()));
+  };
+  // one key fills the only bucket and several overflow pages
+  const int dups = 5 * BUCKET_PAGE::BUCKET_SIZE, n = 5000, dup_key = -1;
+  std::vector<Field> dup_fields{Field(TypeId::kTypeInt, dup_key)};
+  Row dup_row(dup_fields);
+  const uint32_t dup_hash = HASH_INDEX::HashKey(dup_row);
+  for (int i = 0; i < dups; i++) {
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(dup_row, RowId(1000 + i / 100, i % 100), nullptr));
+  }
+  auto directory = fetch_directory();
+  ASSERT_EQ(0, directory.second->GetGlobalDepth());
+  engine.bpm_->UnpinPage(directory.first, false);
+  // distinct keys still split the bucket instead of piling into its chain
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(row, RowId(i / 100, i % 100), nullptr));
+  }
+  directory = fetch_directory();
+  ASSERT_LT(0, directory.second->GetGlobalDepth());
+  int max_chain = 0;
+  for (uint32_t i = 0; i < directory.second->Size(); i++) {
+    int chain = 0;
+    bool only_dups = true;
+    page_id_t page_id = directory.second->GetBucketPageId(i);
+    while (page_id != INVALID_PAGE_ID) {
+      auto *bucket = reinterpret_cast<BUCKET_PAGE *>(engine.bpm_->FetchPage(page_id)->GetData());
+      only_dups = only_dups && bucket->AllHashEqual(dup_hash);
+      chain++;
+      page_id_t next_page_id = bucket->GetNextPageId();
+      engine.bpm_->UnpinPage(page_id, false);
+      page_id = next_page_id;
+    }
+    // only the chain of the duplicated key has overflow pages, unless the bucket can not be split any more
+    ASSERT_TRUE(chain == 1 || only_dups || !directory.second->CanIncrGlobalDepth());
+    max_chain = std::max(max_chain, chain);
+  }
+  ASSERT_LE(max_chain, dups / BUCKET_PAGE::BUCKET_SIZE + 1);
+  engine.bpm_->UnpinPage(directory.first, false);
+  std::vector<RowId> ret;
+  ASSERT_EQ(DB_SUCCESS, index->ScanKey(dup_row, ret, nullptr));
+  ASSERT_EQ(dups, ret.size());
+  for (int i = 0; i < n; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    Row row(fields);
+    ret.clear();
+    ASSERT_EQ(DB_SUCCESS, index->ScanKey(row, ret, nullptr));
+    ASSERT_EQ(1, ret.size());
+    ASSERT_EQ(RowId(i / 100, i % 100).Get(), ret[0].Get());
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+}
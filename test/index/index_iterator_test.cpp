@@ -34,3 +34,87 @@ TEST(BPlusTreeTests, IndexIteratorTest) {
     EXPECT_EQ(ans * 100, (*iter).second);
   }
 }
+
+TEST(BPlusTreeTests, ReverseIndexIteratorTest) {
+  // Init engine
+  DBStorageEngine engine(db_name);
+  BasicComparator<int> comparator;
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator, 4, 4);
+
+  // Split and coalesce leaves so that the prev links are rewired
+  for (int i = 1; i <= 50; i++) {
+    tree.Insert(i, i * 100, nullptr);
+  }
+  for (int i = 2; i <= 50; i += 2) {
+    tree.Remove(i);
+  }
+  // Reverse iterator from the last key
+  int ans = 49;
+  for (auto iter = tree.RBegin(); iter != tree.REnd(); --iter, ans -= 2) {
+    EXPECT_EQ(ans, (*iter).first);
+    EXPECT_EQ(ans * 100, (*iter).second);
+  }
+  EXPECT_EQ(-1, ans);
+  // Reverse iterator from a key that exists and from one that does not
+  ans = 25;
+  for (auto iter = tree.RBegin(25); iter != tree.REnd(); --iter, ans -= 2) {
+    EXPECT_EQ(ans, (*iter).first);
+  }
+  EXPECT_EQ(-1, ans);
+  ans = 35;
+  for (auto iter = tree.RBegin(36); iter != tree.REnd(); --iter, ans -= 2) {
+    EXPECT_EQ(ans, (*iter).first);
+  }
+  EXPECT_EQ(-1, ans);
+  // Nothing is <= 0
+  EXPECT_FALSE(tree.RBegin(0) != tree.REnd());
+}
+
+TEST(BPlusTreeTests, IndexIteratorPinTest) {
+  // a pool far smaller than the tree, a scan that leaked pins would run out of frames
+  DBStorageEngine engine(db_name, true, 16);
+  BasicComparator<int> comparator;
+  BPlusTree<int, int, BasicComparator<int>> tree(0, engine.bpm_, comparator, 8, 8);
+  const int n = 2000;
+  for (int i = 0; i < n; i++) {
+    tree.Insert(i, i * 100, nullptr);
+  }
+  for (int round = 0; round < 3; round++) {
+    int ans = 0;
+    for (auto iter = tree.Begin(); iter != tree.End(); ++iter, ans++) {
+      ASSERT_EQ(ans, (*iter).first);
+    }
+    ASSERT_EQ(n, ans);
+    for (auto iter = tree.RBegin(); iter != tree.REnd(); --iter) {
+      ASSERT_EQ(--ans, (*iter).first);
+    }
+    ASSERT_EQ(0, ans);
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  // copies hold their own pin
+  {
+    auto iter = tree.Begin(100);
+    auto copy = iter;
+    ++iter;
+    ASSERT_EQ(100, (*copy).first);
+    ASSERT_EQ(101, (*iter).first);
+    copy = iter;
+    ASSERT_TRUE(copy == iter);
+  }
+  ASSERT_TRUE(engine.bpm_->CheckAllUnpinned());
+  // NextN copies a leaf at a time
+  vector<int> values;
+  auto iter = tree.Begin(500);
+  int leaves = 0, count;
+  while ((count = iter.NextN(values)) > 0) {
+    ASSERT_LE(count, 8);
+    leaves++;
+  }
+  ASSERT_EQ(0, iter.NextN(values));
+  ASSERT_TRUE(iter == tree.End());
+  ASSERT_EQ(n - 500, values.size());
+  ASSERT_GT(leaves, 1);
+  for (size_t i = 0; i < values.size(); i++) {
+    ASSERT_EQ((500 + static_cast<int>(i)) * 100, values[i]);
+  }
+}
@@ -117,4 +117,50 @@ TEST(TupleTest, RowTest) {
   }
   ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
   table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
-}
\ No newline at end of file
+}
+TEST(TupleTest, TupleViewTest) {
+  SimpleMemHeap heap;
+  TablePage table_page;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false),
+          ALLOC_COLUMN(heap)("note", TypeId::kTypeChar, 64, 2, true, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 3, true, false)
+  };
+  std::vector<Field> fields = {
+          Field(TypeId::kTypeInt, 188),
+          Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false),
+          Field(TypeId::kTypeChar),
+          Field(TypeId::kTypeFloat, 19.99f)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  Row row(fields);
+  table_page.Init(0, INVALID_PAGE_ID, nullptr, nullptr);
+  table_page.InsertTuple(row, schema.get(), nullptr, nullptr, nullptr);
+  TupleView view;
+  ASSERT_FALSE(table_page.GetTupleView(1, schema.get(), &view));
+  ASSERT_TRUE(table_page.GetTupleView(row.GetRowId().GetSlotNum(), schema.get(), &view));
+  // fields read in any order, char fields point into the page
+  ASSERT_FLOAT_EQ(19.99f, view.GetFloat(3));
+  ASSERT_TRUE(view.IsNull(2));
+  ASSERT_EQ(188, view.GetInteger(0));
+  ASSERT_EQ(strlen("minisql"), view.GetLength(1));
+  ASSERT_EQ(0, memcmp("minisql", view.GetChars(1), view.GetLength(1)));
+  ASSERT_GT(view.GetChars(1), table_page.GetData());
+  ASSERT_LT(view.GetChars(1), table_page.GetData() + PAGE_SIZE);
+  for (uint32_t i = 0; i < fields.size(); i++) {
+    Field field = view.GetField(i);
+    ASSERT_EQ(fields[i].IsNull(), field.IsNull());
+    if (!field.IsNull()) {
+      ASSERT_EQ(CmpBool::kTrue, field.CompareEquals(fields[i]));
+    }
+  }
+  // a materialized row keeps its own copy
+  Row copy(row.GetRowId());
+  view.Materialize(&copy);
+  ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
+  table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
+  ASSERT_EQ(4, copy.GetFieldCount());
+  ASSERT_EQ(CmpBool::kTrue, copy.GetField(1)->CompareEquals(fields[1]));
+  ASSERT_EQ(CmpBool::kTrue, copy.GetField(3)->CompareEquals(fields[3]));
+}
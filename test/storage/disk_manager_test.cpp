@@ -62,4 +62,28 @@ TEST(DiskManagerTest, FreePageAllocationTest) {
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
   remove(db_name.c_str());
-}
\ No newline at end of file
+}
+
+TEST(DiskManagerTest, BatchDeAllocationTest) {
+  std::string db_name = "disk_test.db";
+  DiskManager *disk_mgr = new DiskManager(db_name);
+  int extent_nums = 3;
+  for (uint32_t i = 0; i < DiskManager::BITMAP_SIZE * extent_nums; i++) {
+    disk_mgr->AllocatePage();
+  }
+  // unsorted, spread over two extents, with a page given twice
+  std::vector<page_id_t> pages{static_cast<page_id_t>(DiskManager::BITMAP_SIZE * 2 + 5), 3, 1,
+                               static_cast<page_id_t>(DiskManager::BITMAP_SIZE * 2), 3};
+  disk_mgr->DeAllocatePages(pages);
+  for (auto page_id : pages) {
+    EXPECT_EQ(true, disk_mgr->IsPageFree(page_id));
+  }
+  EXPECT_EQ(false, disk_mgr->IsPageFree(2));
+  DiskFileMetaPage *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_EQ(extent_nums * DiskManager::BITMAP_SIZE - 4, meta_page->GetAllocatedPages());
+  EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
+  EXPECT_EQ(DiskManager::BITMAP_SIZE, meta_page->GetExtentUsedPage(1));
+  EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(2));
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
@@ -1,3 +1,4 @@
+#include <atomic>
 #include <vector>
 #include <unordered_map>
 
@@ -5,6 +6,8 @@
 #include "gtest/gtest.h"
 #include "record/field.h"
 #include "record/schema.h"
+#include "storage/parallel_table_scan.h"
+#include "storage/table_batch_iterator.h"
 #include "storage/table_heap.h"
 #include "utils/utils.h"
 
@@ -109,3 +112,673 @@ TEST(TableHeapTest, TableHeapSampleTest) {
   }
 }
 
+TEST(TableHeapTest, TableHeapFreeSpaceMapTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 1000, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  // about 4 rows a page, enough pages to need a second map page
+  const int row_nums = 4000;
+  std::string name(900, 'a');
+  std::vector<RowId> row_ids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    row_ids.push_back(row.GetRowId());
+  }
+  ASSERT_GT(row_nums / 4, FreeSpaceMapPage::MAX_ENTRY_COUNT);
+  // pages keep their rows together, so the rows went in page by page
+  std::set<page_id_t> pages;
+  for (auto &rid : row_ids) {
+    pages.insert(rid.GetPageId());
+  }
+  ASSERT_LE(pages.size(), static_cast<size_t>(row_nums / 4 + 1));
+  // free a row on an early page, the next row of that size goes there
+  RowId freed = row_ids[10];
+  ASSERT_TRUE(table_heap->MarkDelete(freed, nullptr));
+  table_heap->ApplyDelete(freed, nullptr);
+  Fields fields{Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+  Row row(fields);
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  ASSERT_EQ(freed.GetPageId(), row.GetRowId().GetPageId());
+  // the map survives a reload of the heap, new pages still link to the tail
+  TableHeap *reloaded = TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(),
+                                          table_heap->GetFreeSpaceMapPageId(), schema.get(), nullptr, nullptr, &heap);
+  RowId freed2 = row_ids[2000];
+  ASSERT_TRUE(reloaded->MarkDelete(freed2, nullptr));
+  reloaded->ApplyDelete(freed2, nullptr);
+  Row row2(fields);
+  ASSERT_TRUE(reloaded->InsertTuple(row2, nullptr));
+  ASSERT_EQ(freed2.GetPageId(), row2.GetRowId().GetPageId());
+  // just under the overflow threshold, so the row stays whole and needs a page of its own
+  std::string long_name(1000, 'b');
+  for (int i = 0; i < 10; i++) {
+    Fields long_fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(long_name.c_str()),
+                                                          long_name.size(), true)};
+    Row long_row(long_fields);
+    ASSERT_TRUE(reloaded->InsertTuple(long_row, nullptr));
+    ASSERT_EQ(0, pages.count(long_row.GetRowId().GetPageId()));
+  }
+  int count = 0;
+  for (auto iter = reloaded->Begin(nullptr); iter != reloaded->End(); iter++) {
+    count++;
+  }
+  ASSERT_EQ(row_nums + 10, count);
+}
+
+TEST(TableHeapTest, TableHeapAppendBatchTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 2000, 1, true, false),
+          ALLOC_COLUMN(heap)("note", TypeId::kTypeChar, 2000, 2, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  std::string name(100, 'a');
+  auto make_fields = [](int id, std::string &name, std::string &note) {
+    return Fields{Field(TypeId::kTypeInt, id), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true),
+                  Field(TypeId::kTypeChar, const_cast<char *>(note.c_str()), note.size(), true)};
+  };
+  std::string note(10, 'n');
+  Fields first_fields = make_fields(-1, name, note);
+  Row first_row(first_fields);
+  ASSERT_TRUE(table_heap->InsertTuple(first_row, nullptr));
+  // long CHAR values go to overflow pages, a row that is still larger than a page rejects the whole batch
+  std::vector<Column *> wide_columns;
+  for (uint32_t i = 0; i < 1000; i++) {
+    wide_columns.push_back(ALLOC_COLUMN(heap)("c" + std::to_string(i), TypeId::kTypeInt, i, true, false));
+  }
+  auto wide_schema = std::make_shared<Schema>(wide_columns);
+  TableHeap *wide_heap = TableHeap::Create(engine.bpm_, wide_schema.get(), nullptr, nullptr, nullptr, &heap);
+  Fields null_fields;
+  Fields int_fields;
+  for (int i = 0; i < 1000; i++) {
+    null_fields.emplace_back(TypeId::kTypeInt);
+    int_fields.emplace_back(TypeId::kTypeInt, i);
+  }
+  std::vector<Row> bad_rows;
+  bad_rows.emplace_back(null_fields);
+  bad_rows.emplace_back(int_fields);
+  ASSERT_FALSE(wide_heap->AppendBatch(bad_rows, nullptr));
+  ASSERT_TRUE(wide_heap->Begin(nullptr) == wide_heap->End());
+  // the batch fills the first page, then goes on in page order
+  const int row_nums = 3000;
+  std::vector<Row> rows;
+  for (int i = 0; i < row_nums; i++) {
+    Fields row_fields = make_fields(i, name, note);
+    rows.emplace_back(row_fields);
+  }
+  ASSERT_TRUE(table_heap->AppendBatch(rows, nullptr));
+  ASSERT_EQ(first_row.GetRowId().GetPageId(), rows[0].GetRowId().GetPageId());
+  ASSERT_EQ(1, rows[0].GetRowId().GetSlotNum());
+  int count = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); iter++, count++) {
+    if (count > 0) {
+      ASSERT_EQ(rows[count - 1].GetRowId().Get(), iter->GetRowId().Get());
+      ASSERT_EQ(count - 1, iter->GetField(0)->GetInteger());
+    }
+  }
+  ASSERT_EQ(row_nums + 1, count);
+  // the free space map knows the new tail, single inserts go after the batch
+  TableHeap *reloaded = TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(),
+                                          table_heap->GetFreeSpaceMapPageId(), schema.get(), nullptr, nullptr, &heap);
+  std::string long_name(2000, 'b');
+  Fields long_fields = make_fields(row_nums, long_name, note);
+  Row long_row(long_fields);
+  ASSERT_TRUE(reloaded->InsertTuple(long_row, nullptr));
+  Row last_row(RowId(long_row.GetRowId()));
+  ASSERT_TRUE(reloaded->GetTuple(&last_row, nullptr));
+  count = 0;
+  for (auto iter = reloaded->Begin(nullptr); iter != reloaded->End(); iter++) {
+    count++;
+  }
+  ASSERT_EQ(row_nums + 2, count);
+}
+
+TEST(TableHeapTest, TableBatchIteratorTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  const int row_nums = 3000;
+  std::vector<RowId> row_ids;
+  for (int i = 0; i < row_nums; i++) {
+    std::string name(i % 50, 'a' + i % 26);
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true),
+                  i % 7 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, i * 0.5f)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    row_ids.push_back(row.GetRowId());
+  }
+  // deleted rows are skipped
+  for (int i = 0; i < row_nums; i += 10) {
+    ASSERT_TRUE(table_heap->MarkDelete(row_ids[i], nullptr));
+  }
+  // batches stop in the middle of pages and go on from there, columns come in the order asked for
+  for (uint32_t batch_size : {7u, static_cast<uint32_t>(TABLE_BATCH_SIZE)}) {
+    TableBatchIterator scan(table_heap, {2, 0}, nullptr, batch_size);
+    RowBatch batch;
+    auto iter = table_heap->Begin(nullptr);
+    int count = 0;
+    while (scan.Next(&batch)) {
+      ASSERT_LE(batch.GetSize(), batch_size);
+      ASSERT_EQ(2, batch.GetColumnCount());
+      const ColumnVector &account = batch.GetColumn(0);
+      const ColumnVector &id = batch.GetColumn(1);
+      for (uint32_t i = 0; i < batch.GetSize(); i++, iter++, count++) {
+        ASSERT_EQ(iter->GetRowId().Get(), batch.GetRowId(i).Get());
+        int expected = iter->GetField(0)->GetInteger();
+        ASSERT_NE(0, expected % 10);
+        ASSERT_EQ(expected, id.GetInteger(i));
+        ASSERT_EQ(expected % 7 == 0, account.IsNull(i));
+        if (!account.IsNull(i)) {
+          ASSERT_EQ(expected * 0.5f, account.GetFloat(i));
+        }
+      }
+    }
+    ASSERT_TRUE(iter == table_heap->End());
+    ASSERT_EQ(row_nums - row_nums / 10, count);
+  }
+  // char columns come back with their lengths
+  TableBatchIterator scan(table_heap, {1}, nullptr);
+  RowBatch batch;
+  ASSERT_TRUE(scan.Next(&batch));
+  for (uint32_t i = 0; i < batch.GetSize(); i++) {
+    Row row(batch.GetRowId(i));
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    Field name = batch.GetColumn(0).GetField(i);
+    ASSERT_EQ(row.GetField(1)->GetLength(), batch.GetColumn(0).GetLength(i));
+    ASSERT_EQ(CmpBool::kTrue, name.CompareEquals(*row.GetField(1)));
+  }
+}
+
+TEST(TableHeapTest, ParallelTableScanTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  const int row_nums = 10000;
+  std::string name(40, 'a');
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  }
+  // the pages from the free space map are the page chain
+  std::vector<page_id_t> page_ids = table_heap->GetPageIds();
+  page_id_t page_id = table_heap->GetFirstPageId();
+  for (auto id : page_ids) {
+    ASSERT_EQ(page_id, id);
+    auto page = reinterpret_cast<TablePage *>(engine.bpm_->FetchPage(id));
+    page_id = page->GetNextPageId();
+    engine.bpm_->UnpinPage(id, false);
+  }
+  ASSERT_EQ(INVALID_PAGE_ID, page_id);
+  // workers filter their morsels on their own, per morsel results merge back in table order
+  ParallelTableScan scan(table_heap, {0}, nullptr, 4);
+  ASSERT_EQ((page_ids.size() + 3) / 4, scan.GetMorselCount());
+  std::vector<std::vector<int32_t>> parts(scan.GetMorselCount());
+  scan.Run([&](const RowBatch &batch, uint32_t morsel) {
+    for (uint32_t i = 0; i < batch.GetSize(); i++) {
+      if (batch.GetColumn(0).GetInteger(i) % 3 == 0) {
+        parts[morsel].push_back(batch.GetColumn(0).GetInteger(i));
+      }
+    }
+  }, 4);
+  std::vector<int32_t> result;
+  for (auto &part : parts) {
+    result.insert(result.end(), part.begin(), part.end());
+  }
+  ASSERT_EQ(static_cast<size_t>((row_nums + 2) / 3), result.size());
+  for (size_t i = 0; i < result.size(); i++) {
+    ASSERT_EQ(static_cast<int32_t>(i * 3), result[i]);
+  }
+  // tuple views see the same rows in place
+  std::vector<std::vector<RowId>> rid_parts(scan.GetMorselCount());
+  scan.RunTuples([&](const TupleView &view, const RowId &rid, uint32_t morsel) {
+    if (view.GetInteger(0) % 3 == 0 && view.GetLength(1) == name.size()) {
+      rid_parts[morsel].push_back(rid);
+    }
+  }, 4);
+  size_t i = 0;
+  for (auto &part : rid_parts) {
+    for (auto &rid : part) {
+      Row row(rid);
+      ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+      ASSERT_EQ(result[i++], row.GetField(0)->GetInteger());
+    }
+  }
+  ASSERT_EQ(result.size(), i);
+}
+
+TEST(TableHeapTest, TableHeapVacuumTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  const int row_nums = 5000;
+  std::string name(50, 'a');
+  std::vector<RowId> row_ids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    row_ids.push_back(row.GetRowId());
+  }
+  // keep one row in eight, then the table is mostly holes
+  for (int i = 0; i < row_nums; i++) {
+    if (i % 8 != 3) {
+      table_heap->ApplyDelete(row_ids[i], nullptr);
+    }
+  }
+  std::vector<page_id_t> pages_before = table_heap->GetPageIds();
+  std::vector<std::pair<RowId, RowId>> moved;
+  uint32_t freed = table_heap->Vacuum(&moved, nullptr);
+  std::vector<page_id_t> pages_after = table_heap->GetPageIds();
+  ASSERT_EQ(pages_before.size() - freed, pages_after.size());
+  ASSERT_LE(pages_after.size(), pages_before.size() / 8 + 2);
+  // the old row ids map to the new ones
+  std::unordered_map<int64_t, int64_t> new_ids;
+  for (auto &move : moved) {
+    new_ids[move.first.Get()] = move.second.Get();
+  }
+  for (int i = 3; i < row_nums; i += 8) {
+    auto it = new_ids.find(row_ids[i].Get());
+    Row row(it == new_ids.end() ? row_ids[i] : RowId(it->second));
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(i, row.GetField(0)->GetInteger());
+  }
+  // the chain holds exactly the pages that are left, the rest went back to the disk manager
+  int count = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); iter++) {
+    count++;
+  }
+  ASSERT_EQ(row_nums / 8, count);
+  std::set<page_id_t> kept(pages_after.begin(), pages_after.end());
+  for (auto page_id : pages_before) {
+    if (kept.count(page_id) == 0) {
+      ASSERT_TRUE(engine.bpm_->IsPageFree(page_id));
+    }
+  }
+  // the rebuilt free space map survives a reload and new rows go after the kept tail
+  TableHeap *reloaded = TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(),
+                                          table_heap->GetFreeSpaceMapPageId(), schema.get(), nullptr, nullptr, &heap);
+  ASSERT_EQ(pages_after, reloaded->GetPageIds());
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(reloaded->InsertTuple(row, nullptr));
+  }
+  count = 0;
+  for (auto iter = reloaded->Begin(nullptr); iter != reloaded->End(); iter++) {
+    count++;
+  }
+  ASSERT_EQ(row_nums + row_nums / 8, count);
+}
+
+TEST(TableHeapTest, TableHeapUpdateInPlaceTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 200, 1, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  const int row_nums = 200;
+  std::string name(100, 'a');
+  std::vector<RowId> row_ids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    row_ids.push_back(row.GetRowId());
+  }
+  // same size and smaller rows stay in their slot
+  std::string shorter(40, 'b');
+  for (int i = 0; i < row_nums; i++) {
+    std::string &value = i % 2 == 0 ? name : shorter;
+    Fields fields{Field(TypeId::kTypeInt, i + row_nums), Field(TypeId::kTypeChar, const_cast<char *>(value.c_str()), value.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->UpdateTuple(row, row_ids[i], nullptr));
+    ASSERT_EQ(row_ids[i].Get(), row.GetRowId().Get());
+  }
+  for (int i = 0; i < row_nums; i++) {
+    Row row(row_ids[i]);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(i + row_nums, row.GetField(0)->GetInteger());
+    ASSERT_EQ(i % 2 == 0 ? name.size() : 40, row.GetField(1)->GetLength());
+  }
+  // a row that no longer fits its page moves, the old slot is deleted
+  std::string longer(200, 'c');
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  int moved = 0;
+  for (int i = 0; i < row_nums && row_ids[i].GetPageId() == first_page_id; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(longer.c_str()), longer.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->UpdateTuple(row, row_ids[i], nullptr));
+    Row check(row.GetRowId());
+    ASSERT_TRUE(table_heap->GetTuple(&check, nullptr));
+    ASSERT_EQ(longer.size(), check.GetField(1)->GetLength());
+    if (row.GetRowId().Get() != row_ids[i].Get()) {
+      moved++;
+    }
+  }
+  ASSERT_GT(moved, 0);
+  int count = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); iter++) {
+    count++;
+  }
+  ASSERT_EQ(row_nums, count);
+  // without a transaction the old slots are deleted at once, so a vacuum packs the holes they left
+  std::vector<std::pair<RowId, RowId>> vacuum_moved;
+  uint32_t freed = table_heap->Vacuum(&vacuum_moved, nullptr);
+  ASSERT_TRUE(freed > 0 || !vacuum_moved.empty());
+  count = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); iter++) {
+    count++;
+  }
+  ASSERT_EQ(row_nums, count);
+}
+
+TEST(TableHeapTest, TableHeapOverflowTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("text", TypeId::kTypeChar, 10000, 1, true, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 2, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  const int row_nums = 100;
+  auto text_of = [](int i, size_t len) { return std::string(len, static_cast<char>('a' + i % 26)); };
+  std::string name(20, 'n');
+  std::vector<RowId> row_ids;
+  std::vector<Row> batch;
+  for (int i = 0; i < row_nums; i++) {
+    std::string text = text_of(i, 10000);
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(text.c_str()), text.size(), true),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    if (i % 2 == 0) {
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+      row_ids.push_back(row.GetRowId());
+    } else {
+      batch.push_back(row);
+    }
+  }
+  ASSERT_TRUE(table_heap->AppendBatch(batch, nullptr));
+  for (auto &row : batch) {
+    row_ids.push_back(row.GetRowId());
+  }
+  // the rows keep only a pointer, many of them share a page
+  ASSERT_LT(table_heap->GetPageIds().size(), 5);
+  std::unordered_map<int64_t, page_id_t> overflow;
+  ParallelTableScan scan(table_heap, {0}, nullptr);
+  scan.RunTuples([&](const TupleView &view, const RowId &rid, uint32_t) {
+    ASSERT_TRUE(view.IsExternal(1));
+    ASSERT_EQ(10000, view.GetLength(1));
+    ASSERT_FALSE(view.IsExternal(2));
+    overflow[rid.Get()] = view.GetOverflowPageId(1);
+  }, 1);
+  ASSERT_EQ(row_nums, overflow.size());
+  // whole rows come back with the value fetched
+  for (auto &rid : row_ids) {
+    Row row(rid);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    int i = row.GetField(0)->GetInteger();
+    ASSERT_FALSE(row.GetField(1)->IsExternal());
+    ASSERT_EQ(text_of(i, 10000), std::string(row.GetField(1)->GetData(), row.GetField(1)->GetLength()));
+    ASSERT_EQ(name, std::string(row.GetField(2)->GetData(), row.GetField(2)->GetLength()));
+  }
+  TableBatchIterator iter(table_heap, {0, 1}, nullptr);
+  RowBatch row_batch;
+  int count = 0;
+  while (iter.Next(&row_batch)) {
+    for (uint32_t j = 0; j < row_batch.GetSize(); j++, count++) {
+      int i = row_batch.GetColumn(0).GetInteger(j);
+      ASSERT_EQ(text_of(i, 10000), std::string(row_batch.GetColumn(1).GetChars(j), row_batch.GetColumn(1).GetLength(j)));
+    }
+  }
+  ASSERT_EQ(row_nums, count);
+  // an update writes a new chain and frees the old one, a short value goes back inline and may move
+  for (int k = 0; k < 2; k++) {
+    RowId rid = row_ids[k];
+    std::string text = k == 0 ? text_of(k + 1, 9000) : text_of(k + 1, 100);
+    Fields fields{Field(TypeId::kTypeInt, k), Field(TypeId::kTypeChar, const_cast<char *>(text.c_str()), text.size(), true),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->UpdateTuple(row, rid, nullptr));
+    if (k == 0) {
+      ASSERT_EQ(rid.Get(), row.GetRowId().Get());
+    }
+    ASSERT_TRUE(engine.bpm_->IsPageFree(overflow[rid.Get()]));
+    Row check(row.GetRowId());
+    ASSERT_TRUE(table_heap->GetTuple(&check, nullptr));
+    ASSERT_EQ(text, std::string(check.GetField(1)->GetData(), check.GetField(1)->GetLength()));
+  }
+  // a delete frees the chain of the row
+  RowId last = row_ids.back();
+  ASSERT_TRUE(table_heap->MarkDelete(last, nullptr));
+  ASSERT_FALSE(engine.bpm_->IsPageFree(overflow[last.Get()]));
+  table_heap->ApplyDelete(last, nullptr);
+  ASSERT_TRUE(engine.bpm_->IsPageFree(overflow[last.Get()]));
+}
+
+TEST(TableHeapTest, TableHeapColumnarTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 32, 1, true, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap, kLayoutColumnar);
+  ASSERT_EQ(kLayoutColumnar, table_heap->GetLayout());
+  const int row_nums = 1000;
+  std::vector<RowId> row_ids;
+  std::vector<Row> batch;
+  for (int i = 0; i < row_nums; i++) {
+    std::string name(i % 33, 'a' + i % 26);
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true),
+                  i % 7 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, i * 0.5f)};
+    Row row(fields);
+    if (i < row_nums / 2) {
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+      row_ids.push_back(row.GetRowId());
+    } else {
+      batch.push_back(row);
+    }
+  }
+  ASSERT_TRUE(table_heap->AppendBatch(batch, nullptr));
+  for (auto &row : batch) {
+    row_ids.push_back(row.GetRowId());
+  }
+  // a value longer than its column never fits a slot
+  std::string too_long(33, 'x');
+  Fields long_fields{Field(TypeId::kTypeInt, -1), Field(TypeId::kTypeChar, const_cast<char *>(too_long.c_str()), too_long.size(), true),
+                     Field(TypeId::kTypeFloat, 1.f)};
+  Row long_row(long_fields);
+  ASSERT_FALSE(table_heap->InsertTuple(long_row, nullptr));
+  for (int i = 0; i < row_nums; i++) {
+    Row row(row_ids[i]);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(i, row.GetField(0)->GetInteger());
+    ASSERT_EQ(static_cast<uint32_t>(i % 33), row.GetField(1)->GetLength());
+    ASSERT_EQ(i % 7 == 0, row.GetField(2)->IsNull());
+  }
+  // updates stay in their slot whatever the length of the new values
+  for (int i = 0; i < row_nums; i += 3) {
+    std::string name(32, 'u');
+    Fields fields{Field(TypeId::kTypeInt, i + row_nums), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true),
+                  Field(TypeId::kTypeFloat, 1.f)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->UpdateTuple(row, row_ids[i], nullptr));
+    ASSERT_EQ(row_ids[i].Get(), row.GetRowId().Get());
+  }
+  for (int i = 0; i < row_nums; i += 10) {
+    ASSERT_TRUE(table_heap->MarkDelete(row_ids[i], nullptr));
+  }
+  // the iterator, the batches and the tuple views skip deleted slots and agree on every value
+  TableBatchIterator scan(table_heap, {2, 0}, nullptr, 100);
+  RowBatch row_batch;
+  auto iter = table_heap->Begin(nullptr);
+  int count = 0;
+  while (scan.Next(&row_batch)) {
+    for (uint32_t j = 0; j < row_batch.GetSize(); j++, iter++, count++) {
+      ASSERT_EQ(iter->GetRowId().Get(), row_batch.GetRowId(j).Get());
+      int expected = iter->GetField(0)->GetInteger();
+      ASSERT_EQ(expected, row_batch.GetColumn(1).GetInteger(j));
+      ASSERT_EQ(iter->GetField(2)->IsNull(), row_batch.GetColumn(0).IsNull(j));
+      if (expected >= row_nums) {
+        ASSERT_EQ(1.f, row_batch.GetColumn(0).GetFloat(j));
+      }
+    }
+  }
+  ASSERT_TRUE(iter == table_heap->End());
+  ASSERT_EQ(row_nums - row_nums / 10, count);
+  std::atomic<int> views{0};
+  ParallelTableScan parallel(table_heap, {0, 1, 2}, nullptr, 1);
+  parallel.RunTuples([&](const TupleView &view, const RowId &rid, uint32_t) {
+    Row row(rid);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(row.GetField(0)->GetInteger(), view.GetInteger(0));
+    ASSERT_EQ(row.GetField(1)->GetLength(), view.GetLength(1));
+    views++;
+  });
+  ASSERT_EQ(count, views.load());
+  // applied deletes free slots for new rows, a rolled back delete keeps its tuple
+  table_heap->RollbackDelete(row_ids[10], nullptr);
+  table_heap->ApplyDelete(row_ids[20], nullptr);
+  Fields fields{Field(TypeId::kTypeInt, -2), Field(TypeId::kTypeChar, const_cast<char *>("new"), 3, true),
+                Field(TypeId::kTypeFloat, 2.f)};
+  Row row(fields);
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  Row reused(row.GetRowId());
+  ASSERT_TRUE(table_heap->GetTuple(&reused, nullptr));
+  ASSERT_EQ(-2, reused.GetField(0)->GetInteger());
+  Row rolled_back(row_ids[10]);
+  ASSERT_TRUE(table_heap->GetTuple(&rolled_back, nullptr));
+  // the heap reloads with its layout
+  TableHeap *reloaded = TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(), table_heap->GetFreeSpaceMapPageId(),
+                                          schema.get(), nullptr, nullptr, &heap, kLayoutColumnar);
+  int reloaded_count = 0;
+  for (auto it = reloaded->Begin(nullptr); it != reloaded->End(); it++) {
+    reloaded_count++;
+  }
+  ASSERT_EQ(count + 2, reloaded_count);
+}
+
+TEST(TableHeapTest, TableHeapZoneMapTest) {
+  DBStorageEngine engine(db_file_name);
+  SimpleMemHeap heap;
+  std::vector<Column *> columns = {
+          ALLOC_COLUMN(heap)("id", TypeId::kTypeInt, 0, false, false),
+          ALLOC_COLUMN(heap)("name", TypeId::kTypeChar, 64, 1, true, false),
+          ALLOC_COLUMN(heap)("account", TypeId::kTypeFloat, 2, true, false)
+  };
+  auto schema = std::make_shared<Schema>(columns);
+  TableHeap *table_heap = TableHeap::Create(engine.bpm_, schema.get(), nullptr, nullptr, nullptr, &heap);
+  const int row_nums = 2000;
+  std::string name(40, 'n');
+  std::vector<RowId> row_ids;
+  std::vector<Row> batch;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true),
+                  i % 5 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, -i * 0.5f)};
+    Row row(fields);
+    if (i < row_nums / 2) {
+      ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+      row_ids.push_back(row.GetRowId());
+    } else {
+      batch.push_back(row);
+    }
+  }
+  ASSERT_TRUE(table_heap->AppendBatch(batch, nullptr));
+  for (auto &row : batch) {
+    row_ids.push_back(row.GetRowId());
+  }
+  // ids grow with the pages, so every page covers its own range of ids
+  auto check_zones = [&](TableHeap *heap_to_check) {
+    std::unordered_map<page_id_t, std::pair<int, int>> ids;
+    std::unordered_map<page_id_t, uint32_t> nulls;
+    for (auto iter = heap_to_check->Begin(nullptr); iter != heap_to_check->End(); iter++) {
+      page_id_t page_id = iter->GetRowId().GetPageId();
+      int id = iter->GetField(0)->GetInteger();
+      auto it = ids.find(page_id);
+      ids[page_id] = it == ids.end() ? std::make_pair(id, id) : std::make_pair(std::min(it->second.first, id), std::max(it->second.second, id));
+      nulls[page_id] += iter->GetField(2)->IsNull();
+    }
+    ASSERT_GT(ids.size(), 1);
+    for (auto &page : ids) {
+      ColumnZone zone;
+      ASSERT_TRUE(heap_to_check->GetZone(page.first, 0, &zone));
+      ASSERT_LE(zone.min.integer, page.second.first);
+      ASSERT_GE(zone.max.integer, page.second.second);
+      ASSERT_TRUE(zone.MayMatch("=", page.second.first));
+      ASSERT_FALSE(zone.MayMatch(">", zone.max.integer));
+      ASSERT_TRUE(heap_to_check->GetZone(page.first, 2, &zone));
+      ASSERT_GE(zone.null_count, nulls[page.first]);
+    }
+  };
+  check_zones(table_heap);
+  ColumnZone zone;
+  ASSERT_FALSE(table_heap->GetZone(row_ids[0].GetPageId(), 1, &zone));
+  ASSERT_TRUE(table_heap->GetZone(row_ids[0].GetPageId(), 0, &zone));
+  ASSERT_EQ(0, zone.min.integer);
+  ASSERT_FALSE(zone.MayMatch("<", 0));
+  ASSERT_FALSE(zone.MayMatch("=", row_nums));
+  // an update widens the zone of its page, deletes leave it as it is
+  Fields fields{Field(TypeId::kTypeInt, -100), Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true),
+                Field(TypeId::kTypeFloat, 1.f)};
+  Row row(fields);
+  ASSERT_TRUE(table_heap->UpdateTuple(row, row_ids[1], nullptr));
+  ASSERT_EQ(row_ids[1].Get(), row.GetRowId().Get());
+  ASSERT_TRUE(table_heap->GetZone(row_ids[1].GetPageId(), 0, &zone));
+  ASSERT_EQ(-100, zone.min.integer);
+  ASSERT_TRUE(table_heap->GetZone(row_ids[1].GetPageId(), 2, &zone));
+  ASSERT_EQ(1.f, zone.max.real);
+  check_zones(table_heap);
+  // the zones reload with the heap
+  TableHeap *reloaded = TableHeap::Create(engine.bpm_, table_heap->GetFirstPageId(), table_heap->GetFreeSpaceMapPageId(),
+                                          schema.get(), nullptr, nullptr, &heap);
+  ColumnZone reloaded_zone;
+  ASSERT_TRUE(reloaded->GetZone(row_ids[1].GetPageId(), 0, &reloaded_zone));
+  ASSERT_EQ(-100, reloaded_zone.min.integer);
+  check_zones(reloaded);
+  // a vacuum computes the zones again from the tuples that are left
+  for (int i = 0; i < row_nums; i++) {
+    if (i != 1 && i % 4 != 0) {
+      table_heap->ApplyDelete(row_ids[i], nullptr);
+    }
+  }
+  table_heap->ApplyDelete(row_ids[1], nullptr);
+  std::vector<std::pair<RowId, RowId>> moved;
+  table_heap->Vacuum(&moved, nullptr);
+  Row first(table_heap->Begin(nullptr)->GetRowId());
+  ASSERT_TRUE(table_heap->GetZone(first.GetRowId().GetPageId(), 0, &zone));
+  ASSERT_EQ(0, zone.min.integer);
+  check_zones(table_heap);
+}